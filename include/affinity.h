@@ -0,0 +1,33 @@
+#ifndef _AFFINITY_H
+#define _AFFINITY_H
+
+#include <stddef.h>
+#include "arguments.h"
+
+/**
+ * Work out the CPUs the workers are pinned to, from --cpus and --irq-align.
+ * With both, only the CPUs serving the NIC interrupts which are also in --cpus are used.
+ *
+ * RETURNS:
+ *      Positive number: The number of CPUs written to cpus.
+ *                 Zero: No pinning is requested.
+ *      Negative number: The CPUs can not be worked out.
+ */
+int resolve_worker_cpus(const Arguments *args, int *cpus, int max_cpus);
+
+/**
+ * Pin the calling thread to the CPU, and make its later allocations come from the local NUMA node.
+ *
+ * RETURNS:
+ *      Positive number: The thread is pinned.
+ *      Negative number: Pinning failed.
+ */
+int pin_current_thread(int cpu);
+
+/**
+ * Allocate zeroed memory and touch every page from the calling thread,
+ * so a pinned worker gets it on its own NUMA node before the bench starts.
+ */
+void *alloc_local(size_t size);
+
+#endif
@@ -2,6 +2,7 @@
 #define _ARGUMENTS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define METHOD_GET 0
 #define METHOD_HEAD 1
@@ -12,6 +13,10 @@
 #define HTTP_VERSION_0_9 0
 #define HTTP_VERSION_1_0 1
 #define HTTP_VERSION_1_1 2
+#define HTTP_VERSION_2 3
+#define BALANCE_ROUND_ROBIN 0
+#define BALANCE_WEIGHTED 1
+#define BALANCE_HASH 2
 
 #define DEFAULT_CLIENTS 1
 #define DEFAULT_FORCE 0
@@ -20,6 +25,20 @@
 #define DEFAULT_TARGET_PORT 80
 #define DEFAULT_TARGET_SECURITY_PORT 443
 #define DEFAULT_BENCH_TIME 30
+#define DEFAULT_H2_STREAMS 10
+#define MAX_H2_STREAMS 256
+#define MAX_CPU_LIST 256
+#define MAX_PROCS 256
+#define IRQ_INTERFACE_LEN 32
+#define MAX_PATH_TEMPLATE_LEN 512
+#define MAX_REPLAY_FILE_LEN 512
+#define DEFAULT_REPLAY_SPEED 1.0
+#define DEFAULT_PROBE_TIME 5
+#define MAX_TLS_LIST_LEN 512
+#define DEFAULT_DNS_TTL 60
+#define MAX_TARGETS_LEN 2048
+#define MAX_METRICS_ADDRESS_LEN 128
+#define MAX_JSON_FILE_LEN 512
 
 #define HOSTNAMELEN 128
 #define MAX_URL_LEN 1024
@@ -27,17 +46,59 @@
 typedef struct
 {
     int clients;                   // How many http client to send request concurrently.
+    int procs;                     // Worker processes sharing the clients, 0 or 1 - Bench in this process.
+    int dns_ttl;                   // Seconds the resolved addresses are cached before being refreshed.
     int force;                     // 1 Ignore the response from server side; 0 Need waiting repsonse.
     int force_reload;              // Send the reload request.
     char proxy_host[HOSTNAMELEN];  // Host name of proxy.
     int proxy_port;                // Port number of proxy.
     char target_host[HOSTNAMELEN]; // Host name of testing target.
     int target_port;               // Port number of testing target.
+    char targets[MAX_TARGETS_LEN]; // Pool members connected to instead of the host of the URL, separated by ','.
+    int balance;                   /* 0 - Round-robin; 1 - Weighted round-robin; 2 - Consistent hashing of the path */
     int bench_time;                // The duration of bench testing.
+    int warmup_time;               // Seconds of load before the bench, left out of the results.
     int protocol;                  // HTTP or HTTPS.
-    int http10;                    /* 0 - http/0.9; 1 - http/1.0; 2 - http/1.1 */
+    int http10;                    /* 0 - http/0.9; 1 - http/1.0; 2 - http/1.1; 3 - http/2 */
     int method;                    /* 0 - GET; 1 - HEAD; 2 - OPTIONS; 3 - TRACE */
     char url[MAX_URL_LEN];         /* Target URL.*/
+    int h2_streams;                // Concurrent streams carried by each HTTP/2 connection.
+    int reuse_tunnel;              // Keep the proxy CONNECT tunnel open and send the next request through it.
+    int tcp_nodelay;               // Disable Nagle's algorithm on every socket.
+    int send_buffer_size;          // SO_SNDBUF in bytes, 0 keeps the system default.
+    int recv_buffer_size;          // SO_RCVBUF in bytes, 0 keeps the system default.
+    int tcp_fastopen;              // Connect with TCP Fast Open, sending the request in the SYN.
+    int linger_zero;               // Reset the connection on close instead of leaving it in TIME_WAIT.
+    int tcp_quickack;              // Acknowledge received data at once instead of delaying the ACK.
+    double slow_fraction;          // Fraction of the clients paced by the slow rates, 0 - All of them when a rate is set.
+    int slow_read_rate;            // Bytes per second a slow client reads, 0 - Unlimited.
+    int slow_write_rate;           // Bytes per second a slow client trickles its request, 0 - Unlimited.
+    int ktls;                      // Let the kernel encrypt and decrypt the TLS records after the handshake.
+    int connect_only;              // Only connect and close, measuring connects per second.
+    int handshake_only;            // Only connect and run the TLS handshake, measuring handshakes per second.
+    int tls_version;               // TLS1_2_VERSION or TLS1_3_VERSION, 0 - OpenSSL default range.
+    char tls_ciphers[MAX_TLS_LIST_LEN]; // Cipher configurations swept in turn, separated by ','.
+    char tls_groups[MAX_TLS_LIST_LEN];  // Key exchange group configurations swept in turn, separated by ','.
+    int tls_resume;                // Resume the session of the previous handshake of the connection.
+    int tls_early_data;            // Send the request as 0-RTT early data on resumed TLS 1.3 handshakes.
+    int cpus[MAX_CPU_LIST];        // CPUs the worker threads are pinned to, in turn.
+    int cpus_count;                // 0 - No pinning.
+    char irq_interface[IRQ_INTERFACE_LEN]; // Pin workers to the CPUs serving the interrupts of this network interface.
+    char path_template[MAX_PATH_TEMPLATE_LEN]; // Request path with placeholders rendered for every request.
+    int expect_status;             // Status code every response should have, 0 - Not checked.
+    int expect_body_hash_set;      // 1 - The body hash of every response is checked against expect_body_hash.
+    uint64_t expect_body_hash;
+    int report_interval;           // Seconds between interval reports, 0 - Only report at the end.
+    char replay_file[MAX_REPLAY_FILE_LEN]; // Access log whose requests are replayed at their recorded times.
+    double replay_speed;           // Time compression of the replay, 1 - Original timing.
+    double slo_p99_ms;             // Search the concurrency with the highest throughput keeping p99 within it, 0 - No search.
+    int probe_time;                // Seconds of each probe of the search.
+    char metrics_address[MAX_METRICS_ADDRESS_LEN]; // Serve live metrics in the Prometheus format on [host:]port or unix:path.
+    char json_file[MAX_JSON_FILE_LEN]; // Write the results in JSON to this file, for webbench2 compare.
+    bool tsc_clock;                // Time the events with the calibrated TSC instead of the monotonic clock.
+    int perf_counters;             // Count the cycles and instructions of the workers by perf_event_open().
+    int verbose;                   // Print the progress of every connection, with the requests and the responses.
+    int reactor_profile;           // Split the time of the event loop by phase and track its lag, its busy time is always kept.
 } Arguments;
 
 /**
@@ -3,6 +3,8 @@
 
 #include "arguments.h"
 #include "request.h"
+#include "histogram.h"
+#include "resource_usage.h"
 #include <pthread.h>
 #include <stdio.h>
 
@@ -11,19 +13,27 @@ typedef struct {
     const Arguments *args;
     const HTTPRequest *request;
     int thread_id;
-    int *speed;
-    int *failed;
-    int *bytes;
+    uint64_t *speed;
+    uint64_t *failed;
+    uint64_t *bytes;
+    Histogram *latency;             // Shared by all workers, merged into under stats_mutex.
     pthread_mutex_t *stats_mutex;
+    int cpu;                        // CPU the worker is pinned to, -1 for no pinning.
+    ResourceUsage *usage;           // Shared by all workers, added to under stats_mutex.
+    uint64_t *bench_ns;             // Longest time benched since the warm-up of a worker, under stats_mutex.
 } BenchData;
 
 typedef struct {
     const Arguments *args;
     const HTTPRequest *request;
     int thread_id;
-    int speed;
-    int failed;
-    int bytes;
+    uint64_t speed;
+    uint64_t failed;
+    uint64_t bytes;
+    Histogram *latency;             // Allocated by the worker on its own NUMA node.
+    int cpu;                        // CPU the worker is pinned to, -1 for no pinning.
+    ResourceUsage usage;            // What the worker cost the OS.
+    uint64_t bench_ns;              // Benched since the warm-up of the worker.
 } BenchDataNoRace;
 
 void bench(const Arguments *args, const HTTPRequest *http_request);
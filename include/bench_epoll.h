@@ -6,8 +6,14 @@
 
 #include "arguments.h"
 #include "request.h"
+#include "procs.h"
 
 
 void bench_epoll(const Arguments *args, const HTTPRequest *http_request);
 
+/**
+ * Run the bench in a worker process, publishing the results to the parent instead of reporting them.
+ */
+void bench_epoll_worker(const Arguments *args, const HTTPRequest *http_request, ProcessStats *published);
+
 #endif
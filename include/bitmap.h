@@ -1,3 +1,66 @@
+#ifndef _BITMAP_H
+#define _BITMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BITMAP_WORD_BITS 64
+
+/**
+ * Bitmap of 64-bit words, indexed by size_t.
+ * Set entries are found word by word with count-trailing-zeros, so visiting them costs
+ * one step per word plus one per set entry, not one per entry.
+ */
+typedef struct
+{
+    uint64_t *words;
+    size_t bits;
+    size_t words_count;
+} Bitmap;
+
+/**
+ * Allocate a bitmap of the given number of bits, all cleared.
+ *
+ * RETURNS:
+ *      Positive number: The bitmap is allocated.
+ *      Negative number: Memory allocation failed.
+ */
+int bitmap_init(Bitmap *bitmap, size_t bits);
+
+void bitmap_free(Bitmap *bitmap);
+
+/**
+ * Single entry operations, the index should be less than bitmap->bits.
+ */
+void bitmap_set(Bitmap *bitmap, size_t index);
+
+void bitmap_clear(Bitmap *bitmap, size_t index);
+
+bool bitmap_test(const Bitmap *bitmap, size_t index);
+
+/**
+ * Set or clear count entries from index on, the range is cut at the end of the bitmap.
+ */
+void bitmap_set_range(Bitmap *bitmap, size_t index, size_t count);
+
+void bitmap_clear_range(Bitmap *bitmap, size_t index, size_t count);
+
+void bitmap_clear_all(Bitmap *bitmap);
+
+/**
+ * Find the first set entry at or after index.
+ *
+ * RETURNS:
+ *      The index of the entry, or bitmap->bits if there is none.
+ */
+size_t bitmap_find_next_set(const Bitmap *bitmap, size_t index);
+
+/**
+ * Count the set entries.
+ */
+size_t bitmap_count(const Bitmap *bitmap);
+
 /**
  * Set the value of the specified position of the bitmap to 1.
  * 
@@ -26,3 +89,5 @@ int set_bitmap(const unsigned short position, char *bitmap, int bitmap_size);
  *      Return -1 if there is error.
  */
 int get_bitmap(const unsigned short position, char *bitmap, int bitmap_size);
+
+#endif
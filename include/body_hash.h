@@ -0,0 +1,31 @@
+#ifndef _BODY_HASH_H
+#define _BODY_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Incremental 64-bit hash of a response body, fed with the pieces as they arrive.
+ * It's a single lane of the xxHash64 round, so it's fast but not cryptographic,
+ * and the result doesn't depend on how the body is split across reads.
+ */
+typedef struct
+{
+    uint64_t state;
+    uint64_t length;
+    unsigned char tail[8];  // Bytes not forming a whole 64-bit word yet.
+    int tail_len;
+} BodyHash;
+
+void body_hash_init(BodyHash *hash);
+
+void body_hash_update(BodyHash *hash, const void *data, size_t len);
+
+uint64_t body_hash_final(const BodyHash *hash);
+
+/**
+ * Hash a whole buffer at once, the same as init, update and final.
+ */
+uint64_t body_hash(const void *data, size_t len);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef _COMPARE_H
+#define _COMPARE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "results.h"
+
+#define DEFAULT_COMPARE_THRESHOLD 5.0
+#define BOOTSTRAP_ITERATIONS 2000
+#define BOOTSTRAP_SEED 1
+
+/**
+ * The change of a metric from the baseline to the candidate, in percent of the baseline,
+ * with its 95% confidence interval from bootstrap resampling.
+ */
+typedef struct
+{
+    double baseline;
+    double candidate;
+    double delta;
+    double ci_low;
+    double ci_high;
+} CompareDelta;
+
+typedef enum
+{
+    VERDICT_NO_CHANGE,          // The interval contains no change, it may be noise.
+    VERDICT_WITHIN_THRESHOLD,   // Worse, but no more than the threshold.
+    VERDICT_IMPROVED,
+    VERDICT_REGRESSION
+} compare_verdict;
+
+/**
+ * Compare the throughput by resampling the requests completed in each sample period of both runs.
+ *
+ * RETURNS:
+ *      Positive number: The delta is computed.
+ *      Negative number: A run has less than two samples.
+ */
+int compare_throughput(const BenchResults *baseline, const BenchResults *candidate, uint64_t seed, CompareDelta *delta);
+
+/**
+ * Compare the latency at the percentile(0 - 100) by resampling the merged histograms of both runs.
+ *
+ * RETURNS:
+ *      Positive number: The delta is computed.
+ *      Negative number: A run has no latency recorded.
+ */
+int compare_percentile(const BenchResults *baseline, const BenchResults *candidate, double percentile, uint64_t seed,
+                       CompareDelta *delta);
+
+/**
+ * Tell if the delta is a regression beyond threshold percent, higher_is_better for the throughput.
+ */
+compare_verdict compare_judge(const CompareDelta *delta, bool higher_is_better, double threshold);
+
+/**
+ * Run "webbench2 compare [--threshold <percent>] baseline.json candidate.json".
+ *
+ * RETURNS:
+ *      The exit status: 0 - No regression; 1 - Some regression; 2 - The arguments or the files are invalid.
+ */
+int compare_command(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef _HISTOGRAM_H
+#define _HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Log-linear latency histogram in nanoseconds.
+ *
+ * Values below HISTOGRAM_SUB_BUCKETS are exact, above that every power of two is split into
+ * HISTOGRAM_SUB_BUCKETS / 2 buckets, which keeps the relative error under 3%. The struct has a
+ * fixed size and holds no pointers, so it can be copied, merged and placed in shared memory.
+ */
+#define HISTOGRAM_SUB_BUCKET_BITS 6
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_HALF_SUB_BUCKETS (HISTOGRAM_SUB_BUCKETS / 2)
+#define HISTOGRAM_MAX_SHIFT 36 /* Values up to 2^42 ns(about 73 minutes). */
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS + HISTOGRAM_MAX_SHIFT * HISTOGRAM_HALF_SUB_BUCKETS)
+
+typedef struct
+{
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total_count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+} Histogram;
+
+/**
+ * Clear all recorded values.
+ */
+void histogram_reset(Histogram *histogram);
+
+/**
+ * Record one value in nanoseconds.
+ */
+void histogram_record(Histogram *histogram, uint64_t value);
+
+/**
+ * Add all values recorded in src to dst.
+ */
+void histogram_merge(Histogram *dst, const Histogram *src);
+
+/**
+ * Get the value at the given percentile(0 - 100).
+ *
+ * return:
+ *      Return the value in nanoseconds, 0 if there's nothing recorded.
+ */
+uint64_t histogram_percentile(const Histogram *histogram, double percentile);
+
+/**
+ * Count the recorded values up to the given one in nanoseconds, e.g. for the cumulative buckets of an export.
+ * The values sharing the bucket of the limit are all counted, within the precision of the buckets.
+ */
+uint64_t histogram_count_at_most(const Histogram *histogram, uint64_t value);
+
+/**
+ * Get the mean of the recorded values in nanoseconds, 0 if there's nothing recorded.
+ */
+double histogram_mean(const Histogram *histogram);
+
+/**
+ * Print the count, min, mean, percentiles and max of the histogram in one line.
+ */
+void histogram_print(const Histogram *histogram, const char *name, FILE *stream);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef _HPACK_H
+#define _HPACK_H
+
+#include "arguments.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Static table indices (RFC 7541 Appendix A) used when encoding bench requests. */
+#define HPACK_STATIC_AUTHORITY 1
+#define HPACK_STATIC_METHOD_GET 2
+#define HPACK_STATIC_PATH_ROOT 4
+#define HPACK_STATIC_SCHEME_HTTP 6
+#define HPACK_STATIC_SCHEME_HTTPS 7
+#define HPACK_STATIC_CACHE_CONTROL 24
+#define HPACK_STATIC_USER_AGENT 58
+
+/**
+ * Encode an integer with an N-bit prefix (RFC 7541 5.1).
+ *
+ * params:
+ *      buf:            The output buffer.
+ *      size:           The size of the output buffer.
+ *      first_byte:     The bits above the prefix in the first byte, e.g. 0x80 for an indexed field.
+ *      prefix_bits:    The number of bits of the prefix, 1 to 8.
+ *      value:          The integer to encode.
+ *
+ * return:
+ *      Return the number of bytes written.
+ *      Return -1 if the buffer is too small.
+ */
+int hpack_encode_integer(unsigned char *buf, size_t size, unsigned char first_byte, int prefix_bits, uint32_t value);
+
+/**
+ * Encode a string literal without Huffman coding (RFC 7541 5.2).
+ *
+ * return:
+ *      Return the number of bytes written.
+ *      Return -1 if the buffer is too small.
+ */
+int hpack_encode_string(unsigned char *buf, size_t size, const char *str, size_t len);
+
+/**
+ * Encode the request headers of the bench request as one HPACK header block.
+ *
+ * Every field is emitted either as an indexed field or as a literal without indexing, so the
+ * block never touches the dynamic table and can be sent unchanged on every stream.
+ *
+ * return:
+ *      Return the length of the header block.
+ *      Return -1 if the buffer is too small or the arguments are illegal.
+ */
+int hpack_encode_request(const Arguments *args, unsigned char *buf, size_t size);
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _HTTP2_H
+#define _HTTP2_H
+
+#include "arguments.h"
+#include "histogram.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define H2_FRAME_HEADER_SIZE 9
+#define H2_DEFAULT_MAX_FRAME_SIZE 16384
+#define H2_DEFAULT_WINDOW_SIZE 65535
+/* Window advertised by the client for the connection and for each stream. */
+#define H2_LOCAL_WINDOW_SIZE (1u << 30)
+#define H2_MAX_STREAM_ID 0x7fffffffu
+
+#define H2_SEND_BUFFER_SIZE 16384
+#define H2_RECV_BUFFER_SIZE (H2_DEFAULT_MAX_FRAME_SIZE * 2)
+
+#define H2_CONNECTION_PREFACE "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+/* ALPN protocol list in wire format, length prefixed. */
+#define H2_ALPN_PROTOCOLS "\x02h2"
+
+typedef enum
+{
+    H2_FRAME_DATA = 0x0,
+    H2_FRAME_HEADERS = 0x1,
+    H2_FRAME_PRIORITY = 0x2,
+    H2_FRAME_RST_STREAM = 0x3,
+    H2_FRAME_SETTINGS = 0x4,
+    H2_FRAME_PUSH_PROMISE = 0x5,
+    H2_FRAME_PING = 0x6,
+    H2_FRAME_GOAWAY = 0x7,
+    H2_FRAME_WINDOW_UPDATE = 0x8,
+    H2_FRAME_CONTINUATION = 0x9
+} h2_frame_type;
+
+#define H2_FLAG_END_STREAM 0x1
+#define H2_FLAG_ACK 0x1
+#define H2_FLAG_END_HEADERS 0x4
+
+#define H2_SETTINGS_HEADER_TABLE_SIZE 0x1
+#define H2_SETTINGS_ENABLE_PUSH 0x2
+#define H2_SETTINGS_MAX_CONCURRENT_STREAMS 0x3
+#define H2_SETTINGS_INITIAL_WINDOW_SIZE 0x4
+
+typedef struct
+{
+    uint32_t stream_id;         // 0 means the slot is free.
+    uint32_t window_consumed;   // DATA bytes received since the last WINDOW_UPDATE of the stream.
+    uint64_t started_ns;        // When the HEADERS of the request was queued.
+} h2_stream;
+
+/**
+ * Client side of one HTTP/2 connection, independent from the socket or TLS layer below it.
+ *
+ * The caller appends received bytes to recv_buffer, calls h2_session_process() and writes out
+ * send_buffer[send_offset, send_len). Every stream carries the same precomputed header block.
+ */
+typedef struct
+{
+    const unsigned char *header_block;
+    size_t header_block_len;
+    int max_streams;                    // Concurrent streams wanted by the caller.
+    uint32_t peer_max_streams;          // SETTINGS_MAX_CONCURRENT_STREAMS of the server.
+    bool peer_settings_received;
+    bool goaway_received;
+    uint32_t goaway_last_stream_id;
+    uint32_t next_stream_id;
+    int active_streams;
+    h2_stream streams[MAX_H2_STREAMS];
+    uint32_t connection_window_consumed;
+    bool expect_continuation;           // A HEADERS frame without END_HEADERS has been received.
+    uint32_t continuation_stream_id;
+    bool continuation_end_stream;
+    unsigned char send_buffer[H2_SEND_BUFFER_SIZE];
+    size_t send_len;
+    size_t send_offset;
+    unsigned char recv_buffer[H2_RECV_BUFFER_SIZE];
+    size_t recv_len;
+    int completed;                      // Streams completed since the caller last collected the counters.
+    int failed;                         // Streams reset by the server since the caller last collected the counters.
+    uint64_t data_bytes;                // Payload of the received DATA frames, the rest is framing and headers.
+    Histogram *latency;                 // Optional, latency of the completed streams is recorded in it.
+    Histogram *interval_latency;        // Optional, the same for the current report interval.
+    uint64_t now_ns;                    // Current time set by the caller before calling into the session.
+} H2Session;
+
+/**
+ * Reset the session and queue the connection preface, the client SETTINGS and the connection WINDOW_UPDATE.
+ */
+void h2_session_init(H2Session *session, const unsigned char *header_block, size_t header_block_len, int max_streams);
+
+/**
+ * Open new streams until the concurrency limit is reached or the send buffer is full.
+ * Streams are only opened after the SETTINGS of the server has been received.
+ *
+ * return:
+ *      Return the number of streams opened.
+ */
+int h2_session_submit_requests(H2Session *session);
+
+/**
+ * Parse all complete frames in the receive buffer, answer SETTINGS/PING, replenish flow control
+ * windows and refill the finished streams.
+ *
+ * return:
+ *      Return 0 if the received frames are processed.
+ *      Return -1 if the server violated the protocol, the connection should be dropped.
+ */
+int h2_session_process(H2Session *session);
+
+/**
+ * Mark the first n bytes of the pending output as written to the socket.
+ */
+void h2_session_consume_output(H2Session *session, size_t n);
+
+/**
+ * Check if there's output waiting to be written to the socket.
+ */
+bool h2_session_want_write(const H2Session *session);
+
+/**
+ * Check if the session can not carry new streams anymore(GOAWAY received or stream ids exhausted)
+ * and all its streams are finished, so the connection should be re-established.
+ */
+bool h2_session_is_finished(const H2Session *session);
+
+#endif
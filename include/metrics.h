@@ -0,0 +1,55 @@
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "process_stats.h"
+
+#define METRICS_BUFFER_SIZE 16384
+#define METRICS_UNIX_PREFIX "unix:"
+#define METRICS_DEFAULT_HOST "127.0.0.1"
+#define METRICS_PATH_LEN 108
+
+/**
+ * Serve the results published by the workers in the Prometheus text format, from a thread of its own.
+ * Scrapes only copy the published snapshots under their sequence locks, the workers never wait for them.
+ */
+typedef struct
+{
+    int listen_fd;
+    char unix_path[METRICS_PATH_LEN];   // Removed when the server stops, empty for TCP.
+    const ProcessStats *published;
+    int published_count;
+    uint64_t start_ns;
+    bool stopping;
+    bool started;
+    pthread_t thread;
+} MetricsServer;
+
+/**
+ * Listen on address, either "[host:]port", on 127.0.0.1 without a host, or "unix:path",
+ * and serve the results published in the published_count elements of published.
+ *
+ * RETURNS:
+ *      Positive number: The server is running.
+ *      Negative number: The address is malformed, can't be listened on, or the thread could not be created.
+ */
+int metrics_server_start(MetricsServer *server, const char *address, const ProcessStats *published, int published_count);
+
+/**
+ * Stop serving, waiting for the scrape being served.
+ */
+void metrics_server_stop(MetricsServer *server);
+
+/**
+ * Render the results of the workers in the Prometheus text exposition format.
+ *
+ * RETURNS:
+ *      Non-negative number: The length of the text.
+ *      Negative number: The buffer is too small.
+ */
+int metrics_render(const ProcessStats *total, int workers, double uptime_seconds, char *buffer, size_t size);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef _PROCESS_STATS_H
+#define _PROCESS_STATS_H
+
+#include <stdint.h>
+#include "histogram.h"
+#include "resource_usage.h"
+
+/**
+ * Results a worker publishes in memory shared with its readers, the parent process or the metrics endpoint.
+ * They are written under a sequence lock: the sequence is odd while the writer is updating them,
+ * so a reader retries when it changed or was odd.
+ */
+typedef struct
+{
+    uint64_t sequence;
+    uint64_t speed;
+    uint64_t failed;
+    uint64_t header_bytes;
+    uint64_t payload_bytes;
+    uint64_t mismatched;
+    uint64_t bench_ns;          // Benched since the warm-up of the worker, zero while it warms up.
+    Histogram latency;          // Request latency.
+    ResourceUsage usage;        // Of the event loop of the worker, published when it's done.
+} ProcessStats;
+
+/**
+ * Start updating the published results, only one writer per ProcessStats.
+ */
+void process_stats_begin_write(ProcessStats *stats);
+
+void process_stats_end_write(ProcessStats *stats);
+
+/**
+ * Copy a consistent snapshot of the results being published by a worker.
+ */
+void process_stats_read(const ProcessStats *stats, ProcessStats *snapshot);
+
+/**
+ * Sum up the results published by the workers so far, the bench time is the longest one since they run side by side.
+ */
+void process_stats_aggregate(const ProcessStats *published, int count, ProcessStats *total);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _PROCS_H
+#define _PROCS_H
+
+#include <stdint.h>
+#include "arguments.h"
+#include "request.h"
+#include "process_stats.h"
+
+/**
+ * Fork --procs worker processes running the epoll engine on their share of the clients,
+ * and aggregate their results live from shared memory.
+ */
+void bench_processes(const Arguments *args, const HTTPRequest *http_request);
+
+#endif
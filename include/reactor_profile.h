@@ -0,0 +1,91 @@
+#ifndef _REACTOR_PROFILE_H
+#define _REACTOR_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "histogram.h"
+
+// The windows of the loop lag, merged pairwise into longer ones when they run out.
+#define REACTOR_LAG_WINDOWS 1024
+#define REACTOR_LAG_WINDOW_NS 1000000000ull
+
+// The generator is the bottleneck beyond these.
+#define REACTOR_BUSY_LIMIT 0.9
+#define REACTOR_LAG_RISE_MIN_NS 1000000ull
+
+typedef enum
+{
+    REACTOR_WAIT,       // Blocked in epoll_wait.
+    REACTOR_SSL,        // TLS handshakes, encryption and decryption.
+    REACTOR_PARSE,      // Parsing the responses and the HTTP/2 frames.
+    REACTOR_IO,         // Plain send and recv.
+    REACTOR_OTHER,      // Everything else, e.g. connecting and registering the sockets.
+    REACTOR_PHASES
+} reactor_phase;
+
+/**
+ * Where the time of an event loop goes, and how long the events wait for it once they are ready.
+ * The loop is always in one phase, switching charges the time since the last switch to the phase left.
+ */
+typedef struct
+{
+    uint64_t phase_ns[REACTOR_PHASES];
+    reactor_phase phase;
+    uint64_t switched_ns;
+
+    Histogram lag;                                  // From the end of the previous turn to handling each event.
+    double window_lag_ns[REACTOR_LAG_WINDOWS];      // Mean lag of each window.
+    int windows_count;
+    uint64_t window_ns;                             // Length of the windows.
+    uint64_t window_started_ns;
+    uint64_t window_lag_sum;
+    uint64_t window_lag_count;
+} ReactorProfile;
+
+/**
+ * Start profiling at now_ns, in the other phase.
+ */
+void reactor_profile_init(ReactorProfile *profile, uint64_t now_ns);
+
+/**
+ * Charge the time up to now_ns to the current phase, and switch to the given one.
+ *
+ * RETURNS:
+ *      The phase left, to switch back to.
+ */
+reactor_phase reactor_profile_switch(ReactorProfile *profile, reactor_phase phase, uint64_t now_ns);
+
+/**
+ * Record that an event is handled at now_ns, lag_ns after the previous turn of the loop ended,
+ * leaving out the time the loop was blocked waiting for it.
+ */
+void reactor_profile_record_lag(ReactorProfile *profile, uint64_t lag_ns, uint64_t now_ns);
+
+/**
+ * Get the fraction(0 - 1) of the time the loop wasn't waiting for events.
+ */
+double reactor_profile_busy(const ReactorProfile *profile);
+
+/**
+ * Get how much the mean loop lag rose over the windows, by a least squares fit, 0 for less than three windows.
+ */
+double reactor_profile_lag_rise_ns(const ReactorProfile *profile);
+
+/**
+ * Tell if the loop was the bottleneck of the bench: busy beyond REACTOR_BUSY_LIMIT, or a loop lag rising by
+ * more than REACTOR_LAG_RISE_MIN_NS and more than it was at first.
+ */
+bool reactor_profile_saturated(const ReactorProfile *profile);
+
+/**
+ * Print the time split and the loop lag, then warn if the loop was the bottleneck.
+ */
+void reactor_profile_print(const ReactorProfile *profile, FILE *stream);
+
+/**
+ * Only warn if the loop was the bottleneck, nothing is printed otherwise.
+ */
+void reactor_profile_print_warnings(const ReactorProfile *profile, FILE *stream);
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * An access log to replay, one request per line with tab separated fields:
+ *      <timestamp>\t<method>\t<path>[\t<header: value>]...
+ * The timestamp is in seconds with an optional fraction, e.g. 1700000000.125, and only the time elapsed
+ * since the first line matters. Empty lines and lines starting with '#' are skipped.
+ *
+ * The file is memory mapped and read once from the beginning, the pages already read are dropped
+ * so a log larger than the memory can be replayed.
+ */
+typedef struct
+{
+    const char *data;
+    size_t size;
+    size_t offset;              // Start of the next line.
+    size_t released;            // Pages before it have been dropped.
+    bool has_first_timestamp;
+    uint64_t first_timestamp_ns;
+    uint64_t last_offset_ns;
+    uint64_t line_number;
+} ReplayLog;
+
+/**
+ * A request of the log, the texts point into the mapped file and are not terminated.
+ */
+typedef struct
+{
+    uint64_t offset_ns;         // Time since the first request of the log.
+    const char *method;
+    size_t method_len;
+    const char *path;
+    size_t path_len;
+    const char *headers;        // The remaining tab separated fields.
+    size_t headers_len;
+} ReplayEntry;
+
+/**
+ * Dispatch the requests of a log at their scheduled times, compressed by the speed factor.
+ */
+typedef struct
+{
+    ReplayLog log;
+    double speed;               // 1 - Original timing, 2 - Twice as fast...
+    uint64_t start_ns;          // When the first request was due.
+    ReplayEntry next;
+    bool has_next;
+    bool finished;              // The log has been replayed to its end.
+} ReplaySchedule;
+
+/**
+ * Map the log file for reading.
+ *
+ * RETURNS:
+ *      Positive number: The log is opened.
+ *      Negative number: The file can't be opened or mapped.
+ */
+int replay_log_open(ReplayLog *log, const char *path);
+
+/**
+ * Read the next request of the log.
+ *
+ * RETURNS:
+ *      Positive number: The entry is filled in.
+ *                 Zero: The end of the log.
+ *      Negative number: The line is malformed.
+ */
+int replay_log_next(ReplayLog *log, ReplayEntry *entry);
+
+void replay_log_close(ReplayLog *log);
+
+/**
+ * Open the log and start the schedule from now_ns.
+ *
+ * RETURNS:
+ *      Positive number: The schedule is ready.
+ *      Negative number: The log can't be read.
+ */
+int replay_schedule_init(ReplaySchedule *schedule, const char *path, double speed, uint64_t now_ns);
+
+/**
+ * Take the next request if it's due at now_ns, late_ns is set to how long it has been waiting.
+ *
+ * RETURNS:
+ *      Positive number: The entry is due and has been taken.
+ *                 Zero: The next request is not due yet, or the log has ended (see finished).
+ *      Negative number: The log is malformed.
+ */
+int replay_schedule_take(ReplaySchedule *schedule, uint64_t now_ns, ReplayEntry *entry, uint64_t *late_ns);
+
+/**
+ * Get when the next request is due, reading it ahead, so the loop can sleep until then.
+ *
+ * RETURNS:
+ *      Positive number: due_ns is set.
+ *                 Zero: The log has ended.
+ *      Negative number: The line read is malformed, and skipped.
+ */
+int replay_schedule_next_due(ReplaySchedule *schedule, uint64_t *due_ns);
+
+/**
+ * Render the request of the entry from the base request, which has an empty path in its request line.
+ * The method and path come from the entry, and its headers are appended to the ones of the base.
+ *
+ * RETURNS:
+ *      Positive number: The length of the rendered request.
+ *      Negative number: The request is larger than the buffer, or the base is not HTTP/1.x.
+ */
+int replay_render(const ReplayEntry *entry, const char *base_request, char *buffer, size_t size);
+
+#endif
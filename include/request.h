@@ -2,6 +2,7 @@
 #define _REQUEST_H
 
 #include "arguments.h"
+#include "template.h"
 
 #define MAXHOSTNAMELENGTH 128
 #define REQUEST_BODY_SIZE 2048
@@ -10,10 +11,15 @@ typedef struct
 {
     char host[MAXHOSTNAMELENGTH];
     char body[REQUEST_BODY_SIZE];
+    unsigned char h2_header_block[REQUEST_BODY_SIZE]; /* HPACK encoded headers, only built for HTTP/2. */
+    int h2_header_block_len;
+    RequestTemplate request_template; /* The body compiled for rendering, only with --path-template. */
+    int templated;                    /* The body has placeholders, so each request is rendered from request_template. */
 } HTTPRequest;
 
 /**
  * Build a http request string according the arguments parsed from command line.
+ * For HTTP/2, the HPACK header block of the request is built instead.
  * RETURNS:
  *      Return negative if any error.
  */
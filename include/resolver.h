@@ -0,0 +1,99 @@
+#ifndef _RESOLVER_H
+#define _RESOLVER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#define MAX_DNS_ENTRIES 64
+#define MAX_DNS_ADDRS 8
+#define DNS_HOST_LEN 128
+// A failed lookup is retried after this long.
+#define DNS_NEGATIVE_TTL_NS 1000000000ull
+
+typedef enum
+{
+    DNS_RESOLVING,      // The first lookup is running.
+    DNS_READY,
+    DNS_FAILED
+} dns_state;
+
+/**
+ * The addresses of host:port, in the order getaddrinfo() returned them.
+ */
+typedef struct
+{
+    struct sockaddr_storage addrs[MAX_DNS_ADDRS];
+    socklen_t addr_lens[MAX_DNS_ADDRS];
+    int count;
+} DnsAddresses;
+
+typedef struct
+{
+    char host[DNS_HOST_LEN];
+    int port;
+    dns_state state;
+    DnsAddresses addresses;
+    uint64_t expires_ns;
+    bool queued;            // Waiting for or in the resolver thread, the addresses are refreshed in the background.
+    int error;              // The getaddrinfo() error of the last lookup.
+} DnsEntry;
+
+/**
+ * Name resolution off the event loop: lookups run in a thread, which signals each completion on an eventfd,
+ * and the results are cached. An expired entry keeps being used while it's refreshed in the background.
+ *
+ * getaddrinfo() doesn't give the TTL of the records, so entries expire after a fixed time instead.
+ */
+typedef struct
+{
+    DnsEntry entries[MAX_DNS_ENTRIES];
+    int entries_count;
+    uint64_t ttl_ns;
+    int queue[MAX_DNS_ENTRIES];     // Entries to look up, as a ring.
+    int queue_head;
+    int queue_len;
+    int event_fd;                   // Readable once a lookup has completed.
+    bool stopping;
+    bool started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} Resolver;
+
+/**
+ * Start the resolver thread, caching the results for ttl_seconds.
+ *
+ * RETURNS:
+ *      Positive number: The resolver is running.
+ *      Negative number: The eventfd or the thread could not be created.
+ */
+int resolver_init(Resolver *resolver, int ttl_seconds);
+
+/**
+ * Stop the resolver thread, waiting for the running lookup.
+ */
+void resolver_free(Resolver *resolver);
+
+/**
+ * Get the cached addresses of host:port, without blocking. A missing or expired entry is queued for the thread.
+ *
+ * RETURNS:
+ *      Positive number: The addresses are copied.
+ *                 Zero: The lookup is running, try again once the eventfd is readable.
+ *      Negative number: The lookup failed, error is set to the getaddrinfo() error.
+ */
+int resolver_lookup(Resolver *resolver, const char *host, int port, uint64_t now_ns, DnsAddresses *addresses, int *error);
+
+/**
+ * Reset the eventfd after it became readable.
+ */
+void resolver_drain(Resolver *resolver);
+
+/**
+ * Whether some first lookups are running, which connections wait for.
+ */
+bool resolver_busy(Resolver *resolver);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef _RESOURCE_USAGE_H
+#define _RESOURCE_USAGE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * What a worker thread cost the OS, to compare the engines by the CPU they spend per request.
+ * The struct holds no pointers, so the workers can publish it in shared memory.
+ */
+typedef struct
+{
+    uint64_t user_ns;
+    uint64_t sys_ns;
+    uint64_t voluntary_switches;    // Blocked, e.g. waiting for I/O.
+    uint64_t involuntary_switches;  // Preempted, e.g. by the server sharing the CPUs.
+    uint64_t minor_faults;
+    uint64_t major_faults;
+    uint64_t peak_rss_kb;           // Of the whole process.
+    uint64_t cycles;                // Zero without the perf counters.
+    uint64_t instructions;
+} ResourceUsage;
+
+/**
+ * Hardware counters of the calling thread, by perf_event_open().
+ */
+typedef struct
+{
+    int cycles_fd;
+    int instructions_fd;
+} PerfCounters;
+
+/**
+ * Read the usage of the calling thread by getrusage(RUSAGE_THREAD), and the peak RSS from /proc/self/status.
+ * The perf counters are read too unless counters is NULL.
+ *
+ * RETURNS:
+ *      Positive number: The usage is read.
+ *      Negative number: getrusage() failed.
+ */
+int resource_usage_read(ResourceUsage *usage, const PerfCounters *counters);
+
+/**
+ * Subtract the usage at the start of the bench, the peak RSS is kept as it is.
+ */
+void resource_usage_since(ResourceUsage *usage, const ResourceUsage *start);
+
+/**
+ * Add the usage of another worker, the peak RSS is the largest one.
+ */
+void resource_usage_add(ResourceUsage *total, const ResourceUsage *usage);
+
+/**
+ * Print the usage in one line, with the CPU per request, then the cycles and instructions per request if counted.
+ */
+void resource_usage_print(const ResourceUsage *usage, const char *name, double elapsed_seconds, uint64_t requests,
+                          FILE *stream);
+
+/**
+ * Start counting the cycles and instructions of the calling thread, in the kernel too when it's allowed.
+ *
+ * RETURNS:
+ *      Positive number: The counters are counting.
+ *      Negative number: perf_event_open() is not available, e.g. not permitted or in a virtual machine.
+ */
+int perf_counters_open(PerfCounters *counters);
+
+void perf_counters_close(PerfCounters *counters);
+
+#endif
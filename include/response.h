@@ -0,0 +1,80 @@
+#ifndef _RESPONSE_H
+#define _RESPONSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "body_hash.h"
+
+#define CHUNK_SIZE_LINE_LEN 32
+
+typedef enum
+{
+    RESPONSE_HEADERS,           // Waiting for the end of the headers.
+    RESPONSE_BODY_LENGTH,       // Body delimited by Content-Length.
+    RESPONSE_CHUNK_SIZE,        // Reading the size line of a chunk.
+    RESPONSE_CHUNK_DATA,        // Reading the data of a chunk.
+    RESPONSE_CHUNK_DATA_END,    // Reading the CRLF after the data of a chunk.
+    RESPONSE_TRAILERS,          // Reading the trailers after the last chunk.
+    RESPONSE_BODY_UNTIL_CLOSE,  // No length given, the body ends when the server closes the connection.
+    RESPONSE_COMPLETE
+} response_state;
+
+/**
+ * Incremental parser of HTTP/1.x responses, used to find where a response ends on a kept-alive connection.
+ * The body is only counted, never stored.
+ */
+typedef struct
+{
+    response_state state;
+    bool head_request;              // Responses to HEAD never have a body.
+    int status_code;
+    bool keep_alive;                // The connection can carry the next request after this response.
+    uint64_t remaining;             // Bytes left in the body or in the current chunk.
+    char chunk_line[CHUNK_SIZE_LINE_LEN];
+    size_t chunk_line_len;
+    size_t trailer_line_len;
+    size_t header_bytes;
+    uint64_t body_bytes;
+    bool hash_body;                 // Hash the body as it's consumed, without the chunk framing.
+    BodyHash body_hash;
+} HTTPResponseParser;
+
+/**
+ * Initialize the parser for the responses to the requests of one connection.
+ */
+void response_parser_init(HTTPResponseParser *parser, bool head_request, bool hash_body);
+
+/**
+ * Reset the parser for the next response, keeping how it was initialized.
+ */
+void response_parser_reset(HTTPResponseParser *parser);
+
+/**
+ * Parse the status line and headers held at the beginning of buf.
+ *
+ * RETURNS:
+ *      Positive number: The length of the headers including the terminating empty line.
+ *                 Zero: The headers are not complete yet.
+ *      Negative number: The response is malformed.
+ */
+int response_parse_headers(HTTPResponseParser *parser, const char *buf, size_t len);
+
+/**
+ * Consume received body bytes, after the headers have been parsed.
+ *
+ * RETURNS:
+ *      Non-negative number: The bytes consumed, less than len if the response completed within data.
+ *      Negative number: The body is malformed.
+ */
+ssize_t response_consume_body(HTTPResponseParser *parser, const char *data, size_t len);
+
+/**
+ * Tell the parser the server closed the connection, which completes a body without length.
+ */
+void response_connection_closed(HTTPResponseParser *parser);
+
+bool response_is_complete(const HTTPResponseParser *parser);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef _RESULTS_H
+#define _RESULTS_H
+
+#include <stdint.h>
+#include "arguments.h"
+#include "histogram.h"
+
+#define RESULTS_VERSION 1
+// A day of samples at the default period.
+#define MAX_RESULT_SAMPLES 86400
+#define RESULT_SAMPLE_NS 1000000000ull
+
+/**
+ * The results of a bench, written with --json so that runs can be compared later.
+ * Besides the totals, the requests completed in each sample period are kept, to tell the noise of the throughput.
+ */
+typedef struct
+{
+    char url[MAX_URL_LEN];
+    int clients;
+    int procs;
+    double duration_seconds;
+    uint64_t requests;
+    uint64_t failed;
+    uint64_t header_bytes;
+    uint64_t payload_bytes;
+    uint64_t mismatched;
+    Histogram latency;                      // Request latency, merged over the whole bench.
+    double sample_seconds;                  // Period of the samples.
+    uint64_t samples[MAX_RESULT_SAMPLES];   // Requests completed in each period.
+    int samples_count;
+    uint64_t sampled_requests;              // Requests completed up to the last sample.
+    uint64_t sampled_ns;                    // Time of the last sample.
+} BenchResults;
+
+/**
+ * Start sampling the results of a bench starting at start_ns.
+ */
+void results_init(BenchResults *results, const Arguments *args, uint64_t start_ns);
+
+/**
+ * Take the samples of the periods elapsed up to now_ns, given the requests completed so far.
+ * The completed requests of periods the loop missed are spread evenly over them.
+ * Fewer completed requests than at the last sample start the samples over.
+ */
+void results_sample(BenchResults *results, uint64_t completed, uint64_t now_ns);
+
+/**
+ * Write the results to path in JSON.
+ *
+ * RETURNS:
+ *      Positive number: The results are written.
+ *      Negative number: The file could not be written.
+ */
+int results_write(const BenchResults *results, const char *path);
+
+/**
+ * Read the results written by results_write().
+ *
+ * RETURNS:
+ *      Positive number: The results are read.
+ *      Negative number: The file could not be read or is malformed.
+ */
+int results_read(BenchResults *results, const char *path);
+
+#endif
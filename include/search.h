@@ -0,0 +1,49 @@
+#ifndef _SEARCH_H
+#define _SEARCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Bisection over up to MAX_CONNECTIONS connections takes far fewer probes.
+#define MAX_SEARCH_PROBES 32
+
+typedef struct
+{
+    int connections;
+    double throughput;          // Requests completed per second.
+    uint64_t p99_ns;
+    bool passed;                // Some requests completed, with p99 within the SLO.
+} SearchProbe;
+
+/**
+ * Bisection on the concurrency for the highest throughput keeping p99 within the SLO, assuming
+ * the latency grows with the concurrency. The first probe runs the most connections.
+ */
+typedef struct
+{
+    uint64_t slo_p99_ns;
+    int passed_connections;     // The most connections known to pass, 0 if none yet.
+    int failed_connections;     // The fewest connections known to fail, max + 1 if none yet.
+    int current;                // Connections of the running probe.
+    SearchProbe probes[MAX_SEARCH_PROBES];
+    int probes_count;
+} ThroughputSearch;
+
+void search_init(ThroughputSearch *search, int max_connections, uint64_t slo_p99_ns);
+
+/**
+ * Record the result of the running probe and choose the connections of the next one.
+ *
+ * RETURNS:
+ *      Positive number: The connections of the next probe.
+ *                 Zero: The search has converged on passed_connections.
+ */
+int search_record(ThroughputSearch *search, uint64_t completed, double seconds, uint64_t p99_ns);
+
+/**
+ * Print the probes ordered by connections, and the result of the search.
+ */
+void search_print(const ThroughputSearch *search, FILE *stream);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef _SOCKOPT_H
+#define _SOCKOPT_H
+
+#include "arguments.h"
+
+/**
+ * Apply the socket options given on the command line to a newly created TCP socket.
+ * It must be called before connecting, buffer sizes and TCP Fast Open have no effect after the handshake.
+ *
+ * RETURNS:
+ *      Positive number: All options have been applied.
+ *      Negative number: An option is not supported by the system.
+ */
+int apply_socket_options(int sockfd, const Arguments *args);
+
+#endif
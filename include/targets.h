@@ -0,0 +1,72 @@
+#ifndef _TARGETS_H
+#define _TARGETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "histogram.h"
+
+#define MAX_TARGETS 64
+#define TARGET_HOST_LEN 128
+#define MAX_TARGET_WEIGHT 100
+// Points of each unit of weight on the hash ring, enough to spread the keys evenly.
+#define TARGET_RING_POINTS 64
+
+typedef struct
+{
+    char host[TARGET_HOST_LEN];
+    int port;
+    int weight;
+    int64_t current_weight;     // Smooth weighted round-robin state.
+    uint64_t completed;
+    uint64_t failed;
+    Histogram latency;          // Request latency of the HTTP/1.x requests sent to this target.
+} Target;
+
+typedef struct
+{
+    uint64_t hash;
+    int target;
+} TargetPoint;
+
+/**
+ * The members of a backend pool, which connections are spread across, with their own statistics.
+ */
+typedef struct
+{
+    Target targets[MAX_TARGETS];
+    int count;
+    int balance;                // BALANCE_ROUND_ROBIN, BALANCE_WEIGHTED or BALANCE_HASH.
+    uint64_t next;              // Round-robin position.
+    TargetPoint *ring;          // Consistent hashing ring, sorted by hash.
+    int ring_size;
+} TargetPool;
+
+/**
+ * Parse the targets separated by ',', each as host[:port][@weight], e.g. "10.0.0.1:8080@3,10.0.0.2:8080".
+ *
+ * RETURNS:
+ *      Positive number: The number of targets.
+ *      Negative number: The list is malformed, or the ring can't be allocated.
+ */
+int target_pool_init(TargetPool *pool, const char *list, int default_port, int balance);
+
+void target_pool_free(TargetPool *pool);
+
+/**
+ * Choose the target of the next connection. The key is only used by consistent hashing, which
+ * sends the same key to the same target as long as the pool doesn't change.
+ */
+int target_pool_pick(TargetPool *pool, const char *key, size_t key_len);
+
+/**
+ * Start the statistics over, e.g. after the warm-up.
+ */
+void target_pool_reset_stats(TargetPool *pool);
+
+/**
+ * Print the statistics of each target, and point out the one with the highest p99.
+ */
+void target_pool_print(const TargetPool *pool, double seconds, FILE *stream);
+
+#endif
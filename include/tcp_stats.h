@@ -0,0 +1,38 @@
+#ifndef _TCP_STATS_H
+#define _TCP_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * TCP_INFO of the connections, sampled right before they are closed and summed up.
+ */
+typedef struct
+{
+    uint64_t connections;       // Connections sampled.
+    uint64_t rtt_us_sum;        // Smoothed RTT, in microseconds.
+    uint32_t rtt_us_max;
+    uint64_t retransmits;       // Segments retransmitted.
+    uint64_t segments_sent;
+    uint64_t cwnd_sum;          // Congestion window, in segments.
+    uint64_t wire_bytes_sent;   // TCP payload acknowledged by the peer, including TLS records.
+    uint64_t wire_bytes_received; // TCP payload received, including TLS records.
+} TcpStats;
+
+/**
+ * Sample TCP_INFO of the socket into stats.
+ *
+ * RETURNS:
+ *      Positive number: The socket has been sampled.
+ *      Negative number: TCP_INFO is not available on the socket.
+ */
+int tcp_stats_sample(int sockfd, TcpStats *stats);
+
+void tcp_stats_merge(TcpStats *dst, const TcpStats *src);
+
+/**
+ * Print the summary, with a warning when the retransmits show the network was the limit.
+ */
+void tcp_stats_print(const TcpStats *stats, FILE *stream);
+
+#endif
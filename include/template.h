@@ -0,0 +1,91 @@
+#ifndef _TEMPLATE_H
+#define _TEMPLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TEMPLATE_TEXT_SIZE 2048
+#define MAX_TEMPLATE_SEGMENTS 64
+#define MAX_TEMPLATE_CHOICES 128
+
+/**
+ * Placeholders of a request template:
+ *      {{seq}}             Sequence number of the request, shared by all connections, starting from 0.
+ *      {{rand:MIN-MAX}}    Random integer between MIN and MAX, both included.
+ *      {{pick:a|b|c}}      One of the tokens, chosen at random.
+ *      {{conn}}            Id of the connection sending the request.
+ */
+typedef enum
+{
+    SEGMENT_LITERAL,
+    SEGMENT_SEQUENCE,
+    SEGMENT_RANDOM,
+    SEGMENT_PICK,
+    SEGMENT_CONNECTION
+} template_segment_type;
+
+typedef struct
+{
+    template_segment_type type;
+    int offset;         // Literal: where the text starts in RequestTemplate.text.
+    int len;
+    uint64_t min;       // Random: the lowest value.
+    uint64_t range;     // Random: the count of possible values, 0 for the whole 64 bits.
+    int first_choice;   // Pick: index of the first token in RequestTemplate.choices.
+    int choices_count;
+} TemplateSegment;
+
+typedef struct
+{
+    int offset;
+    int len;
+} TemplateChoice;
+
+/**
+ * A template compiled into segments, rendered without any allocation or formatting call.
+ * Texts are referred by offset, so the template can be copied as a whole.
+ */
+typedef struct
+{
+    char text[TEMPLATE_TEXT_SIZE];
+    TemplateSegment segments[MAX_TEMPLATE_SEGMENTS];
+    int segments_count;
+    TemplateChoice choices[MAX_TEMPLATE_CHOICES];
+    int choices_count;
+} RequestTemplate;
+
+/**
+ * State of rendering held by each connection.
+ */
+typedef struct
+{
+    uint64_t *sequence;         // Shared by all connections of the same event loop.
+    uint64_t random_state;
+    int connection_id;
+} TemplateContext;
+
+/**
+ * Compile the text with placeholders into segments.
+ *
+ * RETURNS:
+ *      Positive number: The number of placeholders found.
+ *                 Zero: The text has no placeholder, it can be sent as it is.
+ *      Negative number: The template is malformed or too large.
+ */
+int template_compile(RequestTemplate *request_template, const char *text);
+
+/**
+ * Initialize the rendering state of a connection, the random sequence is seeded by the connection id.
+ */
+void template_context_init(TemplateContext *context, uint64_t *sequence, int connection_id);
+
+/**
+ * Render the template into buffer, which is terminated by '\0'.
+ *
+ * RETURNS:
+ *      Non-negative number: The length of the rendered text.
+ *      Negative number: The buffer is too small.
+ */
+int template_render(const RequestTemplate *request_template, TemplateContext *context, char *buffer, size_t size);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _TIMING_H
+#define _TIMING_H
+
+#include <stdint.h>
+
+typedef enum
+{
+    TIMING_SOURCE_MONOTONIC,    // clock_gettime(CLOCK_MONOTONIC).
+    TIMING_SOURCE_TSC           // The invariant time stamp counter, calibrated against the monotonic clock.
+} timing_source;
+
+/**
+ * Get the time of the monotonic clock in nanoseconds, only meaningful for measuring intervals.
+ */
+uint64_t get_monotonic_ns(void);
+
+/**
+ * Select the source of timing_read_ns() for the whole process, before any worker is forked.
+ * The TSC is calibrated against the monotonic clock, so the times of both sources can be mixed.
+ *
+ * RETURNS:
+ *      Positive number: The source is selected.
+ *      Negative number: The TSC is missing or not invariant, the monotonic clock stays selected.
+ */
+int timing_select_source(timing_source source);
+
+/**
+ * Get the source selected by timing_select_source().
+ */
+timing_source timing_selected_source(void);
+
+/**
+ * Read the selected source, in nanoseconds of the monotonic clock.
+ */
+uint64_t timing_read_ns(void);
+
+/**
+ * Read the selected source and keep the time for timing_loop_ns(), called once per wakeup of an event loop.
+ *
+ * RETURNS:
+ *      The time read.
+ */
+uint64_t timing_tick(void);
+
+/**
+ * Get the time of the last timing_tick() of the calling thread, for timing every event handled in the wakeup
+ * without reading the clock again. Zero before the first tick.
+ */
+uint64_t timing_loop_ns(void);
+
+#endif
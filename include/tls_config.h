@@ -0,0 +1,38 @@
+#ifndef _TLS_CONFIG_H
+#define _TLS_CONFIG_H
+
+#include <stddef.h>
+#include <openssl/ssl.h>
+
+/**
+ * A sweep list holds configurations separated by ',', each one an OpenSSL list separated by ':',
+ * e.g. "X25519,P-256:P-384" is two configurations of the key exchange groups.
+ * An empty list is one configuration keeping the OpenSSL defaults.
+ */
+int tls_sweep_count(const char *list);
+
+/**
+ * Copy the configuration at index of the sweep list.
+ *
+ * RETURNS:
+ *      Non-negative number: The length of the configuration, 0 keeps the OpenSSL defaults.
+ *      Negative number: No such configuration, or it doesn't fit in item.
+ */
+int tls_sweep_item(const char *list, int index, char *item, size_t size);
+
+/**
+ * Restrict the context to one TLS version, cipher suites and key exchange groups.
+ * Names of TLS 1.3 cipher suites start with "TLS_", the others are TLS 1.2 cipher names.
+ *
+ * RETURNS:
+ *      Positive number: The context is configured.
+ *      Negative number: OpenSSL rejected the version, a cipher or a group.
+ */
+int tls_config_apply(SSL_CTX *ctx, int version, const char *ciphers, const char *groups);
+
+/**
+ * Get the printable name of the --tls-version value, 0 being the OpenSSL default.
+ */
+const char *tls_version_name(int version);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _TOKEN_BUCKET_H
+#define _TOKEN_BUCKET_H
+
+#include <stdint.h>
+
+/**
+ * Bytes a connection may read or write, refilled at a steady rate up to the burst.
+ */
+typedef struct
+{
+    uint64_t rate;              // Bytes per second, 0 - Unlimited.
+    uint64_t burst;             // The most bytes held, what can be spent at once after being idle.
+    uint64_t tokens;
+    uint64_t refilled_ns;       // Time the tokens were last refilled up to.
+} TokenBucket;
+
+/**
+ * Initialize the bucket full, with a burst of a tenth of a second at the rate, at least one byte.
+ */
+void token_bucket_init(TokenBucket *bucket, uint64_t rate, uint64_t now_ns);
+
+/**
+ * Refill the bucket up to now.
+ *
+ * RETURNS:
+ *      The bytes which may be spent now, UINT64_MAX if the bucket is unlimited.
+ */
+uint64_t token_bucket_available(TokenBucket *bucket, uint64_t now_ns);
+
+/**
+ * Spend the bytes actually read or written, which may be more than available when a write is retried.
+ */
+void token_bucket_consume(TokenBucket *bucket, uint64_t bytes);
+
+#endif
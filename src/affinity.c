@@ -0,0 +1,216 @@
+#include "affinity.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#define PROC_LINE_LEN 4096
+
+static bool contains_cpu(const int *cpus, int count, int cpu)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (cpus[i] == cpu)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Parse a CPU list in the format of /proc/irq/N/smp_affinity_list, e.g. "0-3,8".
+ * CPUs already in cpus are skipped, so the result has no duplicates.
+ */
+static int append_cpu_list(const char *list, int *cpus, int count, int max_cpus)
+{
+    const char *p = list;
+    while (*p != '\0' && *p != '\n')
+    {
+        char *endptr = NULL;
+        long first = strtol(p, &endptr, 10);
+        if (endptr == p)
+        {
+            return -1;
+        }
+        long last = first;
+        p = endptr;
+        if ('-' == *p)
+        {
+            last = strtol(p + 1, &endptr, 10);
+            if (endptr == p + 1)
+            {
+                return -1;
+            }
+            p = endptr;
+        }
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if (!contains_cpu(cpus, count, (int)cpu) && count < max_cpus)
+            {
+                cpus[count++] = (int)cpu;
+            }
+        }
+        if (',' == *p)
+        {
+            p++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Tell if a line of /proc/interrupts, after the IRQ number, names a queue of the interface.
+ * The queue is a whole word which is the interface, or the interface followed by '-' or ':', e.g. "eth0-TxRx-3",
+ * so eth1 doesn't match eth10 nor eth0 match veth0.
+ */
+static bool names_interface(const char *line, const char *interface)
+{
+    size_t len = strlen(interface);
+    const char *word = line;
+    while (*word != '\0')
+    {
+        while (isspace((unsigned char)*word))
+        {
+            word++;
+        }
+        const char *end = word;
+        while (*end != '\0' && !isspace((unsigned char)*end))
+        {
+            end++;
+        }
+        if ((size_t)(end - word) >= len && 0 == strncmp(word, interface, len) &&
+            (word + len == end || '-' == word[len] || ':' == word[len]))
+        {
+            return true;
+        }
+        word = end;
+    }
+    return false;
+}
+
+/**
+ * Find the CPUs which the interrupts of the network interface are steered to.
+ * The interrupts are the lines of /proc/interrupts whose name is a queue of the interface, e.g. "eth0-TxRx-3".
+ */
+static int get_irq_cpus(const char *interface, int *cpus, int max_cpus)
+{
+    FILE *interrupts = fopen("/proc/interrupts", "r");
+    if (NULL == interrupts)
+    {
+        fprintf(stderr, "Can not open /proc/interrupts: %s\n", strerror(errno));
+        return -1;
+    }
+
+    char line[PROC_LINE_LEN];
+    int count = 0;
+    while (fgets(line, sizeof(line), interrupts) != NULL)
+    {
+        char *endptr = NULL;
+        long irq = strtol(line, &endptr, 10);
+        if (endptr == line || ':' != *endptr || !names_interface(endptr + 1, interface))
+        {
+            continue;
+        }
+
+        char path[64];
+        char affinity[PROC_LINE_LEN];
+        snprintf(path, sizeof(path), "/proc/irq/%ld/smp_affinity_list", irq);
+        FILE *affinity_file = fopen(path, "r");
+        if (NULL == affinity_file)
+        {
+            continue;
+        }
+        if (fgets(affinity, sizeof(affinity), affinity_file) != NULL)
+        {
+            int ret = append_cpu_list(affinity, cpus, count, max_cpus);
+            if (ret >= 0)
+            {
+                count = ret;
+            }
+        }
+        fclose(affinity_file);
+    }
+    fclose(interrupts);
+
+    if (0 == count)
+    {
+        fprintf(stderr, "No interrupt of network interface %s is found.\n", interface);
+        return -1;
+    }
+    return count;
+}
+
+int resolve_worker_cpus(const Arguments *args, int *cpus, int max_cpus)
+{
+    if (NULL == args || NULL == cpus)
+    {
+        return -1;
+    }
+
+    if (0 == strlen(args->irq_interface))
+    {
+        int count = args->cpus_count < max_cpus ? args->cpus_count : max_cpus;
+        memcpy(cpus, args->cpus, count * sizeof(int));
+        return count;
+    }
+
+    int irq_cpus[MAX_CPU_LIST];
+    int irq_count = get_irq_cpus(args->irq_interface, irq_cpus, MAX_CPU_LIST);
+    if (irq_count < 0)
+    {
+        return -1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < irq_count && count < max_cpus; i++)
+    {
+        if (0 == args->cpus_count || contains_cpu(args->cpus, args->cpus_count, irq_cpus[i]))
+        {
+            cpus[count++] = irq_cpus[i];
+        }
+    }
+    if (0 == count)
+    {
+        fprintf(stderr, "None of the CPUs given by --cpus serves the interrupts of %s.\n", args->irq_interface);
+        return -1;
+    }
+    return count;
+}
+
+int pin_current_thread(int cpu)
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Failed to pin thread to CPU %d: %s\n", cpu, strerror(ret));
+        return -1;
+    }
+
+    // Prefer the node of the CPU for later allocations, it is not an error on kernels without NUMA.
+    syscall(SYS_set_mempolicy, MPOL_LOCAL, NULL, 0);
+    return 1;
+}
+
+void *alloc_local(size_t size)
+{
+    void *memory = malloc(size);
+    if (NULL == memory)
+    {
+        return NULL;
+    }
+
+    // calloc may hand out untouched zero pages, memset faults them in on this thread's node now.
+    memset(memory, 0, size);
+    return memory;
+}
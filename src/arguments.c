@@ -6,6 +6,9 @@
 #include <string.h>
 #include <strings.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <sched.h>
+#include <openssl/tls1.h>
 
 bool is_https(const char *url);
 
@@ -13,6 +16,40 @@ bool is_supported_url(const char *url);
 
 int set_arguments_from_url(Arguments *args);
 
+int parse_cpu_list(const char *list, Arguments *args);
+
+/* Values returned by getopt_long() for the options which have no short option. */
+enum long_only_options
+{
+    OPT_STREAMS = 256,
+    OPT_SNDBUF,
+    OPT_RCVBUF,
+    OPT_CPUS,
+    OPT_IRQ_ALIGN,
+    OPT_PATH_TEMPLATE,
+    OPT_EXPECT_STATUS,
+    OPT_EXPECT_BODY_HASH,
+    OPT_INTERVAL,
+    OPT_REPLAY,
+    OPT_REPLAY_SPEED,
+    OPT_SLO_P99,
+    OPT_PROBE_TIME,
+    OPT_WARMUP,
+    OPT_PROCS,
+    OPT_TLS_VERSION,
+    OPT_CIPHERS,
+    OPT_GROUPS,
+    OPT_DNS_TTL,
+    OPT_TARGETS,
+    OPT_BALANCE,
+    OPT_SLOW_FRACTION,
+    OPT_SLOW_READ,
+    OPT_SLOW_WRITE,
+    OPT_METRICS,
+    OPT_JSON,
+    OPT_CLOCK,
+};
+
 Arguments create_default_arguments(void)
 {
     Arguments arg = {0};
@@ -25,6 +62,10 @@ Arguments create_default_arguments(void)
     arg.http10 = HTTP_VERSION_1_1;
     arg.proxy_port = DEFAULT_PROXY_PORT;
     arg.target_port = DEFAULT_TARGET_PORT;
+    arg.h2_streams = DEFAULT_H2_STREAMS;
+    arg.replay_speed = DEFAULT_REPLAY_SPEED;
+    arg.probe_time = DEFAULT_PROBE_TIME;
+    arg.dns_ttl = DEFAULT_DNS_TTL;
     return arg;
 }
 
@@ -51,6 +92,140 @@ bool validate_arguments(const Arguments *args)
         break;
     }
 
+    // HTTP/2 without TLS relies on prior knowledge of the target, a plain HTTP proxy would not understand it.
+    if (HTTP_VERSION_2 == args->http10 && PROTOCOL_HTTP == args->protocol && strlen(args->proxy_host) > 0)
+    {
+        fprintf(stderr, "HTTP/2 over a plain HTTP proxy is not supported.\n");
+        is_arguments_valid = false;
+    }
+
+    // A tunnel can only be reused when the target keeps the connection alive after each response.
+    if (args->reuse_tunnel && (PROTOCOL_HTTPS != args->protocol || 0 == strlen(args->proxy_host) || args->http10 < HTTP_VERSION_1_1))
+    {
+        fprintf(stderr, "--reuse-tunnel needs HTTPS through a proxy with HTTP/1.1 or HTTP/2.\n");
+        is_arguments_valid = false;
+    }
+
+    // The HPACK header block is encoded only once, it can't carry a different path for each request.
+    if (HTTP_VERSION_2 == args->http10 && strlen(args->path_template) > 0)
+    {
+        fprintf(stderr, "--path-template is not supported with HTTP/2.\n");
+        is_arguments_valid = false;
+    }
+
+    // Responses are only validated when they are read to the end, with a status line.
+    if ((args->expect_status || args->expect_body_hash_set) && (args->force || args->http10 < HTTP_VERSION_1_0 || HTTP_VERSION_2 == args->http10))
+    {
+        fprintf(stderr, "--expect-status and --expect-body-hash need HTTP/1.0 or HTTP/1.1 without --force.\n");
+        is_arguments_valid = false;
+    }
+
+    // Replayed requests carry their own method, path and headers in an HTTP/1.x request line.
+    if (strlen(args->replay_file) > 0 && (args->http10 < HTTP_VERSION_1_0 || HTTP_VERSION_2 == args->http10 || strlen(args->path_template) > 0))
+    {
+        fprintf(stderr, "--replay needs HTTP/1.0 or HTTP/1.1, and can't be used with --path-template.\n");
+        is_arguments_valid = false;
+    }
+
+    // The search changes the concurrency between probes, which neither a replay nor the interval reports expect.
+    if (args->slo_p99_ms > 0 && (strlen(args->replay_file) > 0 || args->report_interval > 0 || args->force))
+    {
+        fprintf(stderr, "--slo-p99 can't be used with --replay, --interval or --force.\n");
+        is_arguments_valid = false;
+    }
+
+    // Every process would replay the whole log or search on its own.
+    if (args->procs > 1 && (args->procs > args->clients || strlen(args->replay_file) > 0 || args->slo_p99_ms > 0))
+    {
+        fprintf(stderr, "--procs should be at most the clients, and can't be used with --replay or --slo-p99.\n");
+        is_arguments_valid = false;
+    }
+
+    if (args->ktls && PROTOCOL_HTTPS != args->protocol)
+    {
+        fprintf(stderr, "--ktls needs an HTTPS target.\n");
+        is_arguments_valid = false;
+    }
+
+    // Handshakes are benched on their own, without requests whose schedule or search would drive them.
+    if (args->handshake_only && (PROTOCOL_HTTPS != args->protocol || args->procs > 1 || strlen(args->replay_file) > 0 || args->slo_p99_ms > 0))
+    {
+        fprintf(stderr, "--handshake needs an HTTPS target, and can't be used with --procs, --replay or --slo-p99.\n");
+        is_arguments_valid = false;
+    }
+
+    if (args->connect_only && (args->handshake_only || args->procs > 1 || strlen(args->replay_file) > 0 || args->slo_p99_ms > 0))
+    {
+        fprintf(stderr, "--connect-only can't be used with --handshake, --procs, --replay or --slo-p99.\n");
+        is_arguments_valid = false;
+    }
+
+    // The results of each target are kept by the process benching them, and a proxy tunnel goes to the URL host.
+    if (strlen(args->targets) > 0 && (args->procs > 1 || strlen(args->proxy_host) > 0))
+    {
+        fprintf(stderr, "--targets can't be used with --procs or a proxy.\n");
+        is_arguments_valid = false;
+    }
+
+    // The target is chosen when connecting, before the replay takes the request whose path would be hashed.
+    if (BALANCE_HASH == args->balance && strlen(args->replay_file) > 0)
+    {
+        fprintf(stderr, "--balance hash can't be used with --replay.\n");
+        is_arguments_valid = false;
+    }
+
+    // The slow clients are paced only while they send requests and read responses.
+    if (args->slow_fraction > 0 && 0 == args->slow_read_rate && 0 == args->slow_write_rate)
+    {
+        fprintf(stderr, "--slow-fraction needs --slow-read or --slow-write.\n");
+        is_arguments_valid = false;
+    }
+    if ((args->slow_read_rate || args->slow_write_rate) && (args->connect_only || args->handshake_only))
+    {
+        fprintf(stderr, "--slow-read and --slow-write can't be used with --connect-only or --handshake.\n");
+        is_arguments_valid = false;
+    }
+
+    // The handshake bench runs each configuration on its own, with results of its own.
+    if (strlen(args->metrics_address) > 0 && args->handshake_only)
+    {
+        fprintf(stderr, "--metrics can't be used with --handshake.\n");
+        is_arguments_valid = false;
+    }
+
+    // The results compared are the requests of a steady load.
+    if (strlen(args->json_file) > 0 && (args->handshake_only || args->connect_only || args->slo_p99_ms > 0))
+    {
+        fprintf(stderr, "--json can't be used with --handshake, --connect-only or --slo-p99.\n");
+        is_arguments_valid = false;
+    }
+
+    // Outside of the handshake bench there is a single TLS configuration.
+    if (!args->handshake_only && (strchr(args->tls_ciphers, ',') != NULL || strchr(args->tls_groups, ',') != NULL))
+    {
+        fprintf(stderr, "Configurations separated by ',' in --ciphers and --groups need --handshake.\n");
+        is_arguments_valid = false;
+    }
+
+    // Only a resumed TLS 1.3 session can carry early data.
+    if (args->tls_early_data && (!args->handshake_only || !args->tls_resume || TLS1_2_VERSION == args->tls_version || HTTP_VERSION_2 == args->http10))
+    {
+        fprintf(stderr, "--early-data needs --handshake and --resume with TLS 1.3, and HTTP/1.x.\n");
+        is_arguments_valid = false;
+    }
+
+    if ((args->tls_version || strlen(args->tls_ciphers) > 0 || strlen(args->tls_groups) > 0 || args->tls_resume) && PROTOCOL_HTTPS != args->protocol)
+    {
+        fprintf(stderr, "--tls-version, --ciphers, --groups and --resume need an HTTPS target.\n");
+        is_arguments_valid = false;
+    }
+
+    if (args->h2_streams <= 0 || args->h2_streams > MAX_H2_STREAMS)
+    {
+        fprintf(stderr, "The number of HTTP/2 streams should be between 1 and %d.\n", MAX_H2_STREAMS);
+        is_arguments_valid = false;
+    }
+
     return is_arguments_valid;
 }
 
@@ -73,10 +248,47 @@ void set_arguments_values(int argc, char *argv[], Arguments *args)
         {"force", no_argument, &(args->force), 1},
         {"reload", no_argument, &(args->force_reload), 1},
         {"time", required_argument, NULL, 't'},
+        {"warmup", required_argument, NULL, OPT_WARMUP},
         {"help", no_argument, NULL, '?'},
         {"http09", no_argument, NULL, '9'},
         {"http10", no_argument, NULL, '1'},
         {"http11", no_argument, NULL, '2'},
+        {"http2", no_argument, &(args->http10), HTTP_VERSION_2},
+        {"streams", required_argument, NULL, OPT_STREAMS},
+        {"reuse-tunnel", no_argument, &(args->reuse_tunnel), 1},
+        {"nodelay", no_argument, &(args->tcp_nodelay), 1},
+        {"sndbuf", required_argument, NULL, OPT_SNDBUF},
+        {"rcvbuf", required_argument, NULL, OPT_RCVBUF},
+        {"fastopen", no_argument, &(args->tcp_fastopen), 1},
+        {"linger0", no_argument, &(args->linger_zero), 1},
+        {"quickack", no_argument, &(args->tcp_quickack), 1},
+        {"slow-fraction", required_argument, NULL, OPT_SLOW_FRACTION},
+        {"slow-read", required_argument, NULL, OPT_SLOW_READ},
+        {"slow-write", required_argument, NULL, OPT_SLOW_WRITE},
+        {"ktls", no_argument, &(args->ktls), 1},
+        {"connect-only", no_argument, &(args->connect_only), 1},
+        {"perf-counters", no_argument, &(args->perf_counters), 1},
+        {"profile", no_argument, &(args->reactor_profile), 1},
+        {"verbose", no_argument, &(args->verbose), 1},
+        {"handshake", no_argument, &(args->handshake_only), 1},
+        {"tls-version", required_argument, NULL, OPT_TLS_VERSION},
+        {"ciphers", required_argument, NULL, OPT_CIPHERS},
+        {"groups", required_argument, NULL, OPT_GROUPS},
+        {"resume", no_argument, &(args->tls_resume), 1},
+        {"early-data", no_argument, &(args->tls_early_data), 1},
+        {"cpus", required_argument, NULL, OPT_CPUS},
+        {"irq-align", required_argument, NULL, OPT_IRQ_ALIGN},
+        {"path-template", required_argument, NULL, OPT_PATH_TEMPLATE},
+        {"expect-status", required_argument, NULL, OPT_EXPECT_STATUS},
+        {"expect-body-hash", required_argument, NULL, OPT_EXPECT_BODY_HASH},
+        {"interval", required_argument, NULL, OPT_INTERVAL},
+        {"replay", required_argument, NULL, OPT_REPLAY},
+        {"replay-speed", required_argument, NULL, OPT_REPLAY_SPEED},
+        {"slo-p99", required_argument, NULL, OPT_SLO_P99},
+        {"probe-time", required_argument, NULL, OPT_PROBE_TIME},
+        {"metrics", required_argument, NULL, OPT_METRICS},
+        {"json", required_argument, NULL, OPT_JSON},
+        {"clock", required_argument, NULL, OPT_CLOCK},
         {"get", no_argument, &(args->method), METHOD_GET},
         {"head", no_argument, &(args->method), METHOD_HEAD},
         {"options", no_argument, &(args->method), METHOD_OPTIONS},
@@ -84,6 +296,10 @@ void set_arguments_values(int argc, char *argv[], Arguments *args)
         {"version", no_argument, NULL, 'V'},
         {"proxy", required_argument, NULL, 'p'},
         {"clients", required_argument, NULL, 'c'},
+        {"procs", required_argument, NULL, OPT_PROCS},
+        {"dns-ttl", required_argument, NULL, OPT_DNS_TTL},
+        {"targets", required_argument, NULL, OPT_TARGETS},
+        {"balance", required_argument, NULL, OPT_BALANCE},
         {NULL, 0, NULL, 0}};
 
     // Get the command line options
@@ -179,6 +395,270 @@ void set_arguments_values(int argc, char *argv[], Arguments *args)
             }
             args->clients = (int)t;
             break;
+        case OPT_STREAMS:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t <= 0 || t > MAX_H2_STREAMS)
+            {
+                fprintf(stderr, "Invalid option --streams %s: Illegal number.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->h2_streams = (int)t;
+            break;
+        case OPT_SNDBUF:
+        case OPT_RCVBUF:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t <= 0 || t > INT_MAX / 2)
+            {
+                fprintf(stderr, "Invalid option --%s %s: Illegal buffer size.\n", OPT_SNDBUF == opt ? "sndbuf" : "rcvbuf", optarg);
+                exit(EXIT_FAILURE);
+            }
+            if (OPT_SNDBUF == opt)
+            {
+                args->send_buffer_size = (int)t;
+            }
+            else
+            {
+                args->recv_buffer_size = (int)t;
+            }
+            break;
+        case OPT_SLOW_FRACTION:
+            errno = 0;
+            args->slow_fraction = strtod(optarg, &endptr);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || !(args->slow_fraction > 0 && args->slow_fraction <= 1))
+            {
+                fprintf(stderr, "Invalid option --slow-fraction %s: It should be greater than 0 and at most 1.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_SLOW_READ:
+        case OPT_SLOW_WRITE:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t <= 0 || t > INT_MAX)
+            {
+                fprintf(stderr, "Invalid option --%s %s: Illegal rate.\n", OPT_SLOW_READ == opt ? "slow-read" : "slow-write", optarg);
+                exit(EXIT_FAILURE);
+            }
+            if (OPT_SLOW_READ == opt)
+            {
+                args->slow_read_rate = (int)t;
+            }
+            else
+            {
+                args->slow_write_rate = (int)t;
+            }
+            break;
+        case OPT_CPUS:
+            if (parse_cpu_list(optarg, args) < 0)
+            {
+                fprintf(stderr, "Invalid option --cpus %s: Illegal CPU list.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_IRQ_ALIGN:
+            if (strlen(optarg) >= sizeof(args->irq_interface))
+            {
+                fprintf(stderr, "Invalid option --irq-align %s: Interface name is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->irq_interface, sizeof(args->irq_interface), "%s", optarg);
+            break;
+        case OPT_PATH_TEMPLATE:
+            if ('/' != optarg[0] || strlen(optarg) >= sizeof(args->path_template))
+            {
+                fprintf(stderr, "Invalid option --path-template %s: It should start with '/' and be shorter than %d.\n", optarg, MAX_PATH_TEMPLATE_LEN);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->path_template, sizeof(args->path_template), "%s", optarg);
+            break;
+        case OPT_EXPECT_STATUS:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t < 100 || t > 999)
+            {
+                fprintf(stderr, "Invalid option --expect-status %s: Illegal status code.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->expect_status = (int)t;
+            break;
+        case OPT_EXPECT_BODY_HASH:
+            errno = 0;
+            args->expect_body_hash = strtoull(optarg, &endptr, 16);
+            if (errno != 0 || endptr == optarg || *endptr != '\0')
+            {
+                fprintf(stderr, "Invalid option --expect-body-hash %s: Illegal hex number.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->expect_body_hash_set = 1;
+            break;
+        case OPT_INTERVAL:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t <= 0)
+            {
+                fprintf(stderr, "Invalid option --interval %s: Illegal format.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->report_interval = (int)t;
+            break;
+        case OPT_REPLAY:
+            if (strlen(optarg) >= sizeof(args->replay_file))
+            {
+                fprintf(stderr, "Invalid option --replay %s: File name is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->replay_file, sizeof(args->replay_file), "%s", optarg);
+            break;
+        case OPT_REPLAY_SPEED:
+            errno = 0;
+            args->replay_speed = strtod(optarg, &endptr);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || !(args->replay_speed > 0))
+            {
+                fprintf(stderr, "Invalid option --replay-speed %s: It should be a positive number.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_SLO_P99:
+            errno = 0;
+            args->slo_p99_ms = strtod(optarg, &endptr);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || !(args->slo_p99_ms > 0))
+            {
+                fprintf(stderr, "Invalid option --slo-p99 %s: It should be a positive number of milliseconds.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_PROBE_TIME:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t <= 0)
+            {
+                fprintf(stderr, "Invalid option --probe-time %s: Illegal format.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->probe_time = (int)t;
+            break;
+        case OPT_WARMUP:
+            // Seconds, optionally with the unit, e.g. "10" or "10s".
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || (*endptr != '\0' && strcmp(endptr, "s") != 0) || t < 0 || t > INT_MAX)
+            {
+                fprintf(stderr, "Invalid option --warmup %s: Illegal format.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->warmup_time = (int)t;
+            break;
+        case OPT_PROCS:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t <= 0 || t > MAX_PROCS)
+            {
+                fprintf(stderr, "Invalid option --procs %s: It should be between 1 and %d.\n", optarg, MAX_PROCS);
+                exit(EXIT_FAILURE);
+            }
+            args->procs = (int)t;
+            break;
+        case OPT_METRICS:
+            if (strlen(optarg) >= sizeof(args->metrics_address))
+            {
+                fprintf(stderr, "Invalid option --metrics %s: Address is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->metrics_address, sizeof(args->metrics_address), "%s", optarg);
+            break;
+        case OPT_JSON:
+            if (strlen(optarg) >= sizeof(args->json_file))
+            {
+                fprintf(stderr, "Invalid option --json %s: File name is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->json_file, sizeof(args->json_file), "%s", optarg);
+            break;
+        case OPT_CLOCK:
+            if (0 == strcmp(optarg, "monotonic"))
+            {
+                args->tsc_clock = false;
+            }
+            else if (0 == strcmp(optarg, "tsc"))
+            {
+                args->tsc_clock = true;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid option --clock %s: It should be monotonic or tsc.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_TARGETS:
+            if (strlen(optarg) >= sizeof(args->targets))
+            {
+                fprintf(stderr, "Invalid option --targets %s: List is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->targets, sizeof(args->targets), "%s", optarg);
+            break;
+        case OPT_BALANCE:
+            if (0 == strcmp(optarg, "rr"))
+            {
+                args->balance = BALANCE_ROUND_ROBIN;
+            }
+            else if (0 == strcmp(optarg, "weighted"))
+            {
+                args->balance = BALANCE_WEIGHTED;
+            }
+            else if (0 == strcmp(optarg, "hash"))
+            {
+                args->balance = BALANCE_HASH;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid option --balance %s: It should be rr, weighted or hash.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_DNS_TTL:
+            errno = 0;
+            t = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || t < 0 || t > INT_MAX)
+            {
+                fprintf(stderr, "Invalid option --dns-ttl %s: Illegal format.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            args->dns_ttl = (int)t;
+            break;
+        case OPT_TLS_VERSION:
+            if (0 == strcmp(optarg, "1.2"))
+            {
+                args->tls_version = TLS1_2_VERSION;
+            }
+            else if (0 == strcmp(optarg, "1.3"))
+            {
+                args->tls_version = TLS1_3_VERSION;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid option --tls-version %s: It should be 1.2 or 1.3.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case OPT_CIPHERS:
+            if (strlen(optarg) >= sizeof(args->tls_ciphers))
+            {
+                fprintf(stderr, "Invalid option --ciphers %s: List is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->tls_ciphers, sizeof(args->tls_ciphers), "%s", optarg);
+            break;
+        case OPT_GROUPS:
+            if (strlen(optarg) >= sizeof(args->tls_groups))
+            {
+                fprintf(stderr, "Invalid option --groups %s: List is too long.\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(args->tls_groups, sizeof(args->tls_groups), "%s", optarg);
+            break;
         }
     }
     /* No positional arguments in command line, means no URL speicified. */
@@ -229,11 +709,65 @@ void usage(void)
             "  -f|--force               Don't wait for reply from server.\n"
             "  -r|--reload              Send reload request - Pragma: no-cache.\n"
             "  -t|--time <sec>          Run benchmark for <sec> seconds. Default 30.\n"
+            "  --warmup <sec>[s]        Run the load for <sec> seconds before the benchmark, not counted in the results.\n"
             "  -p|--proxy <server:port> Use proxy server for request.\n"
             "  -c|--clients <n>         Run <n> HTTP clients at once. Default one.\n"
+            "  --procs <n>              Share the clients among <n> worker processes.\n"
+            "  --targets <list>         Connect to the pool members of <list> instead of the host of the URL, separated\n"
+            "                           by ',' as host[:port][@weight], e.g. 10.0.0.1:8080@3,10.0.0.2:8080.\n"
+            "  --balance <mode>         Spread the connections across the targets by rr (round-robin), weighted\n"
+            "                           (weighted round-robin) or hash (consistent hashing of the path). Default rr.\n"
+            "  --dns-ttl <sec>          Cache resolved addresses for <sec> seconds, refreshed in the background. Default 60.\n"
             "  -9|--http09              Use HTTP/0.9 style requests.\n"
             "  -1|--http10              Use HTTP/1.0 protocol.\n"
             "  -2|--http11              Use HTTP/1.1 protocol.\n"
+            "  --http2                  Use HTTP/2 protocol, negotiated by ALPN for HTTPS, prior knowledge for HTTP.\n"
+            "  --streams <n>            Run <n> concurrent streams on each HTTP/2 connection. Default 10.\n"
+            "  --reuse-tunnel           Keep proxy CONNECT tunnels open and reuse them across requests.\n"
+            "  --nodelay                Set TCP_NODELAY on every connection.\n"
+            "  --sndbuf <bytes>         Set SO_SNDBUF of every connection.\n"
+            "  --rcvbuf <bytes>         Set SO_RCVBUF of every connection.\n"
+            "  --fastopen               Connect with TCP Fast Open (TCP_FASTOPEN_CONNECT).\n"
+            "  --linger0                Close connections with RST to avoid TIME_WAIT (SO_LINGER 0).\n"
+            "  --quickack               Set TCP_QUICKACK on every connection.\n"
+            "  --slow-read <bytes/s>    Read the responses of the slow clients at most <bytes/s>.\n"
+            "  --slow-write <bytes/s>   Trickle the requests of the slow clients at most <bytes/s>.\n"
+            "  --slow-fraction <f>      Make the fraction <f> of the clients slow, the rest run at full speed. Default 1.\n"
+            "  --ktls                   Hand the TLS record encryption to the kernel after the handshake.\n"
+            "  --connect-only           Only connect and close, without any request, to measure connects/sec.\n"
+            "  --handshake              Only connect and run the TLS handshake, then close, to measure handshakes/sec.\n"
+            "  --tls-version <1.2|1.3>  Only use this TLS version.\n"
+            "  --ciphers <list>         Use the ciphers of <list>, separated by ':'. With --handshake, configurations\n"
+            "                           separated by ',' are benched in turn, e.g. TLS_AES_128_GCM_SHA256,TLS_AES_256_GCM_SHA384.\n"
+            "  --groups <list>          Use the key exchange groups of <list>, separated by ':'. With --handshake,\n"
+            "                           configurations separated by ',' are benched in turn, e.g. X25519,P-256.\n"
+            "  --resume                 Resume the TLS session of the previous handshake of each connection.\n"
+            "  --early-data             With --handshake, send the request as 0-RTT early data when resuming a TLS 1.3 session.\n"
+            "  --cpus <list>            Pin worker threads to the CPUs in <list>, e.g. 0-3,8.\n"
+            "  --irq-align <interface>  Pin worker threads to the CPUs serving the interrupts of <interface>.\n"
+            "  --path-template <path>   Request <path> rendered for every request, with placeholders\n"
+            "                           {{seq}}, {{rand:MIN-MAX}}, {{pick:a|b|c}} and {{conn}}.\n"
+            "  --expect-status <code>   Count responses with another status code as mismatched.\n"
+            "  --expect-body-hash <hex> Count responses whose body hash differs as mismatched.\n"
+            "  --interval <sec>         Report latency of each phase every <sec> seconds.\n"
+            "  --replay <file>          Replay the requests of an access log at their recorded times, one per line as\n"
+            "                           <timestamp>\\t<method>\\t<path>[\\t<header: value>]...\n"
+            "  --replay-speed <factor>  Replay <factor> times faster than recorded. Default 1.\n"
+            "  --slo-p99 <ms>           Search by bisection the clients, up to -c, with the highest throughput\n"
+            "                           keeping p99 within <ms>, instead of running for --time.\n"
+            "  --probe-time <sec>       Run each probe of the search for <sec> seconds. Default 5.\n"
+            "  --metrics <addr>         Serve live metrics in the Prometheus format at /metrics while benching, on\n"
+            "                           [host:]port (127.0.0.1 without a host) or unix:<path>.\n"
+            "  --json <file>            Write the results in JSON to <file>, to compare runs with\n"
+            "                           webbench2 compare [--threshold <percent>] <baseline.json> <candidate.json>.\n"
+            "  --clock <source>         Time the events by the monotonic clock or by the tsc, calibrated at start\n"
+            "                           and falling back to the monotonic clock if it's not invariant. Default monotonic.\n"
+            "  --perf-counters          Report the cycles and instructions per request of the workers, if\n"
+            "                           perf_event_open() is permitted.\n"
+            "  --profile                Report where the time of the event loop goes by phase and its lag, which costs\n"
+            "                           clock reads. A loop busy enough to limit the results is warned of anyway.\n"
+            "  --verbose                Print the progress of every connection, with its requests and responses.\n"
+            "                           It slows the bench down, for debugging only.\n"
             "  --get                    Use GET request method.\n"
             "  --head                   Use HEAD request method.\n"
             "  --options                Use OPTIONS request method.\n"
@@ -315,3 +849,59 @@ int set_arguments_from_url(Arguments *args)
     }
     return 0;
 }
+
+/**
+ * Parse a CPU list like "0-3,8,10-11" into args->cpus.
+ *
+ * RETURNS:
+ *      Positive number: The number of CPUs in the list.
+ *      Negative number: The list is malformed or too long.
+ */
+int parse_cpu_list(const char *list, Arguments *args)
+{
+    const char *p = list;
+    char *endptr = NULL;
+    long first, last;
+
+    args->cpus_count = 0;
+    while ('\0' != *p)
+    {
+        errno = 0;
+        first = strtol(p, &endptr, 10);
+        if (errno != 0 || endptr == p || first < 0 || first >= CPU_SETSIZE)
+        {
+            return -1;
+        }
+        last = first;
+        p = endptr;
+        if ('-' == *p)
+        {
+            errno = 0;
+            last = strtol(p + 1, &endptr, 10);
+            if (errno != 0 || endptr == p + 1 || last < first || last >= CPU_SETSIZE)
+            {
+                return -1;
+            }
+            p = endptr;
+        }
+
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if (args->cpus_count >= MAX_CPU_LIST)
+            {
+                return -1;
+            }
+            args->cpus[args->cpus_count++] = (int)cpu;
+        }
+
+        if (',' == *p)
+        {
+            p++;
+        }
+        else if ('\0' != *p)
+        {
+            return -1;
+        }
+    }
+    return args->cpus_count > 0 ? args->cpus_count : -1;
+}
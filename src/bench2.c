@@ -1,29 +1,95 @@
 #include "bench2.h"
 #include <pthread.h>
 #include <time.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include "communicator.h"
+#include "affinity.h"
+#include "timing.h"
+#include "resource_usage.h"
+#include <string.h>
 
 double get_time_diff_ns(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
 }
 
+/**
+ * Start counting what the worker thread costs the OS, the perf counters only with --perf-counters.
+ */
+static void start_usage(const Arguments *args, int thread_id, PerfCounters *counters, ResourceUsage *usage_start)
+{
+    counters->cycles_fd = -1;
+    counters->instructions_fd = -1;
+    if (args->perf_counters && perf_counters_open(counters) < 0 && 0 == thread_id) {
+        fprintf(stderr, "perf_event_open() is not available, the cycles and instructions are not counted.\n");
+    }
+    resource_usage_read(usage_start, counters);
+}
+
+/**
+ * Stop counting, the usage is what the worker cost since usage_start.
+ */
+static void finish_usage(PerfCounters *counters, const ResourceUsage *usage_start, ResourceUsage *usage)
+{
+    resource_usage_read(usage, counters);
+    resource_usage_since(usage, usage_start);
+    perf_counters_close(counters);
+}
+
+/**
+ * Pin the worker before it allocates anything, so its memory comes from the node of its CPU.
+ */
+static void pin_worker(int thread_id, int cpu)
+{
+    if (cpu >= 0 && pin_current_thread(cpu) > 0)
+    {
+        printf("Thread [%d] is pinned to CPU %d.\n", thread_id, cpu);
+    }
+}
+
 void* bench_worker(void *arg){
     BenchData *data = (BenchData *) arg;
+    pin_worker(data->thread_id, data->cpu);
+
     time_t start_time = time(NULL);
-    int local_speed = 0;
-    int local_failed = 0;
-    int local_bytes = 0;
+    uint64_t bench_start_ns = get_monotonic_ns();
+    uint64_t local_speed = 0;
+    uint64_t local_failed = 0;
+    uint64_t local_bytes = 0;
+    Histogram *local_latency = alloc_local(sizeof(Histogram));
+    if (NULL == local_latency) {
+        fprintf(stderr, "Memory allocation for thread [%d] failed\n", data->thread_id);
+        return NULL;
+    }
 
     printf("Thread [%d] started.\n", data->thread_id);
 
-    while(time(NULL) - start_time < data->args->bench_time) {
+    PerfCounters counters;
+    ResourceUsage usage_start;
+    start_usage(data->args, data->thread_id, &counters, &usage_start);
+
+    bool warming_up = data->args->warmup_time > 0;
+    while(warming_up || time(NULL) - start_time < data->args->bench_time) {
+        // The results start over when the warm-up is done.
+        if (warming_up && time(NULL) - start_time >= data->args->warmup_time) {
+            local_speed = 0;
+            local_failed = 0;
+            local_bytes = 0;
+            histogram_reset(local_latency);
+            resource_usage_read(&usage_start, &counters);
+            warming_up = false;
+            start_time = time(NULL);
+            bench_start_ns = get_monotonic_ns();
+        }
+
         // Send http/https request to proxy or target server.
+        uint64_t request_start_ns = get_monotonic_ns();
         int ret = communicate(data->args, data->request);
 
         if (ret >= 0)
         {
+            histogram_record(local_latency, get_monotonic_ns() - request_start_ns);
             local_bytes += ret;
             local_speed ++;
         }
@@ -37,30 +103,67 @@ void* bench_worker(void *arg){
         printf("Thread [%d] is working...\n", data->thread_id);
     }
 
+    ResourceUsage usage;
+    finish_usage(&counters, &usage_start, &usage);
+    uint64_t bench_ns = get_monotonic_ns() - bench_start_ns;
+
     pthread_mutex_lock(data->stats_mutex);
+    if (bench_ns > *(data->bench_ns)) {
+        *(data->bench_ns) = bench_ns;
+    }
+    resource_usage_add(data->usage, &usage);
     *(data->speed) += local_speed;
     *(data->failed) += local_failed;
     *(data->bytes) += local_bytes;
+    histogram_merge(data->latency, local_latency);
     pthread_mutex_unlock(data->stats_mutex);
 
+    free(local_latency);
     return NULL;
 
 }
 
 void* bench_worker_no_racing(void *arg){
     BenchDataNoRace *data = (BenchDataNoRace *) arg;
+    pin_worker(data->thread_id, data->cpu);
+
     time_t start_time = time(NULL);
-    int local_speed = 0;
-    int local_failed = 0;
-    int local_bytes = 0;
+    uint64_t bench_start_ns = get_monotonic_ns();
+    uint64_t local_speed = 0;
+    uint64_t local_failed = 0;
+    uint64_t local_bytes = 0;
+    data->latency = alloc_local(sizeof(Histogram));
+    if (NULL == data->latency) {
+        fprintf(stderr, "Memory allocation for thread [%d] failed\n", data->thread_id);
+        return NULL;
+    }
 
     printf("Thread [%d] started.\n", data->thread_id);
 
-    while(time(NULL) - start_time < data->args->bench_time) {
+    PerfCounters counters;
+    ResourceUsage usage_start;
+    start_usage(data->args, data->thread_id, &counters, &usage_start);
+
+    bool warming_up = data->args->warmup_time > 0;
+    while(warming_up || time(NULL) - start_time < data->args->bench_time) {
+        // The results start over when the warm-up is done.
+        if (warming_up && time(NULL) - start_time >= data->args->warmup_time) {
+            local_speed = 0;
+            local_failed = 0;
+            local_bytes = 0;
+            histogram_reset(data->latency);
+            resource_usage_read(&usage_start, &counters);
+            warming_up = false;
+            start_time = time(NULL);
+            bench_start_ns = get_monotonic_ns();
+        }
+
         // Send http/https request to proxy or target server.
+        uint64_t request_start_ns = get_monotonic_ns();
         int ret = communicate(data->args, data->request);
         if (ret > 0)
         {
+            histogram_record(data->latency, get_monotonic_ns() - request_start_ns);
             local_bytes += ret;
             local_speed ++;
         }
@@ -74,7 +177,8 @@ void* bench_worker_no_racing(void *arg){
         printf("Thread [%d] working...\n", data->thread_id);
     }
 
-   
+    finish_usage(&counters, &usage_start, &data->usage);
+    data->bench_ns = get_monotonic_ns() - bench_start_ns;
     (data->speed) += local_speed;
     (data->failed) += local_failed;
     (data->bytes) += local_bytes;
@@ -102,9 +206,22 @@ void bench(const Arguments *args, const HTTPRequest *http_request) {
     }
     pthread_mutex_t stats_mutext = PTHREAD_MUTEX_INITIALIZER;
 
-    int total_speed = 0;
-    int total_failed = 0;
-    int total_bytes = 0;
+    uint64_t total_speed = 0;
+    uint64_t total_failed = 0;
+    uint64_t total_bytes = 0;
+    uint64_t bench_ns = 0;
+    Histogram total_latency;
+    histogram_reset(&total_latency);
+    ResourceUsage total_usage;
+    memset(&total_usage, 0, sizeof(total_usage));
+
+    int cpus[MAX_CPU_LIST];
+    int cpus_count = resolve_worker_cpus(args, cpus, MAX_CPU_LIST);
+    if (cpus_count < 0) {
+        free(threads);
+        free(bench_data);
+        return;
+    }
 
     clock_gettime(CLOCK_MONOTONIC, &request_start);
 
@@ -118,7 +235,11 @@ void bench(const Arguments *args, const HTTPRequest *http_request) {
         bench_data[i].speed = &total_speed;
         bench_data[i].failed = &total_failed;
         bench_data[i].bytes = &total_bytes;
+        bench_data[i].latency = &total_latency;
         bench_data[i].stats_mutex = &stats_mutext;        
+        bench_data[i].usage = &total_usage;
+        bench_data[i].bench_ns = &bench_ns;
+        bench_data[i].cpu = cpus_count > 0 ? cpus[i % cpus_count] : -1;
 
         if (pthread_create(&threads[i], NULL, bench_worker, &bench_data[i])) {
             fprintf(stderr, "Failed to create thread [%d]\n", i);
@@ -135,12 +256,15 @@ void bench(const Arguments *args, const HTTPRequest *http_request) {
     clock_gettime(CLOCK_MONOTONIC, &request_end);
     // Print final statistics
     printf("\n=== Benchmark Resuls ===\n");
-    printf("Total speed: %d\n", total_speed);
-    printf("Total failed: %d\n", total_failed);
-    printf("Total bytes: %d\n", total_bytes);
+    printf("Total speed: %" PRIu64 "\n", total_speed);
+    printf("Total failed: %" PRIu64 "\n", total_failed);
+    printf("Total bytes: %" PRIu64 "\n", total_bytes);
+    histogram_print(&total_latency, "Request latency", stdout);
 
     double request_time = get_time_diff_ns(request_start, request_end);
     printf("The time spent with racing: %.9f seconds.\n", request_time);
+    // The usage starts over after the warm-up, so it is spread over the benched time only.
+    resource_usage_print(&total_usage, "Resources of all threads", bench_ns / 1e9, total_speed, stdout);
 
     // Cleanup
     free(threads);
@@ -168,9 +292,22 @@ void bench_with_no_racing(const Arguments *args, const HTTPRequest *http_request
         return;
     }
 
-    int total_speed = 0;
-    int total_failed = 0;
-    int total_bytes = 0;
+    uint64_t total_speed = 0;
+    uint64_t total_failed = 0;
+    uint64_t total_bytes = 0;
+    uint64_t bench_ns = 0;
+    Histogram total_latency;
+    histogram_reset(&total_latency);
+    ResourceUsage total_usage;
+    memset(&total_usage, 0, sizeof(total_usage));
+
+    int cpus[MAX_CPU_LIST];
+    int cpus_count = resolve_worker_cpus(args, cpus, MAX_CPU_LIST);
+    if (cpus_count < 0) {
+        free(threads);
+        free(bench_data_no_race);
+        return;
+    }
 
     clock_gettime(CLOCK_MONOTONIC, &request_start);
 
@@ -184,6 +321,10 @@ void bench_with_no_racing(const Arguments *args, const HTTPRequest *http_request
         bench_data_no_race[i].speed = 0;
         bench_data_no_race[i].failed = 0;
         bench_data_no_race[i].bytes = 0;
+        bench_data_no_race[i].latency = NULL;
+        bench_data_no_race[i].bench_ns = 0;
+        bench_data_no_race[i].cpu = cpus_count > 0 ? cpus[i % cpus_count] : -1;
+        memset(&bench_data_no_race[i].usage, 0, sizeof(ResourceUsage));
 
         if (pthread_create(&threads[i], NULL, bench_worker_no_racing, &bench_data_no_race[i])) {
             fprintf(stderr, "Failed to create thread [%d]\n", i);
@@ -202,17 +343,28 @@ void bench_with_no_racing(const Arguments *args, const HTTPRequest *http_request
         total_bytes += bench_data_no_race[i].bytes;
         total_failed += bench_data_no_race[i].failed;
         total_speed += bench_data_no_race[i].speed;
+        resource_usage_add(&total_usage, &bench_data_no_race[i].usage);
+        if (bench_data_no_race[i].bench_ns > bench_ns) {
+            bench_ns = bench_data_no_race[i].bench_ns;
+        }
+        if (NULL != bench_data_no_race[i].latency) {
+            histogram_merge(&total_latency, bench_data_no_race[i].latency);
+            free(bench_data_no_race[i].latency);
+        }
     }
 
     clock_gettime(CLOCK_MONOTONIC, &request_end);
     // Print final statistics
     printf("\n=== Benchmark Resuls ===\n");
-    printf("Total speed: %d\n", total_speed);
-    printf("Total failed: %d\n", total_failed);
-    printf("Total bytes: %d\n", total_bytes);
+    printf("Total speed: %" PRIu64 "\n", total_speed);
+    printf("Total failed: %" PRIu64 "\n", total_failed);
+    printf("Total bytes: %" PRIu64 "\n", total_bytes);
+    histogram_print(&total_latency, "Request latency", stdout);
 
     double request_time = get_time_diff_ns(request_start, request_end);
     printf("The time spent bench with no race: %.9f seconds.\n", request_time);
+    // The usage starts over after the warm-up, so it is spread over the benched time only.
+    resource_usage_print(&total_usage, "Resources of all threads", bench_ns / 1e9, total_speed, stdout);
 
     // Cleanup
     free(threads);
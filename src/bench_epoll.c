@@ -1,7 +1,25 @@
 #include "bench_epoll.h"
+#include "http2.h"
+#include "histogram.h"
+#include "response.h"
+#include "timing.h"
+#include "sockopt.h"
+#include "affinity.h"
+#include "tcp_stats.h"
+#include "replay.h"
+#include "search.h"
+#include "tls_config.h"
+#include "resolver.h"
+#include "targets.h"
+#include "token_bucket.h"
+#include "metrics.h"
+#include "results.h"
+#include "reactor_profile.h"
+#include "resource_usage.h"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
@@ -13,20 +31,86 @@
 #define MAX_CONNECTIONS 1000
 #define RECV_BUFFER_SIZE 8096
 #define BUFFER_SIZE 1024
+#define MAX_CONNECT_ERRNO 256
+#define PACING_TICK_MS 10     // Slow clients out of bytes and failed connections are retried after it.
+
+// The progress of every connection is printed only with --verbose, printing slows the loop down.
+#define VERBOSE(args, ...) do { if ((args)->verbose) { printf(__VA_ARGS__); } } while (0)
 
 typedef enum
 {
     CONN_IDLE,
+    CONN_RESOLVING,             // Waiting for the resolver thread to resolve the host.
     CONN_CONNECTING,
     CONN_PROXY_CONNECT,
     CONN_PROXY_RESPONSE,
     CONN_TLS_HANDSHAKE,
+    CONN_TLS_TICKET,            // Handshake only, waiting for the TLS 1.3 session ticket to resume the next one.
     CONN_SENDING,
     CONN_RECEIVING,
+    CONN_H2_ACTIVE,
     CONN_COMPLETED,
     CONN_ERROR
 } connection_state;
 
+typedef enum
+{
+    LATENCY_REQUEST,            // From sending the request to receiving the whole response.
+    LATENCY_TUNNEL,             // Round trip of the proxy CONNECT request.
+    LATENCY_DNS,                // Resolving the host name.
+    LATENCY_CONNECT,            // TCP handshake, from connect() to the socket becoming writable.
+    LATENCY_TLS,                // TLS handshake.
+    LATENCY_FIRST_BYTE,         // From the request being sent to the first byte of the response.
+    LATENCY_TRANSFER,           // From the first byte to the end of the response.
+    LATENCY_REPLAY_LAG,         // How late the replayed request is sent after its scheduled time.
+    LATENCY_KINDS
+} latency_kind;
+
+static const char *latency_names[LATENCY_KINDS] = {
+    "Request latency",
+    "Proxy CONNECT latency",
+    "DNS latency",
+    "Connect latency",
+    "TLS handshake latency",
+    "Time to first byte",
+    "Transfer latency",
+    "Replay lag"
+};
+
+// With slow clients, the request latency of the fast and of the slow ones is also recorded apart.
+typedef enum
+{
+    CLIENT_FAST,
+    CLIENT_SLOW,
+    CLIENT_CLASSES
+} client_class;
+
+static const char *client_class_names[CLIENT_CLASSES] = {
+    "Request latency of fast clients",
+    "Request latency of slow clients"
+};
+
+typedef struct
+{
+    Histogram histograms[LATENCY_KINDS];
+    Histogram client_requests[CLIENT_CLASSES];
+} latency_stats;
+
+typedef struct
+{
+    int clients;
+    uint64_t completed;
+    uint64_t bytes;
+} client_class_stats;
+
+/**
+ * Failed connects counted by errno, 0 counts the failures without one, e.g. of the name resolution.
+ */
+typedef struct
+{
+    uint64_t counts[MAX_CONNECT_ERRNO];
+} connect_errors;
+
 typedef struct
 {
     connection_state state;
@@ -40,9 +124,60 @@ typedef struct
     int force_flag;
     size_t bytes_sent;
     size_t bytes_received;
-    int speed;
-    int failed;
-    int bytes;
+    uint64_t speed;
+    uint64_t failed;
+    uint64_t header_bytes;      // Response status lines and headers, or HTTP/2 framing.
+    uint64_t payload_bytes;     // Response bodies.
+    TcpStats tcp;               // Sampled from each socket before it's closed.
+    uint64_t tls_handshakes;
+    uint64_t ktls_send;         // Handshakes after which the kernel encrypts the records sent.
+    uint64_t ktls_recv;         // Handshakes after which the kernel decrypts the records received.
+    uint64_t resumed_handshakes;
+    uint64_t early_data_sent;
+    uint64_t early_data_accepted;
+    bool handshake_only;        // Close the connection after the TLS handshake, without any request.
+    bool tls_resume;
+    SSL_SESSION *session;       // With --resume, the session the next handshake resumes.
+    bool session_renewed;       // A new session was received since the handshake started.
+    bool tls_early_data;
+    bool early_data_pending;    // The request is to be sent as early data before the handshake completes.
+    uint32_t tls_events;        // Epoll events the TLS handshake waits for, 0 - Not known yet.
+    bool connect_only;          // Close the connection once it's established, without TLS or any request.
+    uint64_t connects;          // Connections established.
+    connect_errors *connect_errors;
+    Resolver *resolver;         // Shared by all connections.
+    TargetPool *targets;        // Only with --targets, shared by all connections.
+    int target;                 // The target of the current connection.
+    bool prerendered;           // The templated request was rendered to choose the target by its key.
+    bool slow;                  // Paced by the buckets below, which are unlimited for the other clients.
+    TokenBucket read_bucket;
+    TokenBucket write_bucket;
+    bool throttled;             // A read was cut short by the pacing, retried even if the socket isn't readable again.
+    int retry_write_len;        // A paced TLS write which couldn't complete, retried with the same length.
+    uint64_t failed_ns;         // When the connection failed, it reconnects a pacing tick later. 0 - Not failed.
+    H2Session *h2;      // Only allocated for HTTP/2.
+    latency_stats *latency;
+    latency_stats *interval_latency;    // Only with --interval, reset after each report.
+    uint64_t request_started_ns;
+    uint64_t tunnel_started_ns;
+    uint64_t resolve_started_ns;
+    uint64_t connect_started_ns;
+    uint64_t tls_started_ns;
+    uint64_t request_sent_ns;
+    uint64_t first_byte_ns;             // 0 until the first byte of the response arrives.
+    bool reuse_tunnel;  // Keep the proxy tunnel open for the next request.
+    bool read_whole_response;   // Parse the response to its end, instead of stopping at the headers.
+    int expect_status;
+    bool expect_body_hash_set;
+    uint64_t expect_body_hash;
+    uint64_t mismatched;        // Complete responses which failed the validation.
+    HTTPResponseParser response;
+    const char *send_data;      // The request being sent, either the shared body or send_buffer.
+    char *send_buffer;          // Rendered request, only allocated when the request is templated.
+    TemplateContext template_context;
+    ReplaySchedule *replay;     // Only with --replay, shared by all connections.
+    bool replay_taken;          // The due request of the log is in send_buffer, to be sent.
+    ReactorProfile *profile;    // Time split of the loop, shared by all connections.
 } connection;
 
 static SSL_CTX *global_ssl_ctx = NULL;
@@ -111,7 +246,150 @@ static int setup_ssl_context(connection *conn)
         return -1;
     }
 
+    // New sessions are handed to the connection by store_session().
+    SSL_set_app_data(conn->ssl, conn);
+    conn->session_renewed = false;
+    conn->early_data_pending = false;
+    conn->tls_events = 0;
+    if (conn->tls_resume && conn->session != NULL)
+    {
+        SSL_set_session(conn->ssl, conn->session);
+        conn->early_data_pending = conn->tls_early_data && SSL_SESSION_get_max_early_data(conn->session) > 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Keep the newest session of the connection for its next handshake, called by OpenSSL when the server issues one.
+ */
+static int store_session(SSL *ssl, SSL_SESSION *session)
+{
+    connection *conn = (connection *) SSL_get_app_data(ssl);
+    if (NULL == conn)
+    {
+        return 0;
+    }
+
+    if (conn->session != NULL)
+    {
+        SSL_SESSION_free(conn->session);
+    }
+    conn->session = session;
+    conn->session_renewed = true;
+    // Taking the reference of the session.
+    return 1;
+}
+
+/**
+ * Apply the TLS version, ciphers and groups of the run to the context, and keep sessions for resumption.
+ *
+ * RETURNS:
+ *      Positive number: The context is configured.
+ *      Negative number: OpenSSL rejected the configuration.
+ */
+static int configure_tls(const Arguments *args)
+{
+    SSL_CTX *ctx = get_global_ssl_ctx();
+    if (NULL == ctx || tls_config_apply(ctx, args->tls_version, args->tls_ciphers, args->tls_groups) < 0)
+    {
+        return -1;
+    }
+
+    if (args->tls_resume)
+    {
+        // Sessions are kept by each connection rather than in the cache of the context.
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx, store_session);
+    }
+    return 1;
+}
+
+static int enable_h2_alpn(void)
+{
+    SSL_CTX *ctx = get_global_ssl_ctx();
+    if (NULL == ctx)
+    {
+        return -1;
+    }
+
+    // Unlike most of OpenSSL, SSL_CTX_set_alpn_protos returns 0 on success.
+    if (SSL_CTX_set_alpn_protos(ctx, (const unsigned char *)H2_ALPN_PROTOCOLS, strlen(H2_ALPN_PROTOCOLS)) != 0)
+    {
+        ERR_print_errors_fp(stderr);
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * Ask OpenSSL to hand the record encryption to the kernel after each handshake.
+ * OpenSSL falls back to userspace crypto by itself when the kernel tls module or the cipher is missing.
+ *
+ * RETURNS:
+ *      Positive number: kTLS is requested.
+ *      Negative number: This OpenSSL has no kTLS support.
+ */
+static int enable_ktls(void)
+{
+#ifdef SSL_OP_ENABLE_KTLS
+    SSL_CTX *ctx = get_global_ssl_ctx();
+    if (NULL == ctx)
+    {
+        return -1;
+    }
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
     return 1;
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Count how the handshake went: resumed or not, whether the early data was accepted,
+ * and whether the kernel took over the records.
+ */
+static void record_handshake(connection *conn)
+{
+    conn->tls_handshakes++;
+    if (SSL_session_reused(conn->ssl))
+    {
+        conn->resumed_handshakes++;
+    }
+    if (SSL_EARLY_DATA_ACCEPTED == SSL_get_early_data_status(conn->ssl))
+    {
+        conn->early_data_accepted++;
+    }
+#ifdef SSL_OP_ENABLE_KTLS
+    if (BIO_get_ktls_send(SSL_get_wbio(conn->ssl)))
+    {
+        conn->ktls_send++;
+    }
+    if (BIO_get_ktls_recv(SSL_get_rbio(conn->ssl)))
+    {
+        conn->ktls_recv++;
+    }
+#endif
+}
+
+static bool is_h2_negotiated(SSL *ssl)
+{
+    const unsigned char *alpn = NULL;
+    unsigned int alpn_len = 0;
+
+    SSL_get0_alpn_selected(ssl, &alpn, &alpn_len);
+    return (2 == alpn_len && 0 == memcmp(alpn, "h2", 2));
+}
+
+/**
+ * Switch the phase of the loop, timed by the clock itself since the loop clock is read once per wakeup.
+ *
+ * RETURNS:
+ *      The phase left, to switch back to.
+ */
+static reactor_phase enter_phase(connection *conn, reactor_phase phase)
+{
+    return conn->profile != NULL ? reactor_profile_switch(conn->profile, phase, timing_read_ns()) : phase;
 }
 
 static bool need_connect_proxy(const Arguments *args)
@@ -154,10 +432,12 @@ static int send_proxy_connect(connection *conn, const char *proxy_host, const in
         return 1;
     }
 
-    size_t bytes_sent = send(conn->sockfd, connect_request + conn->bytes_sent, remaining, 0);
+    reactor_phase left = enter_phase(conn, REACTOR_IO);
+    ssize_t bytes_sent = send(conn->sockfd, connect_request + conn->bytes_sent, remaining, 0);
+    enter_phase(conn, left);
     if (bytes_sent <= 0)
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS)
         {
             // Means that it is not an actually error, just need time to try again, due to it is non-block socket.
             return 0;
@@ -216,7 +496,9 @@ static int handle_proxy_response(connection *conn)
         }
     }
 
+    reactor_phase left = enter_phase(conn, REACTOR_IO);
     ssize_t bytes_received = recv(conn->sockfd, conn->received_response + conn->bytes_received, remaining, 0);
+    enter_phase(conn, left);
     if (bytes_received > 0)
     {
         conn->bytes_received += bytes_received;
@@ -257,7 +539,10 @@ static int handle_proxy_response(connection *conn)
 
 }
 
-static int create_nonblocking_socket(const char *host, const int port)
+/**
+ * Start connecting to the first of the resolved addresses of the host which accepts it.
+ */
+static int create_nonblocking_socket(const Arguments *args, const char *host, const int port, const DnsAddresses *addresses)
 {
     if (NULL == host || !IS_VALID_PORT(port))
     {
@@ -265,57 +550,49 @@ static int create_nonblocking_socket(const char *host, const int port)
         return -1;
     }
 
-    struct addrinfo hints = {
-        .ai_family = AF_INET,       // IP v4
-        .ai_socktype = SOCK_STREAM, // TCP
-        .ai_flags = 0,
-        .ai_protocol = 0
-    };
-    struct addrinfo *rp, *result;
-    int sockfd;
-
-    char port_str[16] = {0};
-    snprintf(port_str, 16, "%d", port);
-    int ret = getaddrinfo(host, port_str, &hints, &result);
-    if (ret != 0)
-    {
-        fprintf(stderr, "getaddrinfo error: %s\n", gai_strerror(ret));
-        return -1;
-    }
-    rp = result;
-    while (rp != NULL)
+    int sockfd = -1;
+    int last_error = 0;
+    int i;
+    for (i = 0; i < addresses->count; i++)
     {
-        sockfd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+        const struct sockaddr *addr = (const struct sockaddr *) &addresses->addrs[i];
+        sockfd = socket(addr->sa_family, SOCK_STREAM, 0);
         if (sockfd <= 0)
         {
-            // Socket create failed by using the current address info, try next.
-            rp = rp->ai_next;
+            // Socket create failed by using the current address, try next.
+            last_error = errno;
             continue;
         }
 
+        // The options are the same for every address, so a failure ends the trying.
+        if (apply_socket_options(sockfd, args) < 0)
+        {
+            last_error = errno;
+            close(sockfd);
+            i = addresses->count;
+            break;
+        }
+
         // Set non-blocking flag to the socket.
         int flag = fcntl(sockfd, F_GETFL, 0);
         fcntl(sockfd, F_SETFL, flag | O_NONBLOCK);
 
-        // Try connecting to the remote, if failed, try next address info.
-        if (connect(sockfd, rp->ai_addr, rp->ai_addrlen) == -1 && errno != EINPROGRESS)
+        // Try connecting to the remote, if failed, try next address.
+        if (connect(sockfd, addr, addresses->addr_lens[i]) == -1 && errno != EINPROGRESS)
         {
+            last_error = errno;
             close(sockfd);
-            rp = rp->ai_next;
             continue;
         }
-        else
-        {
-            break;
-        }
+        break;
     }
 
-    freeaddrinfo(result);
-    
-    if (NULL == rp)
+    if (i >= addresses->count)
     {
-        // Means no available address info can ben used.
-        fprintf(stderr, "Can not connect to %s:%s \n", host, port_str);
+        // Means no available address can be used.
+        fprintf(stderr, "Can not connect to %s:%d \n", host, port);
+        // Left for the caller to count the failure by its reason.
+        errno = last_error;
         return -1;
     }
 
@@ -337,11 +614,60 @@ static int init_connection(const Arguments *args, const HTTPRequest *http_reques
     conn->force_flag = args->force;
     conn->speed = 0;
     conn->failed = 0;
-    conn->bytes = 0;
+    conn->header_bytes = 0;
+    conn->payload_bytes = 0;
+    memset(&conn->tcp, 0, sizeof(conn->tcp));
     conn->request = http_request;
     conn->request_len = strlen(http_request->body);
+    conn->send_data = http_request->body;
+    conn->send_buffer = NULL;
     conn->bytes_sent = 0;
     conn->bytes_received = 0;
+    conn->h2 = NULL;
+    conn->replay = NULL;
+    conn->reuse_tunnel = args->reuse_tunnel && need_connect_proxy(args) && conn->is_https;
+    conn->expect_status = args->expect_status;
+    conn->expect_body_hash_set = args->expect_body_hash_set;
+    conn->expect_body_hash = args->expect_body_hash;
+    conn->mismatched = 0;
+    conn->handshake_only = args->handshake_only;
+    conn->tls_resume = args->tls_resume;
+    conn->tls_early_data = args->tls_early_data;
+    conn->session = NULL;
+    conn->connect_only = args->connect_only;
+    conn->targets = NULL;
+    conn->target = 0;
+    conn->prerendered = false;
+    conn->slow = false;
+    token_bucket_init(&conn->read_bucket, 0, 0);
+    token_bucket_init(&conn->write_bucket, 0, 0);
+    conn->throttled = false;
+    conn->retry_write_len = 0;
+    conn->failed_ns = 0;
+    conn->connects = 0;
+    conn->read_whole_response = conn->reuse_tunnel || args->expect_status || args->expect_body_hash_set;
+    response_parser_init(&conn->response, METHOD_HEAD == args->method, args->expect_body_hash_set);
+
+    if (HTTP_VERSION_2 == args->http10)
+    {
+        conn->h2 = (H2Session *) malloc(sizeof(H2Session));
+        if (NULL == conn->h2)
+        {
+            perror("Memory allocation for HTTP/2 session is failed.");
+            return -1;
+        }
+    }
+
+    if (http_request->templated || strlen(args->replay_file) > 0)
+    {
+        conn->send_buffer = (char *) malloc(REQUEST_BODY_SIZE);
+        if (NULL == conn->send_buffer)
+        {
+            perror("Memory allocation for request buffer is failed.");
+            return -1;
+        }
+        conn->send_data = conn->send_buffer;
+    }
     return 1;
 }
 
@@ -357,6 +683,7 @@ static void cleanup_connection(connection *conn)
         }
         if (conn->sockfd > 0)
         {
+            tcp_stats_sample(conn->sockfd, &conn->tcp);
             close(conn->sockfd);
             conn->sockfd = -1;
         }
@@ -365,8 +692,148 @@ static void cleanup_connection(connection *conn)
         conn->state = CONN_IDLE;
         conn->bytes_sent = 0;
         conn->bytes_received = 0;
+        conn->throttled = false;
+        conn->retry_write_len = 0;
+        conn->replay_taken = false;
         memset(conn->received_response, 0, sizeof(conn->received_response));
+        response_parser_reset(&conn->response);
+    }
+}
+
+/**
+ * Record the latency for the whole run, and for the current interval if reported.
+ */
+static void record_latency(connection *conn, latency_kind kind, uint64_t latency_ns)
+{
+    histogram_record(&conn->latency->histograms[kind], latency_ns);
+    if (conn->interval_latency != NULL)
+    {
+        histogram_record(&conn->interval_latency->histograms[kind], latency_ns);
+    }
+}
+
+/**
+ * Count the failed connect by its reason.
+ */
+static void record_connect_error(connection *conn, int error)
+{
+    if (NULL == conn->connect_errors)
+    {
+        return;
+    }
+    if (error < 0 || error >= MAX_CONNECT_ERRNO)
+    {
+        error = 0;
+    }
+    conn->connect_errors->counts[error]++;
+}
+
+/**
+ * The request has been sent, wait for the response unless it's ignored.
+ */
+static void finish_sending(connection *conn)
+{
+    conn->request_sent_ns = timing_loop_ns();
+    conn->state = conn->force_flag ? CONN_COMPLETED : CONN_RECEIVING;
+}
+
+/**
+ * Called on every successful read of the response, only the first one is timed.
+ */
+static void mark_first_byte(connection *conn)
+{
+    if (0 == conn->first_byte_ns)
+    {
+        conn->first_byte_ns = timing_loop_ns();
+        record_latency(conn, LATENCY_FIRST_BYTE, conn->first_byte_ns - conn->request_sent_ns);
+    }
+}
+
+/**
+ * Render the templated request of the connection into its own send buffer.
+ */
+static int render_request(connection *conn)
+{
+    int len = template_render(&conn->request->request_template, &conn->template_context, conn->send_buffer, REQUEST_BODY_SIZE);
+    if (len < 0)
+    {
+        fprintf(stderr, "The rendered request is larger than %d bytes.\n", REQUEST_BODY_SIZE);
+        return -1;
     }
+    conn->request_len = (size_t)len;
+    return 1;
+}
+
+/**
+ * Take the next request of the replayed log into the send buffer, if it's due.
+ *
+ * RETURNS:
+ *      Positive number: The request is ready to be sent.
+ *                 Zero: No request is due yet, or the log has ended.
+ *      Negative number: The request can't be rendered.
+ */
+static int take_replay_request(connection *conn)
+{
+    ReplayEntry entry;
+    uint64_t late_ns;
+    int result;
+
+    // Malformed lines are reported and skipped, the replay goes on with the next one.
+    while ((result = replay_schedule_take(conn->replay, timing_loop_ns(), &entry, &late_ns)) < 0)
+    {
+        fprintf(stderr, "Skipped the malformed line %llu of the replay log.\n", (unsigned long long)conn->replay->log.line_number);
+    }
+    if (0 == result)
+    {
+        return 0;
+    }
+
+    int len = replay_render(&entry, conn->request->body, conn->send_buffer, REQUEST_BODY_SIZE);
+    if (len < 0)
+    {
+        fprintf(stderr, "The replayed request of line %llu is larger than %d bytes.\n",
+                (unsigned long long)conn->replay->log.line_number, REQUEST_BODY_SIZE);
+        return -1;
+    }
+    conn->request_len = (size_t)len;
+    // The method comes from the log, the response to a replayed HEAD has no body whatever --method says.
+    conn->response.head_request = 4 == entry.method_len && 0 == memcmp(entry.method, "HEAD", 4);
+    record_latency(conn, LATENCY_REPLAY_LAG, late_ns);
+    return 1;
+}
+
+/**
+ * Choose the target of the connection, by the path of its next request when hashing.
+ *
+ * RETURNS:
+ *      Positive number: conn->target is chosen.
+ *      Negative number: The request can't be rendered.
+ */
+static int choose_target(connection *conn)
+{
+    const char *key = NULL;
+    size_t key_len = 0;
+
+    if (BALANCE_HASH == conn->targets->balance)
+    {
+        // The templated request is rendered now, and sent as it is.
+        if (conn->request->templated && !conn->prerendered)
+        {
+            if (render_request(conn) < 0)
+            {
+                return -1;
+            }
+            conn->prerendered = true;
+        }
+
+        // The key is the path of the request line, "METHOD path VERSION".
+        key = strchr(conn->send_data, ' ');
+        key = (NULL == key) ? conn->send_data : key + 1;
+        const char *key_end = strchr(key, ' ');
+        key_len = (NULL == key_end) ? strlen(key) : (size_t)(key_end - key);
+    }
+    conn->target = target_pool_pick(conn->targets, key, key_len);
+    return 1;
 }
 
 static int allocate_socket(const Arguments *args, const HTTPRequest *http_request, connection *conn)
@@ -377,19 +844,66 @@ static int allocate_socket(const Arguments *args, const HTTPRequest *http_reques
         return -1;
     }
 
-    if (need_connect_proxy(args))
+    const char *host = need_connect_proxy(args) ? args->proxy_host : args->target_host;
+    int port = need_connect_proxy(args) ? args->proxy_port : args->target_port;
+    uint64_t now_ns = timing_loop_ns();
+    if (conn->state != CONN_RESOLVING)
+    {
+        conn->resolve_started_ns = now_ns;
+        if (conn->targets != NULL && choose_target(conn) < 0)
+        {
+            conn->state = CONN_IDLE;
+            return -1;
+        }
+    }
+    if (conn->targets != NULL)
+    {
+        host = conn->targets->targets[conn->target].host;
+        port = conn->targets->targets[conn->target].port;
+    }
+
+    // The name is resolved by the resolver thread, the connection waits for it without blocking the loop.
+    DnsAddresses addresses;
+    int dns_error = 0;
+    int resolved = resolver_lookup(conn->resolver, host, port, now_ns, &addresses, &dns_error);
+    if (0 == resolved)
+    {
+        conn->state = CONN_RESOLVING;
+        return 0;
+    }
+
+    if (resolved > 0)
     {
-        conn->sockfd = create_nonblocking_socket(args->proxy_host, args->proxy_port);
+        conn->connect_started_ns = timing_loop_ns();
+        conn->sockfd = create_nonblocking_socket(args, host, port, &addresses);
     }
     else
     {
-        conn->sockfd = create_nonblocking_socket(args->target_host, args->target_port);
+        fprintf(stderr, "getaddrinfo error: %s\n", gai_strerror(dns_error));
+        conn->sockfd = -1;
+        errno = 0;
     }
 
     if (conn->sockfd <= 0)
     {
+        record_connect_error(conn, errno);
+        if (conn->connect_only)
+        {
+            // Counted as a failure and retried, instead of leaving the connection idle.
+            conn->state = CONN_ERROR;
+            conn->failed++;
+        }
+        else
+        {
+            conn->state = CONN_IDLE;
+            if (conn->targets != NULL)
+            {
+                conn->targets->targets[conn->target].failed++;
+            }
+        }
         return -1;
     }
+    record_latency(conn, LATENCY_DNS, conn->connect_started_ns - conn->resolve_started_ns);
     
     conn->state = CONN_CONNECTING;
 
@@ -398,10 +912,46 @@ static int allocate_socket(const Arguments *args, const HTTPRequest *http_reques
 
 
 
+/**
+ * Tell if the bucket holds less than it refills in a pacing tick, an unlimited one never does.
+ */
+static bool is_bucket_low(TokenBucket *bucket)
+{
+    uint64_t tick_bytes = bucket->rate * PACING_TICK_MS / 1000;
+    return token_bucket_available(bucket, timing_loop_ns()) < (tick_bytes > 0 ? tick_bytes : 1);
+}
+
+/**
+ * Tell if a slow client is to wait for its bucket, its socket would be ready again right away.
+ * It moves a tick of bytes at once rather than the few refilled by each turn of the loop.
+ */
+static bool is_paced_out(connection *conn)
+{
+    if (!conn->slow)
+    {
+        return false;
+    }
+    if (conn->throttled && is_bucket_low(&conn->read_bucket))
+    {
+        return true;
+    }
+    bool writing = CONN_SENDING == conn->state || (CONN_H2_ACTIVE == conn->state && h2_session_want_write(conn->h2));
+    return writing && 0 == conn->retry_write_len && is_bucket_low(&conn->write_bucket);
+}
+
+/**
+ * Register the sockets of the connections for the events their states wait for, replacing the finished ones.
+ * The slow clients out of bytes and the failed connections are left out and counted in paced_count,
+ * to be retried after a pacing tick.
+ *
+ * RETURNS:
+ *      The number of sockets registered, negative if the arguments are invalid or epoll_ctl() failed.
+ */
 static int setup_connection_to_epoll_instance(connection *conn, const int num_connections, 
-            const Arguments *args, const HTTPRequest *http_request, const int epoll_fd)
+            const Arguments *args, const HTTPRequest *http_request, const int epoll_fd, int *paced_count)
 {
-    if (NULL == conn || conn->sockfd < 0 || num_connections <= 0)
+    // The first connection may be waiting for its name to be resolved, without a socket yet.
+    if (NULL == conn || num_connections <= 0)
     {
         return -1;
     }
@@ -418,19 +968,78 @@ static int setup_connection_to_epoll_instance(connection *conn, const int num_co
 
     connection *curr_conn = conn;
     int epoll_fds_num = 0;
+    *paced_count = 0;
     for (int i = 0; i < num_connections; i++, curr_conn++)
     {
         struct epoll_event event = {0};
 
+        // A failed connection isn't retried as fast as the server can refuse it.
+        if (CONN_ERROR == curr_conn->state)
+        {
+            if (0 == curr_conn->failed_ns)
+            {
+                curr_conn->failed_ns = timing_loop_ns();
+            }
+            if (timing_loop_ns() - curr_conn->failed_ns < PACING_TICK_MS * 1000000ull)
+            {
+                (*paced_count)++;
+                continue;
+            }
+            curr_conn->failed_ns = 0;
+        }
+
+        // A new socket is waited for in this turn, the loop may not wake up again before the next request is due.
+        if (CONN_ERROR == curr_conn->state || CONN_COMPLETED == curr_conn->state)
+        {
+            if (CONN_ERROR == curr_conn->state && curr_conn->targets != NULL)
+            {
+                curr_conn->targets->targets[curr_conn->target].failed++;
+            }
+            cleanup_connection(curr_conn);
+            allocate_socket(args, http_request, curr_conn);
+        }
+        else if (CONN_RESOLVING == curr_conn->state)
+        {
+            // Connecting once the name is resolved, the loop wakes up on the eventfd of the resolver.
+            allocate_socket(args, http_request, curr_conn);
+        }
+
+        if (is_paced_out(curr_conn))
+        {
+            (*paced_count)++;
+            continue;
+        }
+
         switch(curr_conn->state)
         {
             case CONN_ERROR:
             case CONN_COMPLETED:
-                cleanup_connection(curr_conn);
-                allocate_socket(args, http_request, curr_conn);
+            case CONN_RESOLVING:
+                // The socket couldn't be allocated yet, it's retried in the next turn.
                 break;
-            case CONN_CONNECTING:
             case CONN_SENDING:
+                // A replaying connection stays off epoll until the next request of the log is due.
+                if (curr_conn->replay != NULL && 0 == curr_conn->bytes_sent && !curr_conn->replay_taken)
+                {
+                    int taken = take_replay_request(curr_conn);
+                    if (taken < 0)
+                    {
+                        curr_conn->state = CONN_ERROR;
+                        curr_conn->failed++;
+                        break;
+                    }
+                    if (0 == taken)
+                    {
+                        if (curr_conn->replay->finished)
+                        {
+                            curr_conn->state = CONN_IDLE;
+                        }
+                        break;
+                    }
+                    curr_conn->replay_taken = true;
+                }
+                /* fall through */
+            case CONN_CONNECTING:
             case CONN_PROXY_CONNECT:
                 event.data.ptr = curr_conn;
                 event.events = EPOLLOUT | EPOLLET;
@@ -446,8 +1055,14 @@ static int setup_connection_to_epoll_instance(connection *conn, const int num_co
                 break;
             case CONN_RECEIVING:
             case CONN_PROXY_RESPONSE:
+            case CONN_TLS_TICKET:
                 event.data.ptr = curr_conn;
                 event.events = EPOLLIN | EPOLLET;
+                if (curr_conn->throttled)
+                {
+                    // The writable socket wakes the loop up to retry the read cut short by the pacing.
+                    event.events |= EPOLLOUT;
+                }
                 if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, curr_conn->sockfd, &event) == -1)
                 {
                     if (errno != EEXIST)
@@ -459,9 +1074,9 @@ static int setup_connection_to_epoll_instance(connection *conn, const int num_co
                 epoll_fds_num++;
                 break;
             case CONN_TLS_HANDSHAKE:
-                // For TLS handshake, we might need to read or write.
+                // For TLS handshake, we might need to read or write until OpenSSL tells which one.
                 event.data.ptr = curr_conn;
-                event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+                event.events = (curr_conn->tls_events != 0 ? curr_conn->tls_events : (EPOLLIN | EPOLLOUT)) | EPOLLET;
                 if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, curr_conn->sockfd, &event) == -1)
                 {
                     if (errno != EEXIST)
@@ -472,6 +1087,24 @@ static int setup_connection_to_epoll_instance(connection *conn, const int num_co
                 }
                 epoll_fds_num++;
                 break;
+            case CONN_H2_ACTIVE:
+                // HTTP/2 connection always reads, and writes only when there are frames queued.
+                event.data.ptr = curr_conn;
+                event.events = EPOLLIN | EPOLLET;
+                if (h2_session_want_write(curr_conn->h2) || curr_conn->throttled)
+                {
+                    event.events |= EPOLLOUT;
+                }
+                if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, curr_conn->sockfd, &event) == -1)
+                {
+                    if (errno != EEXIST)
+                    {
+                        perror("H2: epoll_ctl ADD");
+                        return -1;
+                    }
+                }
+                epoll_fds_num++;
+                break;
             case CONN_IDLE:
                 break;
         }
@@ -479,49 +1112,540 @@ static int setup_connection_to_epoll_instance(connection *conn, const int num_co
     return epoll_fds_num;
 }
 
-static int handle_ready_connection(const Arguments *args, const struct epoll_event *event, const int epoll_fd)
+/**
+ * Limit a read of a slow client to what its bucket allows now.
+ * A read cut short is retried in the next cycle, since the rest may be held by TLS where epoll can't see it.
+ */
+static int pace_read(connection *conn, int len)
 {
-    if (event == NULL || epoll_fd < 0)
+    uint64_t allowed = token_bucket_available(&conn->read_bucket, timing_loop_ns());
+    if (allowed < (uint64_t)len)
     {
-        return -1;
+        conn->throttled = true;
+        return (int)allowed;
     }
+    return len;
+}
 
-    connection *conn = (connection *) event->data.ptr;
-    uint32_t ev = event->events;
+/**
+ * Limit a write of a slow client to what its bucket allows now.
+ * OpenSSL expects a write which couldn't complete to be retried with the same length.
+ */
+static int pace_write(connection *conn, int len)
+{
+    if (conn->retry_write_len > 0)
+    {
+        return conn->retry_write_len;
+    }
+    uint64_t allowed = token_bucket_available(&conn->write_bucket, timing_loop_ns());
+    return allowed < (uint64_t)len ? (int)allowed : len;
+}
 
-    // Remove from epoll (will be re-added next iterationif needed)
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->sockfd, NULL) == -1)
+/**
+ * Write to the connection, through TLS if it's HTTPS.
+ *
+ * RETURNS:
+ *      Positive number: The bytes written.
+ *                 Zero: The socket is not ready, try again in the next cycle.
+ *      Negative number: Actual error occurred.
+ */
+static int write_connection(connection *conn, const void *data, int len)
+{
+    len = pace_write(conn, len);
+    if (0 == len)
     {
-        perror("epoll_ctl DEL failed.");
-        return -1;
+        return 0;
     }
 
-    // If the event is Error.
-    if (ev & (EPOLLERR | EPOLLHUP))
+    if (conn->is_https)
     {
-        conn->state = CONN_ERROR;
-        conn->failed++;
+        reactor_phase left = enter_phase(conn, REACTOR_SSL);
+        int bytes_written = SSL_write(conn->ssl, data, len);
+        enter_phase(conn, left);
+        if (bytes_written > 0)
+        {
+            conn->retry_write_len = 0;
+            token_bucket_consume(&conn->write_bucket, bytes_written);
+            return bytes_written;
+        }
+        int ssl_error = SSL_get_error(conn->ssl, bytes_written);
+        if (ssl_error == SSL_ERROR_WANT_READ || ssl_error == SSL_ERROR_WANT_WRITE)
+        {
+            conn->retry_write_len = len;
+            return 0;
+        }
         return -1;
     }
 
-    switch(conn->state)
+    reactor_phase left = enter_phase(conn, REACTOR_IO);
+    ssize_t bytes_written = send(conn->sockfd, data, len, 0);
+    enter_phase(conn, left);
+    if (bytes_written > 0)
     {
-        case CONN_CONNECTING:
-            // Handle connection establishment.
-            if (ev & EPOLLOUT)
-            {
-                // Because it's non-block socket so before using it, check if it's really ready.
-                printf("Begin to connect...\n");
-                int error = 0;
+        token_bucket_consume(&conn->write_bucket, bytes_written);
+        return (int) bytes_written;
+    }
+    return (bytes_written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS)) ? 0 : -1;
+}
+
+/**
+ * Read from the connection, through TLS if it's HTTPS.
+ *
+ * RETURNS:
+ *      Positive number: The bytes read.
+ *                 Zero: No data is ready, try again in the next cycle.
+ *      Negative number: Actual error occurred or the peer closed the connection.
+ */
+static int read_connection(connection *conn, void *buffer, int len)
+{
+    len = pace_read(conn, len);
+    if (0 == len)
+    {
+        return 0;
+    }
+
+    if (conn->is_https)
+    {
+        reactor_phase left = enter_phase(conn, REACTOR_SSL);
+        int bytes_read = SSL_read(conn->ssl, buffer, len);
+        enter_phase(conn, left);
+        if (bytes_read > 0)
+        {
+            token_bucket_consume(&conn->read_bucket, bytes_read);
+            return bytes_read;
+        }
+        int ssl_error = SSL_get_error(conn->ssl, bytes_read);
+        if (ssl_error == SSL_ERROR_WANT_READ || ssl_error == SSL_ERROR_WANT_WRITE)
+        {
+            // Nothing was held back by the pacing, the socket is waited for again.
+            conn->throttled = false;
+            return 0;
+        }
+        return -1;
+    }
+
+    reactor_phase left = enter_phase(conn, REACTOR_IO);
+    ssize_t bytes_read = read(conn->sockfd, buffer, len);
+    enter_phase(conn, left);
+    if (bytes_read > 0)
+    {
+        token_bucket_consume(&conn->read_bucket, bytes_read);
+        return (int) bytes_read;
+    }
+    if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        conn->throttled = false;
+        return 0;
+    }
+    return -1;
+}
+
+static int flush_h2_session(connection *conn)
+{
+    H2Session *session = conn->h2;
+    while (h2_session_want_write(session))
+    {
+        int bytes_written = write_connection(conn, session->send_buffer + session->send_offset,
+                                             session->send_len - session->send_offset);
+        if (bytes_written < 0)
+        {
+            return -1;
+        }
+        if (0 == bytes_written)
+        {
+            break;
+        }
+        h2_session_consume_output(session, bytes_written);
+    }
+    return 0;
+}
+
+static void start_h2_session(const Arguments *args, connection *conn)
+{
+    h2_session_init(conn->h2, conn->request->h2_header_block, conn->request->h2_header_block_len, args->h2_streams);
+    conn->h2->latency = &conn->latency->histograms[LATENCY_REQUEST];
+    conn->h2->interval_latency = conn->interval_latency ? &conn->interval_latency->histograms[LATENCY_REQUEST] : NULL;
+    conn->state = CONN_H2_ACTIVE;
+}
+
+static int handle_h2_connection(connection *conn, uint32_t ev)
+{
+    H2Session *session = conn->h2;
+    int result = 0;
+
+    if (ev & EPOLLIN)
+    {
+        // Edge triggered, so read until the socket is drained.
+        while (session->recv_len < sizeof(session->recv_buffer))
+        {
+            int bytes_read = read_connection(conn, session->recv_buffer + session->recv_len,
+                                             sizeof(session->recv_buffer) - session->recv_len);
+            if (bytes_read < 0)
+            {
+                result = -1;
+                break;
+            }
+            if (0 == bytes_read)
+            {
+                break;
+            }
+            session->recv_len += bytes_read;
+            session->now_ns = timing_loop_ns();
+            uint64_t data_bytes = session->data_bytes;
+            reactor_phase left = enter_phase(conn, REACTOR_PARSE);
+            int processed = h2_session_process(session);
+            enter_phase(conn, left);
+            if (processed < 0)
+            {
+                fprintf(stderr, "HTTP/2 protocol error from server.\n");
+                result = -1;
+                break;
+            }
+
+            // DATA payload counts as body, everything else read is framing and headers. A frame may complete
+            // with bytes of earlier reads, the unsigned sums are still right once it's processed.
+            data_bytes = session->data_bytes - data_bytes;
+            conn->payload_bytes += data_bytes;
+            conn->header_bytes += (uint64_t)bytes_read - data_bytes;
+        }
+    }
+
+    // Collect the streams finished by the received frames.
+    conn->speed += session->completed;
+    conn->failed += session->failed;
+    if (conn->targets != NULL)
+    {
+        conn->targets->targets[conn->target].completed += session->completed;
+        conn->targets->targets[conn->target].failed += session->failed;
+    }
+    session->completed = 0;
+    session->failed = 0;
+
+    // Frames may be queued by the received ones(SETTINGS ACK, new streams...), so always try to flush.
+    if (0 == result && flush_h2_session(conn) < 0)
+    {
+        result = -1;
+    }
+
+    if (result < 0)
+    {
+        // The streams in flight are lost with the connection.
+        conn->failed += session->active_streams > 0 ? session->active_streams : 1;
+        conn->state = CONN_ERROR;
+        return -1;
+    }
+
+    if (h2_session_is_finished(session))
+    {
+        // GOAWAY received or stream ids ran out, re-connect for the next streams.
+        conn->state = CONN_COMPLETED;
+    }
+    return 0;
+}
+
+/**
+ * Count the bytes of the response held in the receive buffer, split at the end of the headers.
+ */
+static void count_received_response(connection *conn)
+{
+    const char *headers_end = strstr(conn->received_response, "\r\n\r\n");
+    size_t header_len = headers_end ? (size_t)(headers_end - conn->received_response) + 4 : conn->bytes_received;
+
+    conn->header_bytes += header_len;
+    conn->payload_bytes += conn->bytes_received - header_len;
+}
+
+/**
+ * The whole response has been received, count it and record its latency.
+ */
+static void complete_request(connection *conn)
+{
+    uint64_t now_ns = timing_loop_ns();
+    record_latency(conn, LATENCY_REQUEST, now_ns - conn->request_started_ns);
+    if (conn->first_byte_ns > 0)
+    {
+        record_latency(conn, LATENCY_TRANSFER, now_ns - conn->first_byte_ns);
+    }
+    conn->state = CONN_COMPLETED;
+    conn->speed++;
+
+    client_class client = conn->slow ? CLIENT_SLOW : CLIENT_FAST;
+    histogram_record(&conn->latency->client_requests[client], now_ns - conn->request_started_ns);
+    if (conn->interval_latency != NULL)
+    {
+        histogram_record(&conn->interval_latency->client_requests[client], now_ns - conn->request_started_ns);
+    }
+    if (conn->targets != NULL)
+    {
+        Target *target = &conn->targets->targets[conn->target];
+        target->completed++;
+        histogram_record(&target->latency, now_ns - conn->request_started_ns);
+    }
+}
+
+/**
+ * Receive the whole response, so the connection stays in sync for the next request.
+ *
+ * RETURNS:
+ *      Positive number: The response is complete.
+ *                 Zero: Not complete, continue to receive in the next cycle.
+ *      Negative number: Actual error occurred.
+ */
+static int receive_whole_response(connection *conn)
+{
+    while (true)
+    {
+        bool in_headers = (RESPONSE_HEADERS == conn->response.state);
+
+        // Headers are accumulated for parsing, the body is only counted so the buffer is reused.
+        char *buffer = in_headers ? conn->received_response + conn->bytes_received : conn->received_response;
+        int capacity = in_headers ? (int)(sizeof(conn->received_response) - conn->bytes_received - 1)
+                                  : (int)sizeof(conn->received_response) - 1;
+        if (capacity <= 0)
+        {
+            fprintf(stderr, "Response headers are too large.\n");
+            return -1;
+        }
+
+        int bytes_read = read_connection(conn, buffer, capacity);
+        if (0 == bytes_read)
+        {
+            return 0;
+        }
+        if (bytes_read < 0)
+        {
+            // Closed by server, which completes a body without length.
+            response_connection_closed(&conn->response);
+            return response_is_complete(&conn->response) ? 1 : -1;
+        }
+        mark_first_byte(conn);
+
+        if (in_headers)
+        {
+            conn->bytes_received += bytes_read;
+            conn->received_response[conn->bytes_received] = '\0';
+            reactor_phase left = enter_phase(conn, REACTOR_PARSE);
+            int header_len = response_parse_headers(&conn->response, conn->received_response, conn->bytes_received);
+            enter_phase(conn, left);
+            if (header_len < 0)
+            {
+                return -1;
+            }
+
+            // Bytes of the headers are counted once they are complete, the rest belongs to the body.
+            if (header_len > 0)
+            {
+                conn->header_bytes += header_len;
+                conn->payload_bytes += conn->bytes_received - header_len;
+            }
+            left = enter_phase(conn, REACTOR_PARSE);
+            ssize_t consumed = header_len > 0 ? response_consume_body(&conn->response, conn->received_response + header_len,
+                                                                      conn->bytes_received - header_len) : 0;
+            enter_phase(conn, left);
+            if (consumed < 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            conn->payload_bytes += bytes_read;
+            reactor_phase left = enter_phase(conn, REACTOR_PARSE);
+            ssize_t consumed = response_consume_body(&conn->response, buffer, bytes_read);
+            enter_phase(conn, left);
+            if (consumed < 0)
+            {
+                return -1;
+            }
+        }
+
+        if (response_is_complete(&conn->response))
+        {
+            return 1;
+        }
+    }
+}
+
+/**
+ * Get how long the loop may wait for events before the next request of the replayed log is due, in milliseconds
+ * rounded up, at most max_ms. Requests already due are left to the connections which complete theirs.
+ */
+static int replay_wait_ms(ReplaySchedule *replay, uint64_t now_ns, int max_ms)
+{
+    uint64_t due_ns;
+    int result;
+    while ((result = replay_schedule_next_due(replay, &due_ns)) < 0)
+    {
+        fprintf(stderr, "Skipped the malformed line %llu of the replay log.\n", (unsigned long long)replay->log.line_number);
+    }
+    if (0 == result || due_ns <= now_ns)
+    {
+        return max_ms;
+    }
+    uint64_t wait_ms = (due_ns - now_ns + 999999) / 1000000;
+    return wait_ms < (uint64_t)max_ms ? (int)wait_ms : max_ms;
+}
+
+/**
+ * Check the complete response against --expect-status and --expect-body-hash.
+ */
+static bool is_expected_response(const connection *conn)
+{
+    static bool mismatch_reported = false;
+    uint64_t hash = conn->expect_body_hash_set ? body_hash_final(&conn->response.body_hash) : 0;
+
+    if ((0 == conn->expect_status || conn->response.status_code == conn->expect_status) &&
+        (!conn->expect_body_hash_set || hash == conn->expect_body_hash))
+    {
+        return true;
+    }
+
+    // Only the first one is shown, so the actual hash can be told without flooding the output.
+    if (!mismatch_reported)
+    {
+        fprintf(stderr, "Unexpected response: status=[%d], body hash=[%016llx], body bytes=[%llu].\n",
+                conn->response.status_code, (unsigned long long)hash, (unsigned long long)conn->response.body_bytes);
+        mismatch_reported = true;
+    }
+    return false;
+}
+
+static int handle_whole_response(connection *conn)
+{
+    int result = receive_whole_response(conn);
+    if (result < 0)
+    {
+        fprintf(stderr, "Failed to receive bench response.\n");
+        conn->state = CONN_ERROR;
+        conn->failed++;
+        return -1;
+    }
+    if (0 == result)
+    {
+        return 0;
+    }
+
+    if (is_expected_response(conn))
+    {
+        complete_request(conn);
+    }
+    else
+    {
+        // A fast error page is not throughput, it's counted apart and not timed.
+        conn->state = CONN_COMPLETED;
+        conn->mismatched++;
+    }
+
+    if (conn->reuse_tunnel && conn->response.keep_alive)
+    {
+        // Send the next request through the same tunnel and TLS session.
+        conn->state = CONN_SENDING;
+        conn->bytes_sent = 0;
+        conn->bytes_received = 0;
+        response_parser_reset(&conn->response);
+    }
+    return 1;
+}
+
+/**
+ * Read until the TLS 1.3 session ticket is handed to store_session(), anything else is dropped.
+ * The ticket may already be buffered by OpenSSL, so it's read before waiting for the socket.
+ *
+ * RETURNS:
+ *      Positive number: The handshake is completed, with or without a new session.
+ *                 Zero: The ticket has not arrived yet.
+ */
+static int read_session_ticket(connection *conn)
+{
+    while (!conn->session_renewed)
+    {
+        reactor_phase left = enter_phase(conn, REACTOR_SSL);
+        int read_result = SSL_read(conn->ssl, conn->received_response, sizeof(conn->received_response));
+        enter_phase(conn, left);
+        if (read_result <= 0)
+        {
+            // Reading the ticket records ends with nothing else to read.
+            if (SSL_ERROR_WANT_READ == SSL_get_error(conn->ssl, read_result) && !conn->session_renewed)
+            {
+                return 0;
+            }
+            // Otherwise the server closed without a ticket, the next handshake will be a full one.
+            break;
+        }
+    }
+    conn->state = CONN_COMPLETED;
+    return 1;
+}
+
+static int handle_ready_connection(const Arguments *args, const struct epoll_event *event, const int epoll_fd)
+{
+    if (event == NULL || epoll_fd < 0)
+    {
+        return -1;
+    }
+
+    connection *conn = (connection *) event->data.ptr;
+    uint32_t ev = event->events;
+
+    // Remove from epoll (will be re-added next iterationif needed)
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->sockfd, NULL) == -1)
+    {
+        perror("epoll_ctl DEL failed.");
+        return -1;
+    }
+
+    // The read cut short by the pacing is retried, whatever woke the connection up.
+    if (conn->throttled)
+    {
+        conn->throttled = false;
+        ev |= EPOLLIN;
+    }
+
+    // If the event is Error.
+    if (ev & (EPOLLERR | EPOLLHUP))
+    {
+        if (CONN_CONNECTING == conn->state)
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(conn->sockfd, SOL_SOCKET, SO_ERROR, &error, &len);
+            record_connect_error(conn, error);
+        }
+        conn->state = CONN_ERROR;
+        conn->failed++;
+        return -1;
+    }
+
+    switch(conn->state)
+    {
+        case CONN_CONNECTING:
+            // Handle connection establishment.
+            if (ev & EPOLLOUT)
+            {
+                // Because it's non-block socket so before using it, check if it's really ready.
+                VERBOSE(args, "Begin to connect...\n");
+                int error = 0;
                 socklen_t len = sizeof(error);
                 if (getsockopt(conn->sockfd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0)
                 {
                     // No error, means the connection is established successfully.
-                    if (need_connect_proxy(args) && conn->is_https)
+                    conn->tls_started_ns = timing_loop_ns();
+                    record_latency(conn, LATENCY_CONNECT, conn->tls_started_ns - conn->connect_started_ns);
+                    conn->connects++;
+                    if (conn->connect_only)
+                    {
+                        conn->state = CONN_COMPLETED;
+                    }
+                    else if (need_connect_proxy(args) && conn->is_https)
                     {
                         // Create SSL tunnel, if access remote through TLS.
                         conn->state = CONN_PROXY_CONNECT;
                     }
+                    else if (!conn->is_https && HTTP_VERSION_2 == args->http10)
+                    {
+                        // h2c with prior knowledge, the connection preface is sent right away.
+                        start_h2_session(args, conn);
+                    }
                     else
                     {
                         conn->state = conn->is_https ? CONN_TLS_HANDSHAKE : CONN_SENDING;
@@ -545,6 +1669,7 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                 }
                 else
                 {
+                    record_connect_error(conn, error != 0 ? error : errno);
                     conn->state = CONN_ERROR;
                     conn->failed++;
                     return -1;
@@ -554,11 +1679,15 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
         case CONN_PROXY_CONNECT:
             if (ev & EPOLLOUT)
             {
-                printf("Begin to establish SSL tunnel...\n");
+                VERBOSE(args, "Begin to establish SSL tunnel...\n");
+                if (0 == conn->bytes_sent)
+                {
+                    conn->tunnel_started_ns = timing_loop_ns();
+                }
                 int sent = send_proxy_connect(conn, args->proxy_host, args->proxy_port, args->target_host, args->target_port);
                 if (sent > 0)
                 {
-                    printf("CONNECT request is sent to proxy, waiting for its response...\n");
+                    VERBOSE(args, "CONNECT request is sent to proxy, waiting for its response...\n");
                     conn->state = CONN_PROXY_RESPONSE;
                 }
                 else if (0 == sent)
@@ -581,7 +1710,9 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                 int recv = handle_proxy_response(conn);
                 if (1 == recv)
                 {
-                    printf("SSL tunnel is established.\n");
+                    VERBOSE(args, "SSL tunnel is established.\n");
+                    conn->tls_started_ns = timing_loop_ns();
+                    record_latency(conn, LATENCY_TUNNEL, conn->tls_started_ns - conn->tunnel_started_ns);
 
                     // Proxy tunnel is established, now set SSL up.
                     setup_ssl_context(conn);
@@ -603,11 +1734,72 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
         case CONN_TLS_HANDSHAKE:
             if (conn->ssl != NULL && (ev & (EPOLLIN | EPOLLOUT)))
             {
-                printf("Begin to TLS handshake...\n");
+                VERBOSE(args, "Begin to TLS handshake...\n");
+                if (conn->early_data_pending)
+                {
+                    // The early data is the request as CONN_SENDING would send it, rendered once.
+                    size_t written = 0;
+                    if (conn->request->templated && !conn->prerendered)
+                    {
+                        if (render_request(conn) < 0)
+                        {
+                            conn->state = CONN_ERROR;
+                            conn->failed++;
+                            return -1;
+                        }
+                        conn->prerendered = true;
+                    }
+                    reactor_phase left = enter_phase(conn, REACTOR_SSL);
+                    int early_data_result = SSL_write_early_data(conn->ssl, conn->send_data, conn->request_len, &written);
+                    enter_phase(conn, left);
+                    if (1 != early_data_result)
+                    {
+                        int early_data_error = SSL_get_error(conn->ssl, 0);
+                        if (early_data_error == SSL_ERROR_WANT_READ || early_data_error == SSL_ERROR_WANT_WRITE)
+                        {
+                            conn->tls_events = (early_data_error == SSL_ERROR_WANT_READ) ? EPOLLIN : EPOLLOUT;
+                            return 0;
+                        }
+                        fprintf(stderr, "Occurred error when sending early data.\n");
+                        conn->state = CONN_ERROR;
+                        conn->failed++;
+                        return -1;
+                    }
+                    conn->early_data_pending = false;
+                    conn->early_data_sent++;
+                    conn->prerendered = false;
+                }
+                reactor_phase left = enter_phase(conn, REACTOR_SSL);
                 int handshake_result = SSL_connect(conn->ssl);
+                enter_phase(conn, left);
                 if (1 == handshake_result)
                 {
+                    record_latency(conn, LATENCY_TLS, timing_loop_ns() - conn->tls_started_ns);
+                    record_handshake(conn);
+                    if (conn->handshake_only)
+                    {
+                        // A TLS 1.3 session arrives after the handshake, the next one can't resume without it.
+                        if (conn->tls_resume && !conn->session_renewed && TLS1_3_VERSION == SSL_version(conn->ssl))
+                        {
+                            conn->state = CONN_TLS_TICKET;
+                            return read_session_ticket(conn);
+                        }
+                        conn->state = CONN_COMPLETED;
+                        return 1;
+                    }
                     // TLS handshake runs successfully.
+                    if (HTTP_VERSION_2 == args->http10)
+                    {
+                        if (!is_h2_negotiated(conn->ssl))
+                        {
+                            fprintf(stderr, "Server did not negotiate h2 by ALPN.\n");
+                            conn->state = CONN_ERROR;
+                            conn->failed++;
+                            return -1;
+                        }
+                        start_h2_session(args, conn);
+                        return 1;
+                    }
                     conn->state = CONN_SENDING;
                     return 1;
                 }
@@ -616,7 +1808,8 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                     int handshake_error = SSL_get_error(conn->ssl, handshake_result);
                     if (handshake_error == SSL_ERROR_WANT_READ || handshake_error == SSL_ERROR_WANT_WRITE)
                     {
-                        // Not actual error, continue to handshake in the next poll.
+                        // Not actual error, continue to handshake in the next poll, waiting only for what OpenSSL needs.
+                        conn->tls_events = (handshake_error == SSL_ERROR_WANT_READ) ? EPOLLIN : EPOLLOUT;
                         return 0;
                     }
                     else
@@ -630,34 +1823,70 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                 }
             }
             break;
+        case CONN_TLS_TICKET:
+            if (ev & EPOLLIN)
+            {
+                return read_session_ticket(conn);
+            }
+            break;
         case CONN_SENDING:
             if (ev & EPOLLOUT)
             {
-                printf("Begin to send bench request...\n");
+                if (0 == conn->bytes_sent && conn->replay != NULL && !conn->replay_taken)
+                {
+                    // The request of the log is taken when it's due, before the socket is waited for.
+                    return 0;
+                }
+                VERBOSE(args, "Begin to send bench request...\n");
+                if (0 == conn->bytes_sent)
+                {
+                    conn->replay_taken = false;
+                    conn->request_started_ns = timing_loop_ns();
+                    conn->first_byte_ns = 0;
+                    if (conn->request->templated && !conn->prerendered && render_request(conn) < 0)
+                    {
+                        conn->state = CONN_ERROR;
+                        conn->failed++;
+                        return -1;
+                    }
+                    // A request rendered to choose the target is only sent once.
+                    conn->prerendered = false;
+                }
                 int remaining = conn->request_len - conn->bytes_sent;
                 if (remaining <= 0)
                 {
                     // The whole request has benn sent.
-                    printf("%ld bytes of bench request has been sent.\n[%s]\n", conn->request_len, conn->request->body);
-                    conn->state = conn->force_flag ? CONN_COMPLETED : CONN_RECEIVING;
+                    VERBOSE(args, "%ld bytes of bench request has been sent.\n[%s]\n", conn->request_len, conn->send_data);
+                    finish_sending(conn);
                 }   
                 else
                 {
                     int bytes_written;
+
+                    // Slow clients trickle the request as their bucket allows.
+                    remaining = pace_write(conn, remaining);
+                    if (0 == remaining)
+                    {
+                        return 0;
+                    }
                     if (conn->is_https)
                     {
                         // HTTPS connection.
                         if (conn->ssl)
                         {
-                            bytes_written = SSL_write(conn->ssl, conn->request->body + conn->bytes_sent, remaining);
+                            reactor_phase left = enter_phase(conn, REACTOR_SSL);
+                            bytes_written = SSL_write(conn->ssl, conn->send_data + conn->bytes_sent, remaining);
+                            enter_phase(conn, left);
                             if (bytes_written > 0)
                             {
+                                conn->retry_write_len = 0;
+                                token_bucket_consume(&conn->write_bucket, bytes_written);
                                 conn->bytes_sent += bytes_written;
                                 if (conn->bytes_sent >= conn->request_len)
                                 {
                                     // The whole request has been sent.
-                                    printf("%ld bytes of bench request has benn sent.\n[%s]\n", conn->bytes_sent, conn->request->body);
-                                    conn->state = conn->force_flag ? CONN_COMPLETED : CONN_RECEIVING;
+                                    VERBOSE(args, "%ld bytes of bench request has benn sent.\n[%s]\n", conn->bytes_sent, conn->send_data);
+                                    finish_sending(conn);
                                 }
                             }
                             else
@@ -667,6 +1896,7 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                                 if (ssl_error == SSL_ERROR_WANT_READ || ssl_error == SSL_ERROR_WANT_WRITE)
                                 {
                                     // Just need to re-try in the next cycle.
+                                    conn->retry_write_len = remaining;
                                     return 0;
                                 }
                                 else
@@ -690,18 +1920,21 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                     else
                     {
                         // HTTP connection.
-                        bytes_written = send(conn->sockfd, conn->request->body + conn->bytes_sent, remaining, 0);
+                        reactor_phase left = enter_phase(conn, REACTOR_IO);
+                        bytes_written = send(conn->sockfd, conn->send_data + conn->bytes_sent, remaining, 0);
+                        enter_phase(conn, left);
                         if (bytes_written > 0)
                         {
+                            token_bucket_consume(&conn->write_bucket, bytes_written);
                             conn->bytes_sent += bytes_written;
                             // Check if the whole request data has been sent.
                             if (conn->bytes_sent >= conn->request_len)
                             {
-                                printf("%ld bytes of bench request has been sent.\n[%s]\n", conn->bytes_sent, conn->request->body);
-                                conn->state = conn->force_flag ? CONN_COMPLETED : CONN_RECEIVING;
+                                VERBOSE(args, "%ld bytes of bench request has been sent.\n[%s]\n", conn->bytes_sent, conn->send_data);
+                                finish_sending(conn);
                             }
                         }
-                        else if (bytes_written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                        else if (bytes_written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS))
                         {
                             // Socket is not ready for writing, try again in the next cycle.
                             return 0;
@@ -719,23 +1952,37 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
             }
             break;
         case CONN_RECEIVING:
+            if ((ev & EPOLLIN) && conn->read_whole_response)
+            {
+                return handle_whole_response(conn);
+            }
             if (ev & EPOLLIN)
             {
                 int remaining_recv = sizeof(conn->received_response) - conn->bytes_received - 1;
                 if (remaining_recv <= 0)
                 {
-                    conn->state = CONN_COMPLETED;
-                    conn->speed++;
-                    conn->bytes += conn->bytes_received;
+                    complete_request(conn);
+                    count_received_response(conn);
                 }
                 else
                 {
                     int bytes_read = 0;
+
+                    // Slow clients read the response as their bucket allows.
+                    remaining_recv = pace_read(conn, remaining_recv);
+                    if (0 == remaining_recv)
+                    {
+                        return 0;
+                    }
                     if (conn->is_https)
                     {
+                        reactor_phase left = enter_phase(conn, REACTOR_SSL);
                         bytes_read = SSL_read(conn->ssl, conn->received_response + conn->bytes_received, remaining_recv);
+                        enter_phase(conn, left);
                         if (bytes_read > 0)
                         {
+                            token_bucket_consume(&conn->read_bucket, bytes_read);
+                            mark_first_byte(conn);
                             conn->bytes_received += bytes_read;
                             conn->received_response[conn->bytes_received] = '\0';
 
@@ -743,10 +1990,9 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                             if (strstr(conn->received_response, "\r\n\r\n"))
                             {
                                 // HTTP headers is fully received, complete the connection.
-                                printf("%ld bytes of response is received.\n[%s]\n", conn->bytes_received, conn->received_response);
-                                conn->state = CONN_COMPLETED;
-                                conn->bytes += conn->bytes_received;
-                                conn->speed++;
+                                VERBOSE(args, "%ld bytes of response is received.\n[%s]\n", conn->bytes_received, conn->received_response);
+                                complete_request(conn);
+                                count_received_response(conn);
                             }
                             else
                             {
@@ -759,7 +2005,8 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                             int ssl_error = SSL_get_error(conn->ssl, bytes_read);
                             if (ssl_error == SSL_ERROR_WANT_READ || ssl_error == SSL_ERROR_WANT_WRITE)
                             {
-                                // Not an actual error, try again in the next cycle.
+                                // Not an actual error, try again in the next cycle when the socket is ready.
+                                conn->throttled = false;
                                 return 0;
                             }
                             else
@@ -775,9 +2022,13 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                     else
                     {
                         // HTTP connection.
+                        reactor_phase left = enter_phase(conn, REACTOR_IO);
                         bytes_read = read(conn->sockfd, conn->received_response + conn->bytes_received, remaining_recv);
+                        enter_phase(conn, left);
                         if (bytes_read > 0)
                         {
+                            token_bucket_consume(&conn->read_bucket, bytes_read);
+                            mark_first_byte(conn);
                             conn->bytes_received += bytes_read;
                             conn->received_response[conn->bytes_received] = '\0';
 
@@ -785,10 +2036,9 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                             if (strstr(conn->received_response, "\r\n\r\n"))
                             {
                                 // HTTP headers is fully received, complete the connection.
-                                printf("%ld bytes of response is received.\n[%s]\n", conn->bytes_received, conn->received_response);
-                                conn->state = CONN_COMPLETED;
-                                conn->bytes += conn->bytes_received;
-                                conn->speed++;
+                                VERBOSE(args, "%ld bytes of response is received.\n[%s]\n", conn->bytes_received, conn->received_response);
+                                complete_request(conn);
+                                count_received_response(conn);
                             }
                             else
                             {
@@ -798,7 +2048,8 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                         }
                         else if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
                         {
-                            // Socket is not ready, try again in the next cycle.
+                            // Socket is not ready, try again in the next cycle when it is.
+                            conn->throttled = false;
                             return 0;
                         }
                         else
@@ -813,6 +2064,8 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
                 }
             }
             break;
+        case CONN_H2_ACTIVE:
+            return handle_h2_connection(conn, ev);
         default:
             break;
 
@@ -821,7 +2074,207 @@ static int handle_ready_connection(const Arguments *args, const struct epoll_eve
     
 }
 
-void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
+/**
+ * Free the pool of --targets, if any.
+ */
+static void free_targets(TargetPool *targets)
+{
+    if (targets != NULL)
+    {
+        target_pool_free(targets);
+        free(targets);
+    }
+}
+
+/**
+ * Print the failed connects by reason, if any.
+ */
+static void print_connect_errors(const connect_errors *errors)
+{
+    bool printed = false;
+    for (int error = 0; error < MAX_CONNECT_ERRNO; error++)
+    {
+        if (errors->counts[error] > 0)
+        {
+            if (!printed)
+            {
+                printf("Connect failures:\n");
+                printed = true;
+            }
+            printf("  %s: [%" PRIu64 "]\n", error > 0 ? strerror(error) : "Other errors", errors->counts[error]);
+        }
+    }
+}
+
+/**
+ * Print where the time of the loop went with --profile, only the warnings if it was the bottleneck otherwise.
+ */
+static void print_reactor_profile(const ReactorProfile *profile, bool profiling)
+{
+    if (profiling)
+    {
+        reactor_profile_print(profile, stdout);
+    }
+    else
+    {
+        reactor_profile_print_warnings(profile, stdout);
+    }
+}
+
+/**
+ * Print the request latency, and the latency of each phase which happened between the seconds from and to.
+ * Tunnel setup is reported apart, so proxy cost can be told from origin cost.
+ */
+static void print_latency_report(const latency_stats *latency, time_t from, time_t to)
+{
+    printf("Latency of [%lds - %lds]:\n", (long)from, (long)to);
+    histogram_print(&latency->histograms[LATENCY_REQUEST], latency_names[LATENCY_REQUEST], stdout);
+    if (latency->client_requests[CLIENT_FAST].total_count > 0 && latency->client_requests[CLIENT_SLOW].total_count > 0)
+    {
+        for (int client = CLIENT_FAST; client < CLIENT_CLASSES; client++)
+        {
+            histogram_print(&latency->client_requests[client], client_class_names[client], stdout);
+        }
+    }
+    for (int kind = LATENCY_REQUEST + 1; kind < LATENCY_KINDS; kind++)
+    {
+        if (latency->histograms[kind].total_count > 0)
+        {
+            histogram_print(&latency->histograms[kind], latency_names[kind], stdout);
+        }
+    }
+}
+
+/**
+ * Report the requests completed by the fast and by the slow clients apart, when only some are slow.
+ */
+static void print_client_classes(const client_class_stats *classes, uint64_t elapsed_ns)
+{
+    if (0 == classes[CLIENT_FAST].clients || 0 == classes[CLIENT_SLOW].clients)
+    {
+        return;
+    }
+
+    for (int client = CLIENT_FAST; client < CLIENT_CLASSES; client++)
+    {
+        printf("%s clients: count=[%d], requests=[%" PRIu64 "], rate=[%.1f/s], throughput=[%.3fMB/s].\n",
+               CLIENT_SLOW == client ? "Slow" : "Fast", classes[client].clients, classes[client].completed,
+               elapsed_ns > 0 ? classes[client].completed * 1e9 / elapsed_ns : 0.0,
+               elapsed_ns > 0 ? classes[client].bytes * 1e3 / elapsed_ns : 0.0);
+    }
+}
+
+/**
+ * Tell if the client is one of the slow ones, which are spread evenly among the others.
+ */
+static bool is_slow_client(const Arguments *args, int index)
+{
+    if (0 == args->slow_read_rate && 0 == args->slow_write_rate)
+    {
+        return false;
+    }
+    double fraction = args->slow_fraction > 0 ? args->slow_fraction : 1;
+    return (int64_t)((index + 1) * fraction) > (int64_t)(index * fraction);
+}
+
+/**
+ * Change how many of the connections are benching, the ones left out are closed until they are needed again.
+ */
+static void resize_active_connections(const Arguments *args, const HTTPRequest *http_request, connection *connections,
+                                      int from, int to)
+{
+    for (int i = to; i < from; i++)
+    {
+        // The request in flight is abandoned, it's neither completed nor failed.
+        cleanup_connection(&connections[i]);
+    }
+    for (int i = from; i < to; i++)
+    {
+        if (CONN_IDLE == connections[i].state)
+        {
+            allocate_socket(args, http_request, &connections[i]);
+        }
+    }
+}
+
+/**
+ * Report the warm-up apart, then start the results over, leaving the connections as they are.
+ */
+static void finish_warmup(connection *connections, int num_connections, latency_stats *latency,
+                          latency_stats *interval_latency, connect_errors *errors, int warmup_time)
+{
+    uint64_t speed = 0;
+    uint64_t failed = 0;
+    for (int i = 0; i < num_connections; i++)
+    {
+        connection *conn = &connections[i];
+        speed += conn->speed;
+        failed += conn->failed;
+        conn->speed = 0;
+        conn->failed = 0;
+        conn->header_bytes = 0;
+        conn->payload_bytes = 0;
+        conn->mismatched = 0;
+        memset(&conn->tcp, 0, sizeof(conn->tcp));
+        conn->tls_handshakes = 0;
+        conn->ktls_send = 0;
+        conn->ktls_recv = 0;
+        conn->resumed_handshakes = 0;
+        conn->early_data_sent = 0;
+        conn->early_data_accepted = 0;
+        conn->connects = 0;
+    }
+    printf("Warm-up is done. speed=[%" PRIu64 "], failed=[%" PRIu64 "].\n", speed, failed);
+    print_latency_report(latency, 0, warmup_time);
+
+    memset(latency, 0, sizeof(latency_stats));
+    memset(errors, 0, sizeof(connect_errors));
+    if (interval_latency != NULL)
+    {
+        memset(interval_latency, 0, sizeof(latency_stats));
+    }
+}
+
+/**
+ * Publish the results so far to the parent process, with the time benched since the warm-up.
+ */
+static void publish_stats(ProcessStats *published, const connection *connections, int num_connections,
+                          const latency_stats *latency, uint64_t bench_ns)
+{
+    process_stats_begin_write(published);
+    published->bench_ns = bench_ns;
+    published->speed = 0;
+    published->failed = 0;
+    published->header_bytes = 0;
+    published->payload_bytes = 0;
+    published->mismatched = 0;
+    for (int i = 0; i < num_connections; i++)
+    {
+        published->speed += connections[i].speed;
+        published->failed += connections[i].failed;
+        published->header_bytes += connections[i].header_bytes;
+        published->payload_bytes += connections[i].payload_bytes;
+        published->mismatched += connections[i].mismatched;
+    }
+    published->latency = latency->histograms[LATENCY_REQUEST];
+    process_stats_end_write(published);
+}
+
+static uint64_t count_completed(const connection *connections, int num_connections)
+{
+    uint64_t completed = 0;
+    for (int i = 0; i < num_connections; i++)
+    {
+        completed += connections[i].speed;
+    }
+    return completed;
+}
+
+/**
+ * Run the bench, publishing the results as it goes if published is given, and report them at the end unless
+ * the parent process of the worker does.
+ */
+static void run_bench_epoll(const Arguments *args, const HTTPRequest *http_request, ProcessStats *published, bool reporting)
 {
     if (NULL == args || NULL == http_request)
     {
@@ -830,9 +2283,8 @@ void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
     }
 
     int num_connections = args->clients;
-    time_t start_time;
     int epfd;
-    struct epoll_event events[num_connections];
+    struct epoll_event events[num_connections + 1];
 
     if (num_connections > MAX_CONNECTIONS)
     {
@@ -840,7 +2292,15 @@ void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
         printf("Warning: Limited to %d connections to the remote server.\n", num_connections);
     }
 
-    // Allocate memory for connections.
+    // The event loop is a single thread, it runs on the first of the worker CPUs.
+    int cpus[MAX_CPU_LIST];
+    int cpus_count = resolve_worker_cpus(args, cpus, MAX_CPU_LIST);
+    if (cpus_count < 0 || (cpus_count > 0 && pin_current_thread(cpus[0]) < 0))
+    {
+        return;
+    }
+
+    // Allocate memory for connections, after pinning so it's on the local node.
     connection *connections = (connection *) calloc(num_connections, sizeof(connection));
     if (NULL == connections)
     {
@@ -848,12 +2308,84 @@ void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
         return;
     }
 
+    // Latency of all connections is recorded together, for the whole run and for the current interval or probe.
+    bool searching = args->slo_p99_ms > 0;
+    latency_stats *latency = (latency_stats *) calloc(1, sizeof(latency_stats));
+    latency_stats *interval_latency = (args->report_interval > 0 || searching) ? (latency_stats *) calloc(1, sizeof(latency_stats)) : NULL;
+    if (NULL == latency || ((args->report_interval > 0 || searching) && NULL == interval_latency))
+    {
+        perror("Memory allocation for latency stats is failed.");
+        free(latency);
+        free(connections);
+        return;
+    }
+
     printf("Starting to bench with %d connection/connections...\n", num_connections);
 
+    connect_errors errors;
+    memset(&errors, 0, sizeof(errors));
+
+    // Sequence number of templated requests, counted across all connections.
+    uint64_t request_sequence = 0;
+
+    // Requests of the replayed log are taken by whichever connection is ready when they are due.
+    ReplaySchedule replay;
+    bool replaying = strlen(args->replay_file) > 0;
+    if (replaying && replay_schedule_init(&replay, args->replay_file, args->replay_speed, timing_read_ns()) < 0)
+    {
+        free(latency);
+        free(interval_latency);
+        free(connections);
+        return;
+    }
+
+    // Names are resolved off the loop, the results are shared by all connections.
+    Resolver *resolver = (Resolver *) calloc(1, sizeof(Resolver));
+    if (NULL == resolver || resolver_init(resolver, args->dns_ttl) < 0)
+    {
+        fprintf(stderr, "Failed to start the resolver.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The connections are spread across the members of the pool instead of the target of the URL.
+    TargetPool *targets = NULL;
+    if (strlen(args->targets) > 0)
+    {
+        targets = (TargetPool *) calloc(1, sizeof(TargetPool));
+        if (NULL == targets || target_pool_init(targets, args->targets, args->target_port, args->balance) < 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // How busy the loop is, to tell if the bench is limited by the loop rather than by the server.
+    // The split by phase and the lag of each event read the clock around every phase, so only with --profile.
+    ReactorProfile profile;
+    bool profiling = args->reactor_profile;
+
     // Initialize all connections.
     for (int i = 0; i < num_connections; i++)
     {
-        init_connection(args, http_request, &connections[i]);
+        // Connecting is timed from the clock read by the loop, which isn't running yet.
+        timing_tick();
+        connections[i].profile = profiling ? &profile : NULL;
+        if (init_connection(args, http_request, &connections[i]) < 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+        connections[i].latency = latency;
+        connections[i].interval_latency = interval_latency;
+        connections[i].connect_errors = &errors;
+        connections[i].resolver = resolver;
+        connections[i].targets = targets;
+        connections[i].replay = replaying ? &replay : NULL;
+        template_context_init(&connections[i].template_context, &request_sequence, i);
+        if (is_slow_client(args, i))
+        {
+            connections[i].slow = true;
+            token_bucket_init(&connections[i].read_bucket, args->slow_read_rate, timing_read_ns());
+            token_bucket_init(&connections[i].write_bucket, args->slow_write_rate, timing_read_ns());
+        }
         allocate_socket(args, http_request, &connections[i]);
     }
 
@@ -861,6 +2393,21 @@ void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
     if (args->protocol == PROTOCOL_HTTPS)
     {
          init_ssl_lib();
+
+         // HTTP/2 over TLS is negotiated by ALPN during the handshake.
+         if (HTTP_VERSION_2 == args->http10 && enable_h2_alpn() < 0)
+         {
+             fprintf(stderr, "Failed to enable ALPN for HTTP/2.\n");
+             exit(EXIT_FAILURE);
+         }
+         if (configure_tls(args) < 0)
+         {
+             exit(EXIT_FAILURE);
+         }
+         if (args->ktls && enable_ktls() < 0)
+         {
+             fprintf(stderr, "This OpenSSL has no kTLS support, records are encrypted in userspace.\n");
+         }
     }
 
     // Create epoll instance.
@@ -871,56 +2418,454 @@ void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
         exit(EXIT_FAILURE);
     }
 
+    // The resolver wakes the loop up when a name is resolved, its event has no connection.
+    struct epoll_event resolver_event = {0};
+    resolver_event.events = EPOLLIN;
+    resolver_event.data.ptr = NULL;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, resolver->event_fd, &resolver_event) == -1)
+    {
+        perror("Resolver: epoll_ctl ADD");
+        exit(EXIT_FAILURE);
+    }
+
     // Execute bench within the specified time range.
-    start_time = time(NULL);
-    while (time(NULL) - start_time <= args->bench_time)
+    uint64_t start_ns = timing_tick();
+    uint64_t interval_start_ns = start_ns;
+    reactor_profile_init(&profile, start_ns);
+
+    // What the loop costs the OS, counted from the start of the bench like the requests.
+    PerfCounters counters = {-1, -1};
+    if (args->perf_counters && perf_counters_open(&counters) < 0)
+    {
+        fprintf(stderr, "perf_event_open() is not available, the cycles and instructions are not counted.\n");
+    }
+    ResourceUsage usage_start;
+    resource_usage_read(&usage_start, &counters);
+    if (replaying)
+    {
+        // Connecting took some time already, the log is scheduled from now on.
+        replay.start_ns = start_ns;
+    }
+
+    // The search runs probes until it converges, instead of running for the bench time.
+    ThroughputSearch search;
+    int active_connections = num_connections;
+    uint64_t probe_start_ns = start_ns;
+    uint64_t probe_start_completed = 0;
+    if (searching)
+    {
+        search_init(&search, num_connections, (uint64_t)(args->slo_p99_ms * 1e6));
+    }
+
+    // The requests completed in each second are kept for comparing runs.
+    BenchResults *results = NULL;
+    if (reporting && strlen(args->json_file) > 0)
+    {
+        results = (BenchResults *) malloc(sizeof(BenchResults));
+        if (NULL == results)
+        {
+            perror("Memory allocation for the results is failed.");
+            exit(EXIT_FAILURE);
+        }
+        results_init(results, args, start_ns);
+    }
+
+    // Results are published to the parent process this often.
+    const uint64_t publish_period_ns = 100000000ull;
+    uint64_t published_ns = start_ns;
+
+    // The bench, the search or the interval reports start over when the warm-up is done.
+    bool warming_up = args->warmup_time > 0;
+    if (warming_up)
+    {
+        printf("Warming up for %d seconds...\n", args->warmup_time);
+    }
+
+    // The clock is read once per wakeup, every event handled in the wakeup is timed by it.
+    const uint64_t bench_ns = (uint64_t)args->bench_time * 1000000000ull;
+    const uint64_t report_interval_ns = (uint64_t)args->report_interval * 1000000000ull;
+    uint64_t now_ns;
+    for (;;)
     {
-        int active_fds = setup_connection_to_epoll_instance(connections, num_connections, args, http_request, epfd);
+        now_ns = timing_tick();
+        uint64_t turn_started_ns = now_ns;
+        reactor_profile_switch(&profile, REACTOR_OTHER, now_ns);
+        if (!warming_up && !searching && now_ns - start_ns >= bench_ns)
+        {
+            break;
+        }
+
+        if (warming_up && now_ns - start_ns >= (uint64_t)args->warmup_time * 1000000000ull)
+        {
+            finish_warmup(connections, num_connections, latency, interval_latency, &errors, args->warmup_time);
+            if (targets != NULL)
+            {
+                target_pool_reset_stats(targets);
+            }
+            warming_up = false;
+            start_ns = timing_tick();
+            now_ns = start_ns;
+            interval_start_ns = start_ns;
+            probe_start_ns = start_ns;
+            reactor_profile_init(&profile, start_ns);
+            resource_usage_read(&usage_start, &counters);
+            if (results != NULL)
+            {
+                results_init(results, args, start_ns);
+            }
+        }
+
+        if (!warming_up && args->report_interval > 0 && now_ns - interval_start_ns >= report_interval_ns)
+        {
+            print_latency_report(interval_latency, (interval_start_ns - start_ns) / 1000000000ull,
+                                 (now_ns - start_ns) / 1000000000ull);
+            memset(interval_latency, 0, sizeof(latency_stats));
+            interval_start_ns = now_ns;
+        }
+
+        if (published != NULL && now_ns - published_ns >= publish_period_ns)
+        {
+            publish_stats(published, connections, num_connections, latency, warming_up ? 0 : now_ns - start_ns);
+            published_ns = now_ns;
+        }
+
+        if (!warming_up && results != NULL && now_ns - results->sampled_ns >= RESULT_SAMPLE_NS)
+        {
+            results_sample(results, count_completed(connections, num_connections), now_ns);
+        }
+
+        if (!warming_up && searching && now_ns - probe_start_ns >= (uint64_t)args->probe_time * 1000000000ull)
+        {
+            uint64_t completed = count_completed(connections, num_connections);
+            uint64_t p99_ns = histogram_percentile(&interval_latency->histograms[LATENCY_REQUEST], 99);
+            double seconds = (now_ns - probe_start_ns) / 1e9;
+            printf("Probe with [%d] connections: throughput=[%.1f/s], p99=[%.3fms].\n",
+                   active_connections, (completed - probe_start_completed) / seconds, p99_ns / 1e6);
+
+            int next_connections = search_record(&search, completed - probe_start_completed, seconds, p99_ns);
+            if (0 == next_connections)
+            {
+                break;
+            }
+            resize_active_connections(args, http_request, connections, active_connections, next_connections);
+            active_connections = next_connections;
+            memset(interval_latency, 0, sizeof(latency_stats));
+            probe_start_ns = now_ns;
+            probe_start_completed = count_completed(connections, num_connections);
+        }
+
+        int paced_count;
+        int active_fds = setup_connection_to_epoll_instance(connections, active_connections, args, http_request, epfd,
+                                                            &paced_count);
        
         if (active_fds < 0)
         {
             exit(EXIT_FAILURE);
         }
-        else if (active_fds == 0)
+        else if (active_fds == 0 && !resolver_busy(resolver))
         {
-            continue;
+            // All connections are idle once the replayed log has ended, until then they wait for its next request.
+            if (replaying && replay.finished)
+            {
+                break;
+            }
+            if (!replaying && 0 == paced_count)
+            {
+                continue;
+            }
         }
 
-        // Wait for events.
-        int nfds = epoll_wait(epfd, events, active_fds, 100);
+        // Wait for events, for the resolver, for the next request of the replayed log, and for a pacing tick.
+        int timeout_ms = replaying ? replay_wait_ms(&replay, now_ns, 100) : 100;
+        if (paced_count > 0 && timeout_ms > PACING_TICK_MS)
+        {
+            timeout_ms = PACING_TICK_MS;
+        }
+        // The time outside of epoll_wait is the busy time, one more clock read per turn.
+        uint64_t wait_started_ns = timing_read_ns();
+        reactor_profile_switch(&profile, REACTOR_WAIT, wait_started_ns);
+        int nfds = epoll_wait(epfd, events, active_fds + 1, timeout_ms);
         if (nfds == -1)
         {
             perror("epoll_wait");
             break;
         }
+        now_ns = timing_tick();
+        reactor_profile_switch(&profile, REACTOR_OTHER, now_ns);
 
         for (int i = 0; i < nfds; i++)
         {
+            if (profiling)
+            {
+                // An event ready while the loop was busy waits from the end of the previous turn, through setting
+                // up this one and handling the events before it, but not for the time the loop was blocked.
+                uint64_t handled_ns = timing_read_ns();
+                uint64_t waited_ns = now_ns - wait_started_ns;
+                reactor_profile_record_lag(&profile, handled_ns - turn_started_ns - waited_ns, handled_ns);
+            }
+            if (NULL == events[i].data.ptr)
+            {
+                resolver_drain(resolver);
+                continue;
+            }
             handle_ready_connection(args, &events[i], epfd);
         }
-        usleep(10000);
     }
+    reactor_profile_switch(&profile, REACTOR_OTHER, timing_read_ns());
+    ResourceUsage usage;
+    resource_usage_read(&usage, &counters);
+    resource_usage_since(&usage, &usage_start);
+    perf_counters_close(&counters);
 
     // Release all connections, ssl and ssl context, free the memory allocated for connections array, summary the results.
-    int total_failed = 0;
-    int total_speed = 0;
-    int total_bytes = 0;
+    uint64_t elapsed_ns = timing_read_ns() - start_ns;
+    if (published != NULL)
+    {
+        publish_stats(published, connections, num_connections, latency, elapsed_ns);
+        process_stats_begin_write(published);
+        published->usage = usage;
+        process_stats_end_write(published);
+    }
+
+    uint64_t total_failed = 0;
+    uint64_t total_speed = 0;
+    uint64_t total_header_bytes = 0;
+    uint64_t total_payload_bytes = 0;
+    uint64_t total_mismatched = 0;
+    uint64_t total_tls_handshakes = 0;
+    uint64_t total_ktls_send = 0;
+    uint64_t total_ktls_recv = 0;
+    uint64_t total_resumed = 0;
+    uint64_t total_connects = 0;
+    uint64_t total_early_data_sent = 0;
+    uint64_t total_early_data_accepted = 0;
+    TcpStats total_tcp;
+    memset(&total_tcp, 0, sizeof(total_tcp));
+    client_class_stats classes[CLIENT_CLASSES];
+    memset(classes, 0, sizeof(classes));
     if (connections != NULL)
     {
         for (int i = 0; i < num_connections; i++)
         {
+            cleanup_connection(&connections[i]);
+            client_class_stats *class_stats = &classes[connections[i].slow ? CLIENT_SLOW : CLIENT_FAST];
+            class_stats->clients++;
+            class_stats->completed += connections[i].speed;
+            class_stats->bytes += connections[i].header_bytes + connections[i].payload_bytes;
             total_failed += connections[i].failed;
+            total_mismatched += connections[i].mismatched;
             total_speed += connections[i].speed;
-            total_bytes += connections[i].bytes;
-            cleanup_connection(&connections[i]);
+            total_header_bytes += connections[i].header_bytes;
+            total_payload_bytes += connections[i].payload_bytes;
+            tcp_stats_merge(&total_tcp, &connections[i].tcp);
+            total_tls_handshakes += connections[i].tls_handshakes;
+            total_ktls_send += connections[i].ktls_send;
+            total_ktls_recv += connections[i].ktls_recv;
+            total_resumed += connections[i].resumed_handshakes;
+            total_connects += connections[i].connects;
+            total_early_data_sent += connections[i].early_data_sent;
+            total_early_data_accepted += connections[i].early_data_accepted;
+            if (connections[i].session != NULL)
+            {
+                SSL_SESSION_free(connections[i].session);
+            }
+            free(connections[i].h2);
+            free(connections[i].send_buffer);
         }
         free(connections);
     }
+    // The handshake bench runs the loop once per configuration, each with an epoll instance of its own.
+    close(epfd);
+    resolver_free(resolver);
+    free(resolver);
     if(args->protocol == PROTOCOL_HTTPS)
     {
         free_ssl_lib();
     }
 
-    printf("Bench epoll is done. speed=[%d], bytes=[%d], failed[%d].\n", total_speed, total_bytes, total_failed);
+    if (!reporting)
+    {
+        // The parent process reports the results of all workers, a worker only warns when it was the bottleneck.
+        if (reactor_profile_saturated(&profile))
+        {
+            printf("Worker [%d]:\n", (int)getpid());
+            print_reactor_profile(&profile, profiling);
+        }
+        free(latency);
+        free(interval_latency);
+        free_targets(targets);
+        return;
+    }
+
+    if (args->handshake_only)
+    {
+        printf("Handshakes: count=[%" PRIu64 "], rate=[%.1f/s], full=[%" PRIu64 "], resumed=[%" PRIu64 "], failed=[%" PRIu64 "].\n",
+               total_tls_handshakes, elapsed_ns > 0 ? total_tls_handshakes * 1e9 / elapsed_ns : 0.0,
+               total_tls_handshakes - total_resumed, total_resumed, total_failed);
+        if (args->tls_early_data)
+        {
+            printf("Early data: sent=[%" PRIu64 "], accepted=[%" PRIu64 "].\n", total_early_data_sent, total_early_data_accepted);
+        }
+        histogram_print(&latency->histograms[LATENCY_TLS], latency_names[LATENCY_TLS], stdout);
+        histogram_print(&latency->histograms[LATENCY_CONNECT], latency_names[LATENCY_CONNECT], stdout);
+        print_connect_errors(&errors);
+        free(latency);
+        free(interval_latency);
+        free_targets(targets);
+        return;
+    }
+
+    if (args->connect_only)
+    {
+        printf("Connects: count=[%" PRIu64 "], rate=[%.1f/s], failed=[%" PRIu64 "].\n",
+               total_connects, elapsed_ns > 0 ? total_connects * 1e9 / elapsed_ns : 0.0, total_failed);
+        histogram_print(&latency->histograms[LATENCY_CONNECT], latency_names[LATENCY_CONNECT], stdout);
+        print_connect_errors(&errors);
+        tcp_stats_print(&total_tcp, stdout);
+        free(latency);
+        free(interval_latency);
+        free_targets(targets);
+        return;
+    }
+
+    if (args->tls_resume)
+    {
+        printf("TLS handshakes: full=[%" PRIu64 "], resumed=[%" PRIu64 "].\n", total_tls_handshakes - total_resumed, total_resumed);
+    }
+
+    uint64_t total_bytes = total_header_bytes + total_payload_bytes;
+    printf("Bench epoll is done. speed=[%" PRIu64 "], bytes=[%" PRIu64 "], failed[%" PRIu64 "].\n",
+           total_speed, total_bytes, total_failed);
+    printf("Received: headers=[%" PRIu64 "], payload=[%" PRIu64 "], throughput=[%.3fMB/s].\n",
+           total_header_bytes, total_payload_bytes, elapsed_ns > 0 ? total_bytes * 1e3 / elapsed_ns : 0.0);
+
+    // What TCP carried beyond the plaintext is the TLS record framing, handshakes and alerts.
+    if (args->protocol == PROTOCOL_HTTPS && total_tcp.wire_bytes_received > total_bytes)
+    {
+        printf("TLS overhead: [%" PRIu64 "] bytes, [%.2f%%] of the received.\n",
+               total_tcp.wire_bytes_received - total_bytes,
+               100.0 * (total_tcp.wire_bytes_received - total_bytes) / total_tcp.wire_bytes_received);
+    }
+    if (args->ktls)
+    {
+        printf("kTLS: send active after [%" PRIu64 "/%" PRIu64 "] handshakes, receive after [%" PRIu64 "/%" PRIu64 "].\n",
+               total_ktls_send, total_tls_handshakes, total_ktls_recv, total_tls_handshakes);
+        if (total_tls_handshakes > 0 && 0 == total_ktls_send + total_ktls_recv)
+        {
+            printf("WARNING: kTLS was never active, check the tls kernel module is loaded and the cipher is supported.\n");
+        }
+    }
+    print_client_classes(classes, elapsed_ns);
+    tcp_stats_print(&total_tcp, stdout);
+    print_connect_errors(&errors);
+    if (targets != NULL)
+    {
+        target_pool_print(targets, elapsed_ns / 1e9, stdout);
+    }
+    if (args->expect_status || args->expect_body_hash_set)
+    {
+        printf("Mismatched responses: [%" PRIu64 "].\n", total_mismatched);
+    }
+    print_latency_report(latency, 0, elapsed_ns / 1000000000ull);
+    print_reactor_profile(&profile, profiling);
+    resource_usage_print(&usage, "Event loop resources", elapsed_ns / 1e9, total_speed, stdout);
+    if (results != NULL)
+    {
+        results->duration_seconds = elapsed_ns / 1e9;
+        results->requests = total_speed;
+        results->failed = total_failed;
+        results->header_bytes = total_header_bytes;
+        results->payload_bytes = total_payload_bytes;
+        results->mismatched = total_mismatched;
+        results->latency = latency->histograms[LATENCY_REQUEST];
+        if (results_write(results, args->json_file) > 0)
+        {
+            printf("Results are written to [%s].\n", args->json_file);
+        }
+        free(results);
+    }
+    if (searching)
+    {
+        search_print(&search, stdout);
+    }
+    if (replaying)
+    {
+        if (!replay.finished)
+        {
+            printf("The replay was stopped by the time limit at line %llu of the log.\n", (unsigned long long)replay.log.line_number);
+        }
+        replay_log_close(&replay.log);
+    }
+    free(latency);
+    free(interval_latency);
+    free_targets(targets);
+}
+
+/**
+ * Bench the handshakes with each combination of the cipher and group configurations in turn.
+ */
+static void bench_handshakes(const Arguments *args, const HTTPRequest *http_request)
+{
+    int ciphers_count = tls_sweep_count(args->tls_ciphers);
+    int groups_count = tls_sweep_count(args->tls_groups);
+    Arguments *config = (Arguments *) malloc(sizeof(Arguments));
+    if (NULL == config)
+    {
+        perror("Memory allocation for the handshake configuration is failed.");
+        return;
+    }
+
+    for (int c = 0; c < ciphers_count; c++)
+    {
+        for (int g = 0; g < groups_count; g++)
+        {
+            *config = *args;
+            tls_sweep_item(args->tls_ciphers, c, config->tls_ciphers, sizeof(config->tls_ciphers));
+            tls_sweep_item(args->tls_groups, g, config->tls_groups, sizeof(config->tls_groups));
+            printf("Handshake configuration: version=[%s], ciphers=[%s], groups=[%s], resume=[%s], early data=[%s].\n",
+                   tls_version_name(config->tls_version),
+                   strlen(config->tls_ciphers) > 0 ? config->tls_ciphers : "default",
+                   strlen(config->tls_groups) > 0 ? config->tls_groups : "default",
+                   config->tls_resume ? "yes" : "no",
+                   config->tls_early_data ? "yes" : "no");
+            run_bench_epoll(config, http_request, NULL, true);
+        }
+    }
+    free(config);
+}
+
+void bench_epoll(const Arguments *args, const HTTPRequest *http_request)
+{
+    if (args->handshake_only)
+    {
+        bench_handshakes(args, http_request);
+        return;
+    }
+    if (0 == strlen(args->metrics_address))
+    {
+        run_bench_epoll(args, http_request, NULL, true);
+        return;
+    }
+
+    // The results are published for the metrics endpoint like a worker does for its parent.
+    ProcessStats *published = (ProcessStats *) calloc(1, sizeof(ProcessStats));
+    MetricsServer metrics;
+    if (NULL == published)
+    {
+        perror("Memory allocation for the published results is failed.");
+        return;
+    }
+    if (metrics_server_start(&metrics, args->metrics_address, published, 1) < 0)
+    {
+        free(published);
+        exit(EXIT_FAILURE);
+    }
+    run_bench_epoll(args, http_request, published, true);
+    metrics_server_stop(&metrics);
+    free(published);
+}
 
-}
\ No newline at end of file
+void bench_epoll_worker(const Arguments *args, const HTTPRequest *http_request, ProcessStats *published)
+{
+    run_bench_epoll(args, http_request, published, false);
+}
@@ -1,5 +1,8 @@
 #include "bench_poll.h"
-#include "bitmap.h"
+#include "histogram.h"
+#include "response.h"
+#include "timing.h"
+#include "sockopt.h"
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -10,6 +13,7 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <poll.h>
 #include <string.h>
 
@@ -32,6 +36,12 @@ typedef enum
     CONN_ERROR
 } connection_state;
 
+typedef struct
+{
+    Histogram request_latency;  // From sending the request to receiving the response.
+    Histogram tunnel_latency;   // Round trip of the proxy CONNECT request.
+} latency_stats;
+
 typedef struct
 {
     connection_state state;
@@ -45,9 +55,15 @@ typedef struct
     int force_flag;
     size_t bytes_sent;
     size_t bytes_received;
-    int speed;
-    int failed;
-    int bytes;
+    uint64_t speed;
+    uint64_t failed;
+    uint64_t bytes;
+    latency_stats *latency;
+    uint64_t request_started_ns;
+    uint64_t tunnel_started_ns;
+    bool reuse_tunnel;  // Keep the proxy tunnel open for the next request.
+    HTTPResponseParser response;
+    short tls_events;   // Poll events the TLS handshake waits for, 0 - Not known yet.
 } connection;
 
 static SSL_CTX *global_ssl_ctx = NULL;
@@ -119,7 +135,7 @@ static int setup_ssl_context(connection *conn)
     return 1;
 }
 
-static int create_nonblocking_socket(const char *host, const int port)
+static int create_nonblocking_socket(const Arguments *args, const char *host, const int port)
 {
     if (NULL == host || (port <= 0 || port > 65535))
     {
@@ -157,6 +173,14 @@ static int create_nonblocking_socket(const char *host, const int port)
             continue;
         }
 
+        // The options are the same for every address, so a failure ends the trying.
+        if (apply_socket_options(sockfd, args) < 0)
+        {
+            close(sockfd);
+            rp = NULL;
+            break;
+        }
+
         // Set non-blocking flag on the socket.
         int flag = fcntl(sockfd, F_GETFL, 0);
         fcntl(sockfd, F_SETFL, flag | O_NONBLOCK);
@@ -230,7 +254,7 @@ static int send_proxy_connect(connection *conn, const char *proxy_host, const in
     ssize_t bytes_sent = send(conn->sockfd, connect_request + conn->bytes_sent, remaining, 0);
     if (bytes_sent <= 0)
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS)
         {
             // Means that it is not an actually error, just need time to try again, due to it is non-block socket.
             return 0;
@@ -341,6 +365,8 @@ static int init_connection(const Arguments *args, const HTTPRequest *http_reques
     conn->request_len = strlen(conn->request->body);
     conn->bytes_sent = 0;
     conn->bytes_received = 0; 
+    conn->reuse_tunnel = args->reuse_tunnel && need_connect_proxy(args) && conn->is_https;
+    response_parser_init(&conn->response, METHOD_HEAD == args->method, false);
     return 1;
 }
 
@@ -354,11 +380,11 @@ static int allocate_socket(const Arguments *args, const HTTPRequest *http_reques
 
     if (need_connect_proxy(args))
     {
-        conn->sockfd = create_nonblocking_socket(args->proxy_host, args->proxy_port);
+        conn->sockfd = create_nonblocking_socket(args, args->proxy_host, args->proxy_port);
     }
     else
     {
-        conn->sockfd = create_nonblocking_socket(args->target_host, args->target_port);
+        conn->sockfd = create_nonblocking_socket(args, args->target_host, args->target_port);
     }
 
     if (conn->sockfd <= 0)
@@ -389,88 +415,171 @@ static void cleanup_connection(connection *conn)
         conn->bytes_sent = 0;
         conn->bytes_received = 0;
         memset(conn->received_response, 0, sizeof(conn->received_response));
+        response_parser_reset(&conn->response);
+        conn->tls_events = 0;
     }
 }
 
-static int setup_connection_fdsets(connection *conn, const int num_connections, const Arguments *args, const HTTPRequest *http_request, struct pollfd *poll_fd, char *conn_setup_bitmap, int bitmap_size)
+/**
+ * Set the pollfd of the connection slot for its current state, a negative fd is ignored by poll().
+ * Only called when the state may have changed, the array is kept across the iterations.
+ */
+static void update_pollfd(const connection *conn, struct pollfd *pfd)
 {
-    if (NULL == conn || conn->sockfd < 0)
+    pfd->revents = 0;
+    switch (conn->state)
     {
-        return -1;
+        case CONN_CONNECTING:
+        case CONN_SENDING:
+        case CONN_PROXY_CONNECT:
+            pfd->fd = conn->sockfd;
+            pfd->events = POLLOUT;
+            break;
+        case CONN_RECEIVING:
+        case CONN_PROXY_RESPONSE:
+            pfd->fd = conn->sockfd;
+            pfd->events = POLLIN;
+            break;
+        case CONN_TLS_HANDSHAKE:
+            // Both directions until OpenSSL tells which one the handshake waits for.
+            pfd->fd = conn->sockfd;
+            pfd->events = conn->tls_events != 0 ? conn->tls_events : (POLLIN | POLLOUT);
+            break;
+        default:
+            pfd->fd = -1;
+            pfd->events = 0;
+            break;
     }
+}
 
-    if (NULL == args || NULL == http_request)
+/**
+ * Read from the connection, through TLS if it's HTTPS.
+ *
+ * RETURNS:
+ *      Positive number: The bytes read.
+ *                 Zero: No data is ready, try again in the next cycle.
+ *      Negative number: Real error occurred or the peer closed the connection.
+ */
+static int read_connection(connection *conn, void *buffer, int len)
+{
+    if (conn->is_https)
     {
-        return -1;
+        int bytes_read = SSL_read(conn->ssl, buffer, len);
+        if (bytes_read > 0)
+        {
+            return bytes_read;
+        }
+        int ssl_error = SSL_get_error(conn->ssl, bytes_read);
+        return (ssl_error == SSL_ERROR_WANT_READ || ssl_error == SSL_ERROR_WANT_WRITE) ? 0 : -1;
     }
 
-    if (NULL == poll_fd)
+    ssize_t bytes_read = read(conn->sockfd, buffer, len);
+    if (bytes_read > 0)
     {
-        return -1;
+        return (int) bytes_read;
     }
+    return (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? 0 : -1;
+}
 
-    if (NULL == conn_setup_bitmap || bitmap_size <= 0)
-    {
-        return -1;
-    }
+/**
+ * The whole response has been received, count it and record its latency.
+ */
+static void complete_request(connection *conn)
+{
+    histogram_record(&conn->latency->request_latency, get_monotonic_ns() - conn->request_started_ns);
+    conn->state = CONN_COMPLETED;
+    conn->speed++;
+}
 
-    connection *curr_conn = conn;
-    struct pollfd *curr_poll_fd = poll_fd;
-    int poll_fds_num = 0;
-    for (int i = 0; i < num_connections; i++)
+/**
+ * Receive the whole response, so the connection stays in sync for the next request.
+ *
+ * RETURNS:
+ *      Positive number: The response is complete.
+ *                 Zero: Not complete, continue to receive in the next cycle.
+ *      Negative number: Real error occurred.
+ */
+static int receive_whole_response(connection *conn)
+{
+    while (true)
     {
-        switch(curr_conn->state)
+        bool in_headers = (RESPONSE_HEADERS == conn->response.state);
+
+        // Headers are accumulated for parsing, the body is only counted so the buffer is reused.
+        char *buffer = in_headers ? conn->received_response + conn->bytes_received : conn->received_response;
+        int capacity = in_headers ? (int)(sizeof(conn->received_response) - conn->bytes_received - 1)
+                                  : (int)sizeof(conn->received_response) - 1;
+        if (capacity <= 0)
         {
-            case CONN_ERROR:
-            case CONN_COMPLETED:
-                cleanup_connection(curr_conn);
-                allocate_socket(args, http_request, curr_conn);
-                break;
-            case CONN_CONNECTING:
-            case CONN_SENDING:
-            case CONN_PROXY_CONNECT:
-                if (set_bitmap(i, conn_setup_bitmap, bitmap_size) < 0)
-                {
-                    return -1;
-                }
-                curr_poll_fd->fd = curr_conn->sockfd;
-                curr_poll_fd->events = POLLOUT;
-                curr_poll_fd->revents = 0;
-                curr_poll_fd ++;
-                poll_fds_num ++;
-                break;
-            case CONN_RECEIVING:
-            case CONN_PROXY_RESPONSE:
-                if (set_bitmap(i, conn_setup_bitmap, bitmap_size) < 0)
-                {
-                    return -1;
-                }
-                curr_poll_fd->fd = curr_conn->sockfd;
-                curr_poll_fd->events = POLLIN;
-                curr_poll_fd->revents = 0;
-                curr_poll_fd ++;
-                poll_fds_num ++;
-                break;
-            case CONN_TLS_HANDSHAKE:
-                // For TLS handshake, we might need to read or write
-                // The specific direction depends on SSL_get_error() 's result.
-                if (set_bitmap(i, conn_setup_bitmap, sizeof(conn_setup_bitmap)) < 0)
-                {
-                    return -1;
-                }
-                curr_poll_fd->fd = curr_conn->sockfd;
-                curr_poll_fd->events = POLLIN | POLLOUT;    // Monitor both directions.
-                curr_poll_fd->revents = 0;
-                curr_poll_fd ++;
-                poll_fds_num ++;
-                break;
-            case CONN_IDLE:
-                break;
+            fprintf(stderr, "Response headers are too large.\n");
+            return -1;
+        }
 
+        int bytes_read = read_connection(conn, buffer, capacity);
+        if (0 == bytes_read)
+        {
+            return 0;
         }
-        curr_conn ++;
+        if (bytes_read < 0)
+        {
+            // Closed by server, which completes a body without length.
+            response_connection_closed(&conn->response);
+            return response_is_complete(&conn->response) ? 1 : -1;
+        }
+        conn->bytes += bytes_read;
+
+        if (in_headers)
+        {
+            conn->bytes_received += bytes_read;
+            conn->received_response[conn->bytes_received] = '\0';
+            int header_len = response_parse_headers(&conn->response, conn->received_response, conn->bytes_received);
+            if (header_len < 0)
+            {
+                return -1;
+            }
+            if (header_len > 0 && response_consume_body(&conn->response, conn->received_response + header_len,
+                                                        conn->bytes_received - header_len) < 0)
+            {
+                return -1;
+            }
+        }
+        else if (response_consume_body(&conn->response, buffer, bytes_read) < 0)
+        {
+            return -1;
+        }
+
+        if (response_is_complete(&conn->response))
+        {
+            return 1;
+        }
+    }
+}
+
+static int handle_reused_tunnel_response(connection *conn)
+{
+    int result = receive_whole_response(conn);
+    if (result < 0)
+    {
+        fprintf(stderr, "Bench response receiving is failed.\n");
+        conn->state = CONN_ERROR;
+        conn->failed++;
+        return -1;
+    }
+    if (0 == result)
+    {
+        return 0;
+    }
+
+    complete_request(conn);
+    if (conn->response.keep_alive)
+    {
+        // Send the next request through the same tunnel and TLS session.
+        conn->state = CONN_SENDING;
+        conn->bytes_sent = 0;
+        conn->bytes_received = 0;
+        response_parser_reset(&conn->response);
     }
-    return poll_fds_num;
+    return 1;
 }
 
 static int handle_ready_connection(connection *conn, const Arguments *args, struct pollfd *pfd)
@@ -537,6 +646,10 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
             if (pfd->revents & POLLOUT)
             {
                 printf("Begin to establish SSL tunnel.\n");
+                if (0 == conn->bytes_sent)
+                {
+                    conn->tunnel_started_ns = get_monotonic_ns();
+                }
                 int sent = send_proxy_connect(conn, args->proxy_host, args->proxy_port, args->target_host, args->target_port);
                 if (sent > 0)
                 {
@@ -563,6 +676,7 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
                 if (1 == recv)
                 {
                     printf("SSL tunnel established.\n");
+                    histogram_record(&conn->latency->tunnel_latency, get_monotonic_ns() - conn->tunnel_started_ns);
 
                     // Proxy tunnel established, now setup SSL
                     setup_ssl_context(conn);
@@ -598,6 +712,7 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
                     if (handshake_error == SSL_ERROR_WANT_READ || handshake_error == SSL_ERROR_WANT_WRITE)
                     {
                         // Not an actually error, continue handshake in the next poll.
+                        conn->tls_events = (handshake_error == SSL_ERROR_WANT_READ) ? POLLIN : POLLOUT;
                         return 0;
                     }
                     else
@@ -614,6 +729,10 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
             if (pfd->revents & POLLOUT)
             {
                 printf("Begin to send bench request...\n");
+                if (0 == conn->bytes_sent)
+                {
+                    conn->request_started_ns = get_monotonic_ns();
+                }
                 int remaining = conn->request_len - conn->bytes_sent;
                 if (remaining <= 0)
                 {
@@ -681,7 +800,7 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
                                 conn->state = conn->force_flag ? CONN_COMPLETED : CONN_RECEIVING;
                             }
                         }
-                        else if (bytes_written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                        else if (bytes_written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS))
                         {
                             // Socket is not ready for writing, try again in the next cycle.
                             return 0;
@@ -699,13 +818,16 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
             }
             break;
         case CONN_RECEIVING:
+            if ((pfd->revents & POLLIN) && conn->reuse_tunnel)
+            {
+                return handle_reused_tunnel_response(conn);
+            }
             if (pfd->revents & POLLIN)
             {
                 int remaining_recv = sizeof(conn->received_response) - conn->bytes_received - 1;
                 if (remaining_recv <= 0)
                 {
-                    conn->state = CONN_COMPLETED;
-                    conn->speed++;
+                    complete_request(conn);
                     conn->bytes += conn->bytes_received;
                 }
                 else
@@ -724,9 +846,8 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
                             {
                                 // Headers is fully received, complete this communication.
                                 printf("%ld bytes of response is received.[%s]\n", conn->bytes_received, conn->received_response);
-                                conn->state = CONN_COMPLETED;
+                                complete_request(conn);
                                 conn->bytes += conn->bytes_received;
-                                conn->speed++;
                             }
                             else
                             {
@@ -766,8 +887,7 @@ static int handle_ready_connection(connection *conn, const Arguments *args, stru
                             {
                                 // Headers is fully received.
                                 printf("%ld bytes of response received.[%s]\n", conn->bytes_received, conn->received_response);
-                                conn->state = CONN_COMPLETED;
-                                conn->speed++;
+                                complete_request(conn);
                                 conn->bytes += conn->bytes_received;
                             }
                             else
@@ -827,12 +947,22 @@ void bench_poll(const Arguments *args, const HTTPRequest *http_request)
         return;
     }
 
+    // Latency of all connections is recorded together.
+    latency_stats *latency = (latency_stats *) calloc(1, sizeof(latency_stats));
+    if (NULL == latency)
+    {
+        perror("Memory allocation for latency stats is failed.");
+        free(connections);
+        return;
+    }
+
     printf("Starting to bench with %d connection/connections...\n", num_connections);
 
     // Initialize all connections.
     for (int i = 0; i < num_connections; i++)
     {
         init_connection(args, http_request, &connections[i]);
+        connections[i].latency = latency;
         allocate_socket(args, http_request, &connections[i]);
     }
 
@@ -846,58 +976,73 @@ void bench_poll(const Arguments *args, const HTTPRequest *http_request)
     // Execute bench within the specified time range.
     start_time = time(NULL);
 
-    // Setup bitmap for tracking which connection is set in the poll fds array.
-    unsigned short bitmap_size = num_connections / (sizeof(char) * 8);
-    if (num_connections % (sizeof(char) * 8) != 0)
+    // The pollfd of each connection is at the index of its slot, and only updated when its state changes.
+    struct pollfd *pollfds = (struct pollfd *) calloc(num_connections, sizeof(struct pollfd));
+    if (NULL == pollfds)
     {
-        bitmap_size += 1;
+        perror("Memory allocation for pollfds is failed.");
+        exit(EXIT_FAILURE);
     }
-
-    char bitmap[bitmap_size];
-    while (time(NULL) - start_time <= args->bench_time)
+    for (int i = 0; i < num_connections; i++)
     {
-        struct pollfd pollfds[num_connections];
+        update_pollfd(&connections[i], &pollfds[i]);
+    }
 
-        // Setup connections to pollfds based on the current state.
-        memset(bitmap, 0, bitmap_size);
-        int poll_fds_num = setup_connection_fdsets(connections, num_connections, args, http_request, pollfds, bitmap, bitmap_size);
-        if (poll_fds_num > 0)
+    bool warming_up = args->warmup_time > 0;
+    while (warming_up || time(NULL) - start_time <= args->bench_time)
+    {
+        // The results start over when the warm-up is done, the connections are kept as they are.
+        if (warming_up && time(NULL) - start_time >= args->warmup_time)
         {
-            int ready = poll(pollfds, poll_fds_num, 100);
-            if (ready < 0)
+            for (int i = 0; i < num_connections; i++)
             {
-                perror("Poll return negetive");
-                break;
+                connections[i].speed = 0;
+                connections[i].failed = 0;
+                connections[i].bytes = 0;
             }
-            if (ready == 0)
+            memset(latency, 0, sizeof(latency_stats));
+            warming_up = false;
+            start_time = time(NULL);
+        }
+
+        int ready = poll(pollfds, num_connections, 100);
+        if (ready < 0)
+        {
+            perror("Poll return negetive");
+            break;
+        }
+        if (ready == 0)
+        {
+            // Poll time out, continue the loop.
+            printf("Poll timeout, go next loop...\n");
+            continue;
+        }
+
+        // Handle the ready fds, the scan stops once all of them have been seen.
+        for (int i = 0; i < num_connections && ready > 0; i++)
+        {
+            if (0 == pollfds[i].revents)
             {
-                // Poll time out, continue the loop.
-                printf("Poll timeout, go next loop...\n");
                 continue;
             }
+            ready--;
+            handle_ready_connection(&connections[i], args, &pollfds[i]);
 
-            // Handle the ready fds.
-            connection *curr_conn = connections;
-            struct pollfd *curr_poll_fd = pollfds;
-            for (int i = 0; i < num_connections; i++)
+            // A finished connection is replaced right away, so it's polled in the next iteration.
+            if (CONN_COMPLETED == connections[i].state || CONN_ERROR == connections[i].state)
             {
-                // Find the corresponding connection for this pollfd.
-                if (get_bitmap(i, bitmap, bitmap_size))
-                {
-                    handle_ready_connection(curr_conn, args, curr_poll_fd);
-            
-                    curr_poll_fd++;
-                }
-                curr_conn++;
+                cleanup_connection(&connections[i]);
+                allocate_socket(args, http_request, &connections[i]);
             }
+            update_pollfd(&connections[i], &pollfds[i]);
         }
-        usleep(10000);
     }
+    free(pollfds);
 
     // Release all connections, ssl and ssl context, free the memory allocated for connections array, summary the results.
-    int total_failed = 0;
-    int total_speed = 0;
-    int total_bytes = 0;
+    uint64_t total_failed = 0;
+    uint64_t total_speed = 0;
+    uint64_t total_bytes = 0;
     if (connections != NULL)
     {
         for (int i = 0; i < num_connections; i++)
@@ -914,7 +1059,15 @@ void bench_poll(const Arguments *args, const HTTPRequest *http_request)
         free_ssl_lib();
     }
 
-    printf("Bench poll is done. speed=[%d], bytes=[%d], failed=[%d].\n", total_speed, total_bytes, total_failed);
+    printf("Bench poll is done. speed=[%" PRIu64 "], bytes=[%" PRIu64 "], failed=[%" PRIu64 "].\n",
+           total_speed, total_bytes, total_failed);
+    histogram_print(&latency->request_latency, "Request latency", stdout);
+    if (need_connect_proxy(args) && args->protocol == PROTOCOL_HTTPS)
+    {
+        // Tunnel setup is reported apart, so proxy cost can be told from origin cost.
+        histogram_print(&latency->tunnel_latency, "Proxy CONNECT latency", stdout);
+    }
+    free(latency);
     
 }
 
@@ -1,4 +1,5 @@
 #include "bench_select.h"
+#include "sockopt.h"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <sys/socket.h>
@@ -7,6 +8,7 @@
 #include <fcntl.h>
 #include <time.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <unistd.h>
 
 #define BUFFER_SIZE 1024
@@ -37,9 +39,9 @@ typedef struct
     int force_flag;
     int bytes_sent;
     int bytes_received;
-    int speed;
-    int failed;
-    int bytes;
+    uint64_t speed;
+    uint64_t failed;
+    uint64_t bytes;
 
 } connection;
 
@@ -86,7 +88,7 @@ static void cleanup_ssl(void)
     printf("SSL library cleaned up.\n");
 }
 
-static int create_nonblocking_socket(const char *host, const int port)
+static int create_nonblocking_socket(const Arguments *args, const char *host, const int port)
 {
     if (NULL == host || (port <= 0 || port > 65535))
     {
@@ -124,6 +126,14 @@ static int create_nonblocking_socket(const char *host, const int port)
             continue; // Try next address.
         }
 
+        // The options are the same for every address, so a failure ends the trying.
+        if (apply_socket_options(sockfd, args) < 0)
+        {
+            close(sockfd);
+            rp = NULL;
+            break;
+        }
+
         // Set non-blocking.
         int flag = fcntl(sockfd, F_GETFL, 0);
         fcntl(sockfd, F_SETFL, flag | O_NONBLOCK);
@@ -188,7 +198,7 @@ static int send_proxy_connect(connection *conn, const char *proxy_host, const in
     ssize_t sent_bytes = send(conn->sockfd, connect_request, strlen(connect_request), 0);
     if (sent_bytes <= 0)
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS)
         {
             // Not an error - just try again later.
             return 0;
@@ -257,11 +267,11 @@ static void allocate_socket(const Arguments *args, const HTTPRequest *http_reque
 
     if (need_connect_proxy(args))
     {
-        conn->sockfd = create_nonblocking_socket(args->proxy_host, args->proxy_port);
+        conn->sockfd = create_nonblocking_socket(args, args->proxy_host, args->proxy_port);
     }
     else
     {
-        conn->sockfd = create_nonblocking_socket(args->target_host, args->target_port);
+        conn->sockfd = create_nonblocking_socket(args, args->target_host, args->target_port);
     }
 
     if (conn->sockfd < 0)
@@ -547,7 +557,7 @@ static int handle_ready_connection(connection *conn, const Arguments *args, cons
                             conn->state = conn->force_flag ? CONN_COMPLETED : CONN_RECEIVING;
                         }
                     }
-                    else if (bytes_written == -1 && ( errno == EAGAIN || errno == EWOULDBLOCK))
+                    else if (bytes_written == -1 && ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS))
                     {
                         // Socket not ready, try again in the next select.
                         return 0;
@@ -719,9 +729,23 @@ void bench_select(const Arguments *args, const HTTPRequest *http_request)
         init_ssl_lib();
     }
 
-    // Execute bench within the specified time range.
-    while (time(NULL) - start_time <= args->bench_time)
+    // Execute bench within the specified time range, after the warm-up.
+    bool warming_up = args->warmup_time > 0;
+    while (warming_up || time(NULL) - start_time <= args->bench_time)
     {
+        // The results start over when the warm-up is done, the connections are kept as they are.
+        if (warming_up && time(NULL) - start_time >= args->warmup_time)
+        {
+            for (int i = 0; i < num_connections; i++)
+            {
+                connections[i].speed = 0;
+                connections[i].failed = 0;
+                connections[i].bytes = 0;
+            }
+            warming_up = false;
+            start_time = time(NULL);
+        }
+
         FD_ZERO(&read_fds);
         FD_ZERO(&write_fds);
 
@@ -760,9 +784,9 @@ void bench_select(const Arguments *args, const HTTPRequest *http_request)
     }
     
     // Release all sockets, ssl and ssl context, free the memory for connections array, summary the results.
-    int total_failed = 0;
-    int total_bytes = 0;
-    int total_speed = 0;
+    uint64_t total_failed = 0;
+    uint64_t total_bytes = 0;
+    uint64_t total_speed = 0;
     if (connections != NULL)
     {
         for (int i = 0; i < num_connections; i++)
@@ -779,6 +803,7 @@ void bench_select(const Arguments *args, const HTTPRequest *http_request)
         cleanup_ssl();
     }
 
-    printf("Bench select is done. speed=[%d], bytes=[%d], failed=[%d].\n", total_speed, total_bytes, total_failed);
+    printf("Bench select is done. speed=[%" PRIu64 "], bytes=[%" PRIu64 "], failed=[%" PRIu64 "].\n",
+           total_speed, total_bytes, total_failed);
     
 }
\ No newline at end of file
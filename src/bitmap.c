@@ -1,5 +1,126 @@
 #include "bitmap.h"
 #include <stdio.h>
+#include <stdlib.h>
+
+int bitmap_init(Bitmap *bitmap, size_t bits)
+{
+    bitmap->bits = bits;
+    bitmap->words_count = (bits + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+    bitmap->words = (uint64_t *) calloc(bitmap->words_count > 0 ? bitmap->words_count : 1, sizeof(uint64_t));
+    return NULL == bitmap->words ? -1 : 1;
+}
+
+void bitmap_free(Bitmap *bitmap)
+{
+    free(bitmap->words);
+    bitmap->words = NULL;
+    bitmap->bits = 0;
+    bitmap->words_count = 0;
+}
+
+void bitmap_set(Bitmap *bitmap, size_t index)
+{
+    bitmap->words[index / BITMAP_WORD_BITS] |= 1ull << (index % BITMAP_WORD_BITS);
+}
+
+void bitmap_clear(Bitmap *bitmap, size_t index)
+{
+    bitmap->words[index / BITMAP_WORD_BITS] &= ~(1ull << (index % BITMAP_WORD_BITS));
+}
+
+bool bitmap_test(const Bitmap *bitmap, size_t index)
+{
+    return (bitmap->words[index / BITMAP_WORD_BITS] >> (index % BITMAP_WORD_BITS)) & 1;
+}
+
+/**
+ * Mask of the bits [from, to) within one word, with 0 <= from < to <= 64.
+ */
+static uint64_t word_mask(size_t from, size_t to)
+{
+    uint64_t high = (to == BITMAP_WORD_BITS) ? ~0ull : (1ull << to) - 1;
+    return high & ~((1ull << from) - 1);
+}
+
+/**
+ * Set or clear the range word by word, whole words are written at once.
+ */
+static void update_range(Bitmap *bitmap, size_t index, size_t count, bool set)
+{
+    if (index >= bitmap->bits)
+    {
+        return;
+    }
+    size_t end = (count > bitmap->bits - index) ? bitmap->bits : index + count;
+
+    while (index < end)
+    {
+        size_t word = index / BITMAP_WORD_BITS;
+        size_t from = index % BITMAP_WORD_BITS;
+        size_t to = (end - word * BITMAP_WORD_BITS >= BITMAP_WORD_BITS) ? BITMAP_WORD_BITS : end - word * BITMAP_WORD_BITS;
+        uint64_t mask = word_mask(from, to);
+        if (set)
+        {
+            bitmap->words[word] |= mask;
+        }
+        else
+        {
+            bitmap->words[word] &= ~mask;
+        }
+        index = (word + 1) * BITMAP_WORD_BITS;
+    }
+}
+
+void bitmap_set_range(Bitmap *bitmap, size_t index, size_t count)
+{
+    update_range(bitmap, index, count, true);
+}
+
+void bitmap_clear_range(Bitmap *bitmap, size_t index, size_t count)
+{
+    update_range(bitmap, index, count, false);
+}
+
+void bitmap_clear_all(Bitmap *bitmap)
+{
+    for (size_t i = 0; i < bitmap->words_count; i++)
+    {
+        bitmap->words[i] = 0;
+    }
+}
+
+size_t bitmap_find_next_set(const Bitmap *bitmap, size_t index)
+{
+    if (index >= bitmap->bits)
+    {
+        return bitmap->bits;
+    }
+
+    // The entries before index in its word are masked out, then whole words are skipped while empty.
+    size_t word = index / BITMAP_WORD_BITS;
+    uint64_t bits = bitmap->words[word] & (~0ull << (index % BITMAP_WORD_BITS));
+    while (0 == bits)
+    {
+        if (++word >= bitmap->words_count)
+        {
+            return bitmap->bits;
+        }
+        bits = bitmap->words[word];
+    }
+
+    size_t found = word * BITMAP_WORD_BITS + (size_t)__builtin_ctzll(bits);
+    return found < bitmap->bits ? found : bitmap->bits;
+}
+
+size_t bitmap_count(const Bitmap *bitmap)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < bitmap->words_count; i++)
+    {
+        count += (size_t)__builtin_popcountll(bitmap->words[i]);
+    }
+    return count;
+}
 
 int set_bitmap(const unsigned short position, char *bitmap, int bitmap_size)
 {
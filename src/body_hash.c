@@ -0,0 +1,88 @@
+#include "body_hash.h"
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ull
+#define PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define PRIME64_3 0x165667B19E3779F9ull
+#define PRIME64_5 0x27D4EB2F165667C5ull
+
+static inline uint64_t rotate_left(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t hash_round(uint64_t state, uint64_t word)
+{
+    state += word * PRIME64_2;
+    state = rotate_left(state, 31);
+    return state * PRIME64_1;
+}
+
+void body_hash_init(BodyHash *hash)
+{
+    memset(hash, 0, sizeof(*hash));
+    hash->state = PRIME64_5;
+}
+
+void body_hash_update(BodyHash *hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + len;
+    uint64_t word;
+
+    hash->length += len;
+
+    // Complete the word left by the previous piece first.
+    if (hash->tail_len > 0)
+    {
+        while (hash->tail_len < 8 && p < end)
+        {
+            hash->tail[hash->tail_len++] = *p++;
+        }
+        if (hash->tail_len < 8)
+        {
+            return;
+        }
+        memcpy(&word, hash->tail, 8);
+        hash->state = hash_round(hash->state, word);
+        hash->tail_len = 0;
+    }
+
+    while (end - p >= 8)
+    {
+        memcpy(&word, p, 8);
+        hash->state = hash_round(hash->state, word);
+        p += 8;
+    }
+
+    while (p < end)
+    {
+        hash->tail[hash->tail_len++] = *p++;
+    }
+}
+
+uint64_t body_hash_final(const BodyHash *hash)
+{
+    uint64_t result = hash->state ^ hash->length;
+    for (int i = 0; i < hash->tail_len; i++)
+    {
+        result ^= hash->tail[i] * PRIME64_5;
+        result = rotate_left(result, 11) * PRIME64_1;
+    }
+
+    // Spread every input bit over the result.
+    result ^= result >> 33;
+    result *= PRIME64_2;
+    result ^= result >> 29;
+    result *= PRIME64_3;
+    result ^= result >> 32;
+    return result;
+}
+
+uint64_t body_hash(const void *data, size_t len)
+{
+    BodyHash hash;
+    body_hash_init(&hash);
+    body_hash_update(&hash, data, len);
+    return body_hash_final(&hash);
+}
@@ -0,0 +1,292 @@
+#include "compare.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double compared_percentiles[] = {50, 90, 99, 99.9};
+
+static const char *verdict_names[] = {
+    "no significant change",
+    "worse within the threshold",
+    "improved",
+    "REGRESSION"
+};
+
+/**
+ * Xorshift64*, the resampling is seeded so the same files always give the same intervals.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * Uniform in (0, 1).
+ */
+static double next_uniform(uint64_t *state)
+{
+    return ((next_random(state) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/**
+ * Standard normal by Box-Muller.
+ */
+static double next_normal(uint64_t *state)
+{
+    double u1 = next_uniform(state);
+    double u2 = next_uniform(state);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Set the 95% interval from the deltas of the resamples, which are sorted.
+ */
+static void set_interval(CompareDelta *delta, double *deltas, int count)
+{
+    qsort(deltas, count, sizeof(double), compare_doubles);
+    delta->ci_low = deltas[(int)(0.025 * count)];
+    delta->ci_high = deltas[(int)ceil(0.975 * count) - 1];
+}
+
+static double relative_change(double baseline, double candidate)
+{
+    return baseline > 0 ? (candidate - baseline) / baseline * 100.0 : 0.0;
+}
+
+/**
+ * The mean of a resample of the samples, drawn with replacement.
+ */
+static double resample_mean(const BenchResults *results, uint64_t *state)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < results->samples_count; i++)
+    {
+        sum += results->samples[next_random(state) % (uint64_t)results->samples_count];
+    }
+    return (double)sum / results->samples_count;
+}
+
+static double samples_mean(const BenchResults *results)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < results->samples_count; i++)
+    {
+        sum += results->samples[i];
+    }
+    return (double)sum / results->samples_count;
+}
+
+int compare_throughput(const BenchResults *baseline, const BenchResults *candidate, uint64_t seed, CompareDelta *delta)
+{
+    if (baseline->samples_count < 2 || candidate->samples_count < 2)
+    {
+        return -1;
+    }
+
+    double *deltas = (double *) malloc(BOOTSTRAP_ITERATIONS * sizeof(double));
+    if (NULL == deltas)
+    {
+        return -1;
+    }
+
+    uint64_t state = seed ? seed : 1;
+    delta->baseline = samples_mean(baseline) / baseline->sample_seconds;
+    delta->candidate = samples_mean(candidate) / candidate->sample_seconds;
+    delta->delta = relative_change(delta->baseline, delta->candidate);
+    for (int i = 0; i < BOOTSTRAP_ITERATIONS; i++)
+    {
+        double a = resample_mean(baseline, &state) / baseline->sample_seconds;
+        double b = resample_mean(candidate, &state) / candidate->sample_seconds;
+        deltas[i] = relative_change(a, b);
+    }
+    set_interval(delta, deltas, BOOTSTRAP_ITERATIONS);
+    free(deltas);
+    return 1;
+}
+
+/**
+ * The percentile of a resample of the recorded values.
+ * Of n values resampled, the count at or below the k-th smallest one is binomial(n, k/n), so the rank
+ * the percentile falls on in a resample is drawn from its normal approximation instead of drawing n values.
+ */
+static double resample_percentile(const Histogram *histogram, double percentile, uint64_t *state)
+{
+    double n = (double)histogram->total_count;
+    double q = percentile / 100.0;
+    double rank = n * q + sqrt(n * q * (1.0 - q)) * next_normal(state);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank > n)
+    {
+        rank = n;
+    }
+    return (double)histogram_percentile(histogram, rank / n * 100.0);
+}
+
+int compare_percentile(const BenchResults *baseline, const BenchResults *candidate, double percentile, uint64_t seed,
+                       CompareDelta *delta)
+{
+    if (0 == baseline->latency.total_count || 0 == candidate->latency.total_count)
+    {
+        return -1;
+    }
+
+    double *deltas = (double *) malloc(BOOTSTRAP_ITERATIONS * sizeof(double));
+    if (NULL == deltas)
+    {
+        return -1;
+    }
+
+    uint64_t state = seed ? seed : 1;
+    delta->baseline = (double)histogram_percentile(&baseline->latency, percentile);
+    delta->candidate = (double)histogram_percentile(&candidate->latency, percentile);
+    delta->delta = relative_change(delta->baseline, delta->candidate);
+    for (int i = 0; i < BOOTSTRAP_ITERATIONS; i++)
+    {
+        double a = resample_percentile(&baseline->latency, percentile, &state);
+        double b = resample_percentile(&candidate->latency, percentile, &state);
+        deltas[i] = relative_change(a, b);
+    }
+    set_interval(delta, deltas, BOOTSTRAP_ITERATIONS);
+    free(deltas);
+    return 1;
+}
+
+compare_verdict compare_judge(const CompareDelta *delta, bool higher_is_better, double threshold)
+{
+    if (delta->ci_low <= 0 && delta->ci_high >= 0)
+    {
+        return VERDICT_NO_CHANGE;
+    }
+    bool better = higher_is_better ? delta->ci_low > 0 : delta->ci_high < 0;
+    if (better)
+    {
+        return VERDICT_IMPROVED;
+    }
+    return fabs(delta->delta) > threshold ? VERDICT_REGRESSION : VERDICT_WITHIN_THRESHOLD;
+}
+
+static void print_run(const char *name, const char *path, const BenchResults *results)
+{
+    printf("%s: [%s] url=[%s], clients=[%d], procs=[%d], duration=[%.1fs], requests=[%llu], failed=[%llu], samples=[%d].\n",
+           name, path, results->url, results->clients, results->procs, results->duration_seconds,
+           (unsigned long long)results->requests, (unsigned long long)results->failed, results->samples_count);
+}
+
+static void print_delta(const char *name, const CompareDelta *delta, const char *format, double scale, compare_verdict verdict)
+{
+    char baseline[32];
+    char candidate[32];
+    snprintf(baseline, sizeof(baseline), format, delta->baseline / scale);
+    snprintf(candidate, sizeof(candidate), format, delta->candidate / scale);
+    printf("%s: [%s] -> [%s], delta=[%+.2f%%], 95%% CI=[%+.2f%%, %+.2f%%], %s.\n",
+           name, baseline, candidate, delta->delta, delta->ci_low, delta->ci_high, verdict_names[verdict]);
+}
+
+int compare_command(int argc, char *argv[])
+{
+    const char *paths[2] = {NULL, NULL};
+    int paths_count = 0;
+    double threshold = DEFAULT_COMPARE_THRESHOLD;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--threshold") && i + 1 < argc)
+        {
+            char *endptr = NULL;
+            errno = 0;
+            threshold = strtod(argv[++i], &endptr);
+            if (errno != 0 || endptr == argv[i] || *endptr != '\0' || threshold < 0)
+            {
+                fprintf(stderr, "Invalid option --threshold %s: It should be a non-negative percentage.\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (paths_count < 2 && argv[i][0] != '-')
+        {
+            paths[paths_count++] = argv[i];
+        }
+        else
+        {
+            paths_count = -1;
+            break;
+        }
+    }
+    if (paths_count != 2)
+    {
+        fprintf(stderr, "webbench2 compare [--threshold <percent>] <baseline.json> <candidate.json>\n"
+                        "  Compare the results written by --json, flagging regressions beyond <percent>. Default 5.\n");
+        return 2;
+    }
+
+    BenchResults *baseline = (BenchResults *) malloc(sizeof(BenchResults));
+    BenchResults *candidate = (BenchResults *) malloc(sizeof(BenchResults));
+    if (NULL == baseline || NULL == candidate)
+    {
+        perror("Memory allocation for the results is failed.");
+        free(baseline);
+        free(candidate);
+        return 2;
+    }
+    if (results_read(baseline, paths[0]) < 0 || results_read(candidate, paths[1]) < 0)
+    {
+        free(baseline);
+        free(candidate);
+        return 2;
+    }
+
+    print_run("Baseline", paths[0], baseline);
+    print_run("Candidate", paths[1], candidate);
+    if (strcmp(baseline->url, candidate->url) != 0 || baseline->clients != candidate->clients)
+    {
+        printf("WARNING: The runs differ in the URL or the clients.\n");
+    }
+
+    int regressions = 0;
+    CompareDelta delta;
+    compare_verdict verdict;
+    if (compare_throughput(baseline, candidate, BOOTSTRAP_SEED, &delta) > 0)
+    {
+        verdict = compare_judge(&delta, true, threshold);
+        regressions += (VERDICT_REGRESSION == verdict);
+        print_delta("Throughput", &delta, "%.1f/s", 1, verdict);
+    }
+    else
+    {
+        printf("Throughput: too few samples to compare, each run needs at least 2 seconds.\n");
+    }
+
+    for (size_t i = 0; i < sizeof(compared_percentiles) / sizeof(compared_percentiles[0]); i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "Latency p%g", compared_percentiles[i]);
+        if (compare_percentile(baseline, candidate, compared_percentiles[i], BOOTSTRAP_SEED, &delta) < 0)
+        {
+            printf("%s: no latency recorded to compare.\n", name);
+            continue;
+        }
+        verdict = compare_judge(&delta, false, threshold);
+        regressions += (VERDICT_REGRESSION == verdict);
+        print_delta(name, &delta, "%.3fms", 1e6, verdict);
+    }
+
+    printf("%d regression(s) beyond the threshold of [%.1f%%].\n", regressions, threshold);
+    free(baseline);
+    free(candidate);
+    return regressions > 0 ? 1 : 0;
+}
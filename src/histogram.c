@@ -0,0 +1,157 @@
+#include "histogram.h"
+#include <string.h>
+
+static int get_bucket_index(uint64_t value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS)
+    {
+        return (int)value;
+    }
+
+    // Keep the top HISTOGRAM_SUB_BUCKET_BITS bits of the value, the highest one is always set.
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - HISTOGRAM_SUB_BUCKET_BITS + 1;
+    if (shift > HISTOGRAM_MAX_SHIFT)
+    {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    return HISTOGRAM_SUB_BUCKETS + (shift - 1) * HISTOGRAM_HALF_SUB_BUCKETS +
+           (int)((value >> shift) - HISTOGRAM_HALF_SUB_BUCKETS);
+}
+
+/**
+ * Get the value in the middle of the range covered by the bucket.
+ */
+static uint64_t get_bucket_value(int index)
+{
+    if (index < HISTOGRAM_SUB_BUCKETS)
+    {
+        return (uint64_t)index;
+    }
+
+    int shift = (index - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_HALF_SUB_BUCKETS + 1;
+    uint64_t sub_bucket = (uint64_t)((index - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_HALF_SUB_BUCKETS + HISTOGRAM_HALF_SUB_BUCKETS);
+    return (sub_bucket << shift) + ((1ull << shift) >> 1);
+}
+
+void histogram_reset(Histogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void histogram_record(Histogram *histogram, uint64_t value)
+{
+    histogram->counts[get_bucket_index(value)]++;
+    if (0 == histogram->total_count || value < histogram->min)
+    {
+        histogram->min = value;
+    }
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+    histogram->total_count++;
+    histogram->sum += value;
+}
+
+void histogram_merge(Histogram *dst, const Histogram *src)
+{
+    if (0 == src->total_count)
+    {
+        return;
+    }
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        dst->counts[i] += src->counts[i];
+    }
+    if (0 == dst->total_count || src->min < dst->min)
+    {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+    dst->total_count += src->total_count;
+    dst->sum += src->sum;
+}
+
+uint64_t histogram_percentile(const Histogram *histogram, double percentile)
+{
+    if (0 == histogram->total_count)
+    {
+        return 0;
+    }
+
+    // The rank of the wanted value, at least the first one.
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)histogram->total_count + 0.5);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank >= histogram->total_count)
+    {
+        return histogram->max;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->counts[i];
+        if (seen >= rank)
+        {
+            // The bucket value is an estimation, keep it within the recorded range.
+            uint64_t value = get_bucket_value(i);
+            if (value < histogram->min)
+            {
+                return histogram->min;
+            }
+            return value > histogram->max ? histogram->max : value;
+        }
+    }
+    return histogram->max;
+}
+
+uint64_t histogram_count_at_most(const Histogram *histogram, uint64_t value)
+{
+    if (0 == histogram->total_count || value < histogram->min)
+    {
+        return 0;
+    }
+    if (value >= histogram->max)
+    {
+        return histogram->total_count;
+    }
+
+    uint64_t count = 0;
+    int last = get_bucket_index(value);
+    for (int i = 0; i <= last; i++)
+    {
+        count += histogram->counts[i];
+    }
+    return count;
+}
+
+double histogram_mean(const Histogram *histogram)
+{
+    if (0 == histogram->total_count)
+    {
+        return 0;
+    }
+    return (double)histogram->sum / (double)histogram->total_count;
+}
+
+void histogram_print(const Histogram *histogram, const char *name, FILE *stream)
+{
+    fprintf(stream, "%s: count=[%llu], min=[%.3fms], mean=[%.3fms], p50=[%.3fms], p90=[%.3fms], p99=[%.3fms], p99.9=[%.3fms], max=[%.3fms].\n",
+            name,
+            (unsigned long long)histogram->total_count,
+            histogram->min / 1e6,
+            histogram_mean(histogram) / 1e6,
+            histogram_percentile(histogram, 50) / 1e6,
+            histogram_percentile(histogram, 90) / 1e6,
+            histogram_percentile(histogram, 99) / 1e6,
+            histogram_percentile(histogram, 99.9) / 1e6,
+            histogram->max / 1e6);
+}
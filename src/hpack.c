@@ -0,0 +1,193 @@
+#include "hpack.h"
+#include <stdio.h>
+#include <string.h>
+
+int hpack_encode_integer(unsigned char *buf, size_t size, unsigned char first_byte, int prefix_bits, uint32_t value)
+{
+    if (NULL == buf || size == 0 || prefix_bits < 1 || prefix_bits > 8)
+    {
+        return -1;
+    }
+
+    uint32_t max_prefix = (1u << prefix_bits) - 1;
+    size_t written = 0;
+
+    // The value fits into the prefix.
+    if (value < max_prefix)
+    {
+        buf[written++] = first_byte | (unsigned char)value;
+        return (int)written;
+    }
+
+    // Otherwise fill the prefix and continue with 7-bit groups, least significant first.
+    buf[written++] = first_byte | (unsigned char)max_prefix;
+    value -= max_prefix;
+    while (value >= 128)
+    {
+        if (written >= size)
+        {
+            return -1;
+        }
+        buf[written++] = (unsigned char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    if (written >= size)
+    {
+        return -1;
+    }
+    buf[written++] = (unsigned char)value;
+    return (int)written;
+}
+
+int hpack_encode_string(unsigned char *buf, size_t size, const char *str, size_t len)
+{
+    if (NULL == buf || NULL == str)
+    {
+        return -1;
+    }
+
+    // H bit is 0, the string is sent as raw octets.
+    int n = hpack_encode_integer(buf, size, 0x00, 7, (uint32_t)len);
+    if (n < 0 || (size_t)n + len > size)
+    {
+        return -1;
+    }
+    memcpy(buf + n, str, len);
+    return n + (int)len;
+}
+
+/**
+ * Literal header field without indexing, with the name taken from the static table (RFC 7541 6.2.2).
+ */
+static int encode_literal_with_indexed_name(unsigned char *buf, size_t size, uint32_t name_index, const char *value)
+{
+    int n = hpack_encode_integer(buf, size, 0x00, 4, name_index);
+    if (n < 0)
+    {
+        return -1;
+    }
+    int m = hpack_encode_string(buf + n, size - n, value, strlen(value));
+    if (m < 0)
+    {
+        return -1;
+    }
+    return n + m;
+}
+
+/**
+ * Indexed header field (RFC 7541 6.1).
+ */
+static int encode_indexed(unsigned char *buf, size_t size, uint32_t index)
+{
+    return hpack_encode_integer(buf, size, 0x80, 7, index);
+}
+
+/**
+ * Get the path part of the url, e.g. "/index.html" of "https://www.example.com:8443/index.html".
+ */
+static const char *get_url_path(const char *url)
+{
+    const char *host_start = strstr(url, "://");
+    const char *path = NULL;
+
+    host_start = (NULL == host_start) ? url : host_start + 3;
+    path = strchr(host_start, '/');
+    return (NULL == path) ? "/" : path;
+}
+
+int hpack_encode_request(const Arguments *args, unsigned char *buf, size_t size)
+{
+    char authority[HOSTNAMELEN + 8] = {0};
+    const char *path = NULL;
+    size_t offset = 0;
+    int n;
+
+    if (NULL == args || NULL == buf)
+    {
+        return -1;
+    }
+
+    // Pseudo-header ":method".
+    switch (args->method)
+    {
+    case METHOD_GET:
+        n = encode_indexed(buf + offset, size - offset, HPACK_STATIC_METHOD_GET);
+        break;
+    case METHOD_HEAD:
+        n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_METHOD_GET, "HEAD");
+        break;
+    case METHOD_OPTIONS:
+        n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_METHOD_GET, "OPTIONS");
+        break;
+    case METHOD_TRACE:
+        n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_METHOD_GET, "TRACE");
+        break;
+    default:
+        return -1;
+    }
+    if (n < 0)
+    {
+        return -1;
+    }
+    offset += n;
+
+    // Pseudo-header ":scheme".
+    n = encode_indexed(buf + offset, size - offset,
+                       PROTOCOL_HTTPS == args->protocol ? HPACK_STATIC_SCHEME_HTTPS : HPACK_STATIC_SCHEME_HTTP);
+    if (n < 0)
+    {
+        return -1;
+    }
+    offset += n;
+
+    // Pseudo-header ":path".
+    path = get_url_path(args->url);
+    if (0 == strcmp(path, "/"))
+    {
+        n = encode_indexed(buf + offset, size - offset, HPACK_STATIC_PATH_ROOT);
+    }
+    else
+    {
+        n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_PATH_ROOT, path);
+    }
+    if (n < 0)
+    {
+        return -1;
+    }
+    offset += n;
+
+    // Pseudo-header ":authority", the host of the URL, with the port only when it's not the default of the scheme.
+    if ((PROTOCOL_HTTPS == args->protocol && 443 == args->target_port) || (PROTOCOL_HTTP == args->protocol && 80 == args->target_port))
+    {
+        snprintf(authority, sizeof(authority), "%s", args->target_host);
+    }
+    else
+    {
+        snprintf(authority, sizeof(authority), "%s:%d", args->target_host, args->target_port);
+    }
+    n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_AUTHORITY, authority);
+    if (n < 0)
+    {
+        return -1;
+    }
+    offset += n;
+
+    n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_USER_AGENT, "WebBench 2");
+    if (n < 0)
+    {
+        return -1;
+    }
+    offset += n;
+
+    if (args->force_reload)
+    {
+        n = encode_literal_with_indexed_name(buf + offset, size - offset, HPACK_STATIC_CACHE_CONTROL, "no-cache");
+        if (n < 0)
+        {
+            return -1;
+        }
+        offset += n;
+    }
+
+    return (int)offset;
+}
@@ -0,0 +1,410 @@
+#include "http2.h"
+#include <stdio.h>
+#include <string.h>
+
+static void write_uint32(unsigned char *buf, uint32_t value)
+{
+    buf[0] = (unsigned char)(value >> 24);
+    buf[1] = (unsigned char)(value >> 16);
+    buf[2] = (unsigned char)(value >> 8);
+    buf[3] = (unsigned char)value;
+}
+
+static uint32_t read_uint32(const unsigned char *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+/**
+ * Append raw bytes to the send buffer, compact the buffer first if the written part is in the way.
+ */
+static int queue_output(H2Session *session, const void *data, size_t len)
+{
+    if (session->send_len + len > sizeof(session->send_buffer) && session->send_offset > 0)
+    {
+        memmove(session->send_buffer, session->send_buffer + session->send_offset, session->send_len - session->send_offset);
+        session->send_len -= session->send_offset;
+        session->send_offset = 0;
+    }
+    if (session->send_len + len > sizeof(session->send_buffer))
+    {
+        return -1;
+    }
+    memcpy(session->send_buffer + session->send_len, data, len);
+    session->send_len += len;
+    return (int)len;
+}
+
+static int queue_frame(H2Session *session, h2_frame_type type, unsigned char flags, uint32_t stream_id,
+                       const unsigned char *payload, size_t len)
+{
+    unsigned char header[H2_FRAME_HEADER_SIZE];
+
+    // Check the room for the whole frame first, a frame must never be queued partially.
+    if ((session->send_len - session->send_offset) + H2_FRAME_HEADER_SIZE + len > sizeof(session->send_buffer))
+    {
+        return -1;
+    }
+
+    header[0] = (unsigned char)(len >> 16);
+    header[1] = (unsigned char)(len >> 8);
+    header[2] = (unsigned char)len;
+    header[3] = (unsigned char)type;
+    header[4] = flags;
+    write_uint32(header + 5, stream_id & H2_MAX_STREAM_ID);
+
+    queue_output(session, header, sizeof(header));
+    if (len > 0)
+    {
+        queue_output(session, payload, len);
+    }
+    return (int)(H2_FRAME_HEADER_SIZE + len);
+}
+
+static int queue_window_update(H2Session *session, uint32_t stream_id, uint32_t increment)
+{
+    unsigned char payload[4];
+    write_uint32(payload, increment & H2_MAX_STREAM_ID);
+    return queue_frame(session, H2_FRAME_WINDOW_UPDATE, 0, stream_id, payload, sizeof(payload));
+}
+
+static h2_stream *find_stream(H2Session *session, uint32_t stream_id)
+{
+    if (0 == stream_id)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < MAX_H2_STREAMS; i++)
+    {
+        if (session->streams[i].stream_id == stream_id)
+        {
+            return &session->streams[i];
+        }
+    }
+    return NULL;
+}
+
+static void release_stream(H2Session *session, h2_stream *stream)
+{
+    stream->stream_id = 0;
+    stream->window_consumed = 0;
+    session->active_streams--;
+}
+
+static void finish_stream(H2Session *session, uint32_t stream_id)
+{
+    h2_stream *stream = find_stream(session, stream_id);
+    if (stream != NULL)
+    {
+        if (session->latency != NULL)
+        {
+            histogram_record(session->latency, session->now_ns - stream->started_ns);
+        }
+        if (session->interval_latency != NULL)
+        {
+            histogram_record(session->interval_latency, session->now_ns - stream->started_ns);
+        }
+        release_stream(session, stream);
+        session->completed++;
+    }
+}
+
+void h2_session_init(H2Session *session, const unsigned char *header_block, size_t header_block_len, int max_streams)
+{
+    unsigned char settings[12];
+
+    memset(session, 0, sizeof(*session));
+    session->header_block = header_block;
+    session->header_block_len = header_block_len;
+    session->max_streams = (max_streams > MAX_H2_STREAMS) ? MAX_H2_STREAMS : max_streams;
+    session->peer_max_streams = UINT32_MAX;
+    session->next_stream_id = 1;
+
+    queue_output(session, H2_CONNECTION_PREFACE, strlen(H2_CONNECTION_PREFACE));
+
+    // Disable server push and open up the stream windows, the bench only downloads.
+    settings[0] = 0;
+    settings[1] = H2_SETTINGS_ENABLE_PUSH;
+    write_uint32(settings + 2, 0);
+    settings[6] = 0;
+    settings[7] = H2_SETTINGS_INITIAL_WINDOW_SIZE;
+    write_uint32(settings + 8, H2_LOCAL_WINDOW_SIZE);
+    queue_frame(session, H2_FRAME_SETTINGS, 0, 0, settings, sizeof(settings));
+
+    // The connection window can only be changed by WINDOW_UPDATE.
+    queue_window_update(session, 0, H2_LOCAL_WINDOW_SIZE - H2_DEFAULT_WINDOW_SIZE);
+}
+
+int h2_session_submit_requests(H2Session *session)
+{
+    int opened = 0;
+
+    if (NULL == session || !session->peer_settings_received || session->goaway_received)
+    {
+        return 0;
+    }
+
+    uint32_t limit = (uint32_t)session->max_streams;
+    if (session->peer_max_streams < limit)
+    {
+        limit = session->peer_max_streams;
+    }
+
+    while ((uint32_t)session->active_streams < limit && session->next_stream_id <= H2_MAX_STREAM_ID)
+    {
+        h2_stream *stream = NULL;
+        for (int i = 0; NULL == stream && i < MAX_H2_STREAMS; i++)
+        {
+            if (0 == session->streams[i].stream_id)
+            {
+                stream = &session->streams[i];
+            }
+        }
+        if (NULL == stream)
+        {
+            break;
+        }
+
+        // The bench methods carry no body, so the HEADERS frame ends the stream.
+        if (queue_frame(session, H2_FRAME_HEADERS, H2_FLAG_END_HEADERS | H2_FLAG_END_STREAM, session->next_stream_id,
+                        session->header_block, session->header_block_len) < 0)
+        {
+            // Send buffer is full, open the rest after it is flushed.
+            break;
+        }
+
+        stream->stream_id = session->next_stream_id;
+        stream->window_consumed = 0;
+        stream->started_ns = session->now_ns;
+        session->next_stream_id += 2;
+        session->active_streams++;
+        opened++;
+    }
+
+    return opened;
+}
+
+static int handle_settings(H2Session *session, unsigned char flags, uint32_t stream_id, const unsigned char *payload, size_t len)
+{
+    if (stream_id != 0 || len % 6 != 0)
+    {
+        return -1;
+    }
+
+    if (flags & H2_FLAG_ACK)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < len; i += 6)
+    {
+        uint16_t id = (uint16_t)((payload[i] << 8) | payload[i + 1]);
+        uint32_t value = read_uint32(payload + i + 2);
+        if (H2_SETTINGS_MAX_CONCURRENT_STREAMS == id)
+        {
+            session->peer_max_streams = value;
+        }
+    }
+
+    session->peer_settings_received = true;
+    return queue_frame(session, H2_FRAME_SETTINGS, H2_FLAG_ACK, 0, NULL, 0) < 0 ? -1 : 0;
+}
+
+static int handle_data(H2Session *session, unsigned char flags, uint32_t stream_id, size_t len)
+{
+    if (0 == stream_id)
+    {
+        return -1;
+    }
+
+    // Padding is subject to flow control as well, so the whole payload is counted.
+    session->connection_window_consumed += (uint32_t)len;
+    session->data_bytes += len;
+    if (session->connection_window_consumed >= H2_LOCAL_WINDOW_SIZE / 2 &&
+        queue_window_update(session, 0, session->connection_window_consumed) > 0)
+    {
+        session->connection_window_consumed = 0;
+    }
+
+    h2_stream *stream = find_stream(session, stream_id);
+    if (NULL == stream)
+    {
+        return 0;
+    }
+
+    if (flags & H2_FLAG_END_STREAM)
+    {
+        finish_stream(session, stream_id);
+        return 0;
+    }
+
+    stream->window_consumed += (uint32_t)len;
+    if (stream->window_consumed >= H2_LOCAL_WINDOW_SIZE / 2 &&
+        queue_window_update(session, stream_id, stream->window_consumed) > 0)
+    {
+        stream->window_consumed = 0;
+    }
+    return 0;
+}
+
+static void handle_goaway(H2Session *session, const unsigned char *payload, size_t len)
+{
+    session->goaway_received = true;
+    session->goaway_last_stream_id = (len >= 4) ? (read_uint32(payload) & H2_MAX_STREAM_ID) : 0;
+
+    // Streams above the last stream id are not processed by the server, they are dropped silently.
+    for (int i = 0; i < MAX_H2_STREAMS; i++)
+    {
+        if (session->streams[i].stream_id > session->goaway_last_stream_id)
+        {
+            release_stream(session, &session->streams[i]);
+        }
+    }
+}
+
+int h2_session_process(H2Session *session)
+{
+    size_t offset = 0;
+
+    if (NULL == session)
+    {
+        return -1;
+    }
+
+    while (session->recv_len - offset >= H2_FRAME_HEADER_SIZE)
+    {
+        const unsigned char *frame = session->recv_buffer + offset;
+        size_t len = ((size_t)frame[0] << 16) | ((size_t)frame[1] << 8) | (size_t)frame[2];
+        h2_frame_type type = (h2_frame_type)frame[3];
+        unsigned char flags = frame[4];
+        uint32_t stream_id = read_uint32(frame + 5) & H2_MAX_STREAM_ID;
+        const unsigned char *payload = frame + H2_FRAME_HEADER_SIZE;
+
+        // SETTINGS_MAX_FRAME_SIZE is never raised by the client.
+        if (len > H2_DEFAULT_MAX_FRAME_SIZE)
+        {
+            fprintf(stderr, "HTTP/2 frame of %zu bytes exceeds the maximum frame size.\n", len);
+            return -1;
+        }
+
+        if (session->recv_len - offset < H2_FRAME_HEADER_SIZE + len)
+        {
+            // Partial frame, wait for more data.
+            break;
+        }
+
+        // A header block must not be interleaved with any other frame.
+        if (session->expect_continuation && type != H2_FRAME_CONTINUATION)
+        {
+            return -1;
+        }
+
+        switch (type)
+        {
+        case H2_FRAME_DATA:
+            if (handle_data(session, flags, stream_id, len) < 0)
+            {
+                return -1;
+            }
+            break;
+        case H2_FRAME_HEADERS:
+            if (0 == stream_id)
+            {
+                return -1;
+            }
+            if (!(flags & H2_FLAG_END_HEADERS))
+            {
+                session->expect_continuation = true;
+                session->continuation_stream_id = stream_id;
+                session->continuation_end_stream = (flags & H2_FLAG_END_STREAM) != 0;
+            }
+            else if (flags & H2_FLAG_END_STREAM)
+            {
+                finish_stream(session, stream_id);
+            }
+            break;
+        case H2_FRAME_CONTINUATION:
+            if (!session->expect_continuation || stream_id != session->continuation_stream_id)
+            {
+                return -1;
+            }
+            if (flags & H2_FLAG_END_HEADERS)
+            {
+                session->expect_continuation = false;
+                if (session->continuation_end_stream)
+                {
+                    finish_stream(session, stream_id);
+                }
+            }
+            break;
+        case H2_FRAME_RST_STREAM:
+        {
+            h2_stream *stream = find_stream(session, stream_id);
+            if (stream != NULL)
+            {
+                release_stream(session, stream);
+                session->failed++;
+            }
+            break;
+        }
+        case H2_FRAME_SETTINGS:
+            if (handle_settings(session, flags, stream_id, payload, len) < 0)
+            {
+                return -1;
+            }
+            break;
+        case H2_FRAME_PING:
+            if (len != 8 || stream_id != 0)
+            {
+                return -1;
+            }
+            if (!(flags & H2_FLAG_ACK) && queue_frame(session, H2_FRAME_PING, H2_FLAG_ACK, 0, payload, len) < 0)
+            {
+                return -1;
+            }
+            break;
+        case H2_FRAME_GOAWAY:
+            handle_goaway(session, payload, len);
+            break;
+        case H2_FRAME_PUSH_PROMISE:
+            // Server push is disabled by the client SETTINGS.
+            return -1;
+        default:
+            // PRIORITY, WINDOW_UPDATE and unknown frames need no action, the client sends no DATA.
+            break;
+        }
+
+        offset += H2_FRAME_HEADER_SIZE + len;
+    }
+
+    // Keep the partial frame at the beginning of the buffer.
+    if (offset > 0)
+    {
+        memmove(session->recv_buffer, session->recv_buffer + offset, session->recv_len - offset);
+        session->recv_len -= offset;
+    }
+
+    // Replace the finished streams with new ones.
+    h2_session_submit_requests(session);
+    return 0;
+}
+
+void h2_session_consume_output(H2Session *session, size_t n)
+{
+    session->send_offset += n;
+    if (session->send_offset >= session->send_len)
+    {
+        session->send_offset = 0;
+        session->send_len = 0;
+    }
+}
+
+bool h2_session_want_write(const H2Session *session)
+{
+    return session->send_len > session->send_offset;
+}
+
+bool h2_session_is_finished(const H2Session *session)
+{
+    return (session->goaway_received || session->next_stream_id > H2_MAX_STREAM_ID) && 0 == session->active_streams;
+}
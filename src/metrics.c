@@ -0,0 +1,385 @@
+#include "metrics.h"
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "timing.h"
+
+#define METRICS_REQUEST_SIZE 2048
+
+// Upper bounds of the exported latency buckets in seconds, the counts are cumulative up to +Inf.
+static const double latency_bounds[] = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+};
+
+// Quantiles read from the finer buckets of the histogram itself.
+static const double latency_quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+/**
+ * Append the formatted text to the buffer.
+ *
+ * RETURNS:
+ *      Positive number: The text was appended.
+ *      Negative number: The buffer is too small, it's left as it was.
+ */
+static int append(char *buffer, size_t size, size_t *len, const char *format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    int written = vsnprintf(buffer + *len, size - *len, format, ap);
+    va_end(ap);
+    if (written < 0 || (size_t)written >= size - *len)
+    {
+        buffer[*len] = '\0';
+        return -1;
+    }
+    *len += (size_t)written;
+    return 1;
+}
+
+int metrics_render(const ProcessStats *total, int workers, double uptime_seconds, char *buffer, size_t size)
+{
+    size_t len = 0;
+    int ok = 1;
+
+    if (0 == size)
+    {
+        return -1;
+    }
+    buffer[0] = '\0';
+
+    ok &= append(buffer, size, &len,
+                 "# HELP webbench2_requests_total Requests completed with a response.\n"
+                 "# TYPE webbench2_requests_total counter\n"
+                 "webbench2_requests_total %llu\n"
+                 "# HELP webbench2_requests_failed_total Requests failed by a connect, TLS or I/O error.\n"
+                 "# TYPE webbench2_requests_failed_total counter\n"
+                 "webbench2_requests_failed_total %llu\n"
+                 "# HELP webbench2_responses_mismatched_total Responses failing --expect-status or --expect-body-hash.\n"
+                 "# TYPE webbench2_responses_mismatched_total counter\n"
+                 "webbench2_responses_mismatched_total %llu\n"
+                 "# HELP webbench2_received_bytes_total Bytes of the responses received.\n"
+                 "# TYPE webbench2_received_bytes_total counter\n"
+                 "webbench2_received_bytes_total{part=\"headers\"} %llu\n"
+                 "webbench2_received_bytes_total{part=\"payload\"} %llu\n"
+                 "# HELP webbench2_workers Worker processes publishing their results.\n"
+                 "# TYPE webbench2_workers gauge\n"
+                 "webbench2_workers %d\n"
+                 "# HELP webbench2_uptime_seconds Seconds since the bench started.\n"
+                 "# TYPE webbench2_uptime_seconds gauge\n"
+                 "webbench2_uptime_seconds %.3f\n",
+                 (unsigned long long)total->speed,
+                 (unsigned long long)total->failed,
+                 (unsigned long long)total->mismatched,
+                 (unsigned long long)total->header_bytes,
+                 (unsigned long long)total->payload_bytes,
+                 workers,
+                 uptime_seconds) > 0;
+
+    ok &= append(buffer, size, &len,
+                 "# HELP webbench2_request_duration_seconds Latency of the requests until their response is received.\n"
+                 "# TYPE webbench2_request_duration_seconds histogram\n") > 0;
+    for (size_t i = 0; i < sizeof(latency_bounds) / sizeof(latency_bounds[0]); i++)
+    {
+        ok &= append(buffer, size, &len, "webbench2_request_duration_seconds_bucket{le=\"%g\"} %llu\n", latency_bounds[i],
+                     (unsigned long long)histogram_count_at_most(&total->latency, (uint64_t)(latency_bounds[i] * 1e9))) > 0;
+    }
+    ok &= append(buffer, size, &len,
+                 "webbench2_request_duration_seconds_bucket{le=\"+Inf\"} %llu\n"
+                 "webbench2_request_duration_seconds_sum %.9f\n"
+                 "webbench2_request_duration_seconds_count %llu\n",
+                 (unsigned long long)total->latency.total_count,
+                 total->latency.sum / 1e9,
+                 (unsigned long long)total->latency.total_count) > 0;
+
+    ok &= append(buffer, size, &len,
+                 "# HELP webbench2_request_duration_quantile_seconds Latency of the requests at the quantile, since the bench started.\n"
+                 "# TYPE webbench2_request_duration_quantile_seconds gauge\n") > 0;
+    for (size_t i = 0; i < sizeof(latency_quantiles) / sizeof(latency_quantiles[0]); i++)
+    {
+        ok &= append(buffer, size, &len, "webbench2_request_duration_quantile_seconds{quantile=\"%g\"} %.9f\n", latency_quantiles[i],
+                     histogram_percentile(&total->latency, latency_quantiles[i] * 100) / 1e9) > 0;
+    }
+
+    return ok ? (int)len : -1;
+}
+
+/**
+ * Write the whole buffer to the blocking socket.
+ */
+static int write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t written = send(fd, data, len, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return 1;
+}
+
+/**
+ * Answer one scrape with the results published so far, the connection is closed afterwards.
+ */
+static void serve_scrape(MetricsServer *server, int client_fd, char *buffer, ProcessStats *total)
+{
+    char request[METRICS_REQUEST_SIZE];
+    char header[256];
+    size_t received = 0;
+
+    // A client which never finishes its request doesn't hold the server up.
+    struct timeval timeout = {1, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    while (received < sizeof(request) - 1)
+    {
+        ssize_t bytes_read = recv(client_fd, request + received, sizeof(request) - 1 - received, 0);
+        if (bytes_read <= 0)
+        {
+            return;
+        }
+        received += (size_t)bytes_read;
+        request[received] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+        {
+            break;
+        }
+    }
+    request[received] = '\0';
+
+    if (strncmp(request, "GET /metrics ", 13) != 0 && strncmp(request, "GET / ", 6) != 0)
+    {
+        const char *not_found = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        write_all(client_fd, not_found, strlen(not_found));
+        return;
+    }
+
+    process_stats_aggregate(server->published, server->published_count, total);
+    int len = metrics_render(total, server->published_count, (get_monotonic_ns() - server->start_ns) / 1e9,
+                             buffer, METRICS_BUFFER_SIZE);
+    if (len < 0)
+    {
+        const char *error = "HTTP/1.0 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        write_all(client_fd, error, strlen(error));
+        return;
+    }
+
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                              "Content-Length: %d\r\n"
+                              "Connection: close\r\n\r\n", len);
+    if (write_all(client_fd, header, header_len) > 0)
+    {
+        write_all(client_fd, buffer, len);
+    }
+}
+
+static void *run_metrics_server(void *arg)
+{
+    MetricsServer *server = (MetricsServer *) arg;
+    char *buffer = (char *) malloc(METRICS_BUFFER_SIZE);
+    ProcessStats *total = (ProcessStats *) malloc(sizeof(ProcessStats));
+    if (NULL == buffer || NULL == total)
+    {
+        fprintf(stderr, "Memory allocation for the metrics is failed.\n");
+        free(buffer);
+        free(total);
+        return NULL;
+    }
+
+    // Woken up regularly to notice the server is stopping.
+    while (!__atomic_load_n(&server->stopping, __ATOMIC_ACQUIRE))
+    {
+        struct pollfd pfd = {server->listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0)
+        {
+            continue;
+        }
+        int client_fd = accept4(server->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (client_fd < 0)
+        {
+            continue;
+        }
+        serve_scrape(server, client_fd, buffer, total);
+        close(client_fd);
+    }
+
+    free(buffer);
+    free(total);
+    return NULL;
+}
+
+static int listen_unix(MetricsServer *server, const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (0 == strlen(path) || strlen(path) >= sizeof(addr.sun_path) || strlen(path) >= sizeof(server->unix_path))
+    {
+        fprintf(stderr, "Invalid metrics socket path [%s].\n", path);
+        return -1;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        perror("Failed to create the metrics socket");
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, 16) < 0)
+    {
+        fprintf(stderr, "Failed to listen on the metrics socket [%s]: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    snprintf(server->unix_path, sizeof(server->unix_path), "%s", path);
+    return fd;
+}
+
+static int listen_tcp(const char *address)
+{
+    char host[256];
+    const char *port = strrchr(address, ':');
+    if (NULL == port)
+    {
+        snprintf(host, sizeof(host), "%s", METRICS_DEFAULT_HOST);
+        port = address;
+    }
+    else if ((size_t)(port - address) < sizeof(host))
+    {
+        // An IPv6 host is given in brackets, e.g. [::1]:9100.
+        const char *start = address;
+        size_t host_len = (size_t)(port - address);
+        if ('[' == *start && host_len >= 2 && ']' == start[host_len - 1])
+        {
+            start++;
+            host_len -= 2;
+        }
+        memcpy(host, start, host_len);
+        host[host_len] = '\0';
+        port++;
+    }
+    else
+    {
+        fprintf(stderr, "Invalid metrics address [%s].\n", address);
+        return -1;
+    }
+
+    char *endptr = NULL;
+    long port_number = strtol(port, &endptr, 10);
+    if (endptr == port || *endptr != '\0' || port_number <= 0 || port_number > 65535)
+    {
+        fprintf(stderr, "Invalid metrics port in [%s].\n", address);
+        return -1;
+    }
+
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_PASSIVE | AI_NUMERICSERV,
+        .ai_protocol = 0
+    };
+    struct addrinfo *result = NULL;
+    int ret = getaddrinfo(host, port, &hints, &result);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Failed to resolve the metrics address [%s]: %s\n", address, gai_strerror(ret));
+        return -1;
+    }
+
+    int fd = -1;
+    int error = 0;
+    for (struct addrinfo *ai = result; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0)
+        {
+            error = errno;
+            continue;
+        }
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (0 == bind(fd, ai->ai_addr, ai->ai_addrlen) && 0 == listen(fd, 16))
+        {
+            break;
+        }
+        error = errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "Failed to listen on the metrics address [%s]: %s\n", address, strerror(error));
+    }
+    return fd;
+}
+
+int metrics_server_start(MetricsServer *server, const char *address, const ProcessStats *published, int published_count)
+{
+    memset(server, 0, sizeof(*server));
+    server->published = published;
+    server->published_count = published_count;
+    server->start_ns = get_monotonic_ns();
+
+    if (0 == strncmp(address, METRICS_UNIX_PREFIX, strlen(METRICS_UNIX_PREFIX)))
+    {
+        server->listen_fd = listen_unix(server, address + strlen(METRICS_UNIX_PREFIX));
+    }
+    else
+    {
+        server->listen_fd = listen_tcp(address);
+    }
+    if (server->listen_fd < 0)
+    {
+        return -1;
+    }
+
+    int ret = pthread_create(&server->thread, NULL, run_metrics_server, server);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Failed to start the metrics thread: %s\n", strerror(ret));
+        metrics_server_stop(server);
+        return -1;
+    }
+    server->started = true;
+    printf("Serving metrics on [%s].\n", address);
+    return 1;
+}
+
+void metrics_server_stop(MetricsServer *server)
+{
+    if (server->started)
+    {
+        __atomic_store_n(&server->stopping, true, __ATOMIC_RELEASE);
+        pthread_join(server->thread, NULL);
+        server->started = false;
+    }
+    if (server->listen_fd >= 0)
+    {
+        close(server->listen_fd);
+        server->listen_fd = -1;
+    }
+    if (strlen(server->unix_path) > 0)
+    {
+        unlink(server->unix_path);
+        server->unix_path[0] = '\0';
+    }
+}
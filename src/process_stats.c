@@ -0,0 +1,51 @@
+#include "process_stats.h"
+#include <string.h>
+#include <unistd.h>
+
+void process_stats_begin_write(ProcessStats *stats)
+{
+    __atomic_store_n(&stats->sequence, stats->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void process_stats_end_write(ProcessStats *stats)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&stats->sequence, stats->sequence + 1, __ATOMIC_RELAXED);
+}
+
+void process_stats_read(const ProcessStats *stats, ProcessStats *snapshot)
+{
+    uint64_t sequence;
+    do
+    {
+        // Wait for the writer to finish.
+        while ((sequence = __atomic_load_n(&stats->sequence, __ATOMIC_ACQUIRE)) & 1)
+        {
+            usleep(1000);
+        }
+        memcpy(snapshot, stats, sizeof(*snapshot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&stats->sequence, __ATOMIC_RELAXED) != sequence);
+}
+
+void process_stats_aggregate(const ProcessStats *published, int count, ProcessStats *total)
+{
+    ProcessStats snapshot;
+
+    memset(total, 0, sizeof(*total));
+    for (int i = 0; i < count; i++)
+    {
+        process_stats_read(&published[i], &snapshot);
+        total->speed += snapshot.speed;
+        total->failed += snapshot.failed;
+        total->header_bytes += snapshot.header_bytes;
+        total->payload_bytes += snapshot.payload_bytes;
+        total->mismatched += snapshot.mismatched;
+        if (snapshot.bench_ns > total->bench_ns)
+        {
+            total->bench_ns = snapshot.bench_ns;
+        }
+        histogram_merge(&total->latency, &snapshot.latency);
+    }
+}
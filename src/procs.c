@@ -0,0 +1,187 @@
+#include "procs.h"
+#include "bench_epoll.h"
+#include "affinity.h"
+#include "metrics.h"
+#include "results.h"
+#include "resource_usage.h"
+#include "timing.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void bench_processes(const Arguments *args, const HTTPRequest *http_request)
+{
+    int procs = args->procs;
+    pid_t pids[MAX_PROCS];
+    int cpus[MAX_CPU_LIST];
+
+    // Each worker is pinned to a CPU of its own, in turn.
+    int cpus_count = resolve_worker_cpus(args, cpus, MAX_CPU_LIST);
+    if (cpus_count < 0)
+    {
+        return;
+    }
+
+    // Anonymous shared memory is inherited by the forked workers.
+    ProcessStats *shared = (ProcessStats *) mmap(NULL, procs * sizeof(ProcessStats), PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == shared)
+    {
+        perror("Failed to map the memory shared with the workers.");
+        return;
+    }
+
+    printf("Starting %d processes with %d clients...\n", procs, args->clients);
+
+    // Buffered output would be written again by every worker.
+    fflush(stdout);
+    for (int i = 0; i < procs; i++)
+    {
+        Arguments worker_args = *args;
+        worker_args.procs = 1;
+        worker_args.clients = args->clients / procs + (i < args->clients % procs ? 1 : 0);
+        if (cpus_count > 0)
+        {
+            worker_args.cpus[0] = cpus[i % cpus_count];
+            worker_args.cpus_count = 1;
+            worker_args.irq_interface[0] = '\0';
+        }
+
+        pids[i] = fork();
+        if (-1 == pids[i])
+        {
+            perror("Failed to fork a worker process.");
+            procs = i;
+            break;
+        }
+        if (0 == pids[i])
+        {
+            // OpenSSL and the allocator are initialized by the worker itself, nothing is shared but the results.
+            bench_epoll_worker(&worker_args, http_request, &shared[i]);
+            fflush(stdout);
+            _exit(EXIT_SUCCESS);
+        }
+    }
+
+    // Serve the results of all workers, started after forking since the workers don't need the thread.
+    MetricsServer metrics;
+    bool serving_metrics = strlen(args->metrics_address) > 0;
+    if (serving_metrics && metrics_server_start(&metrics, args->metrics_address, shared, procs) < 0)
+    {
+        serving_metrics = false;
+    }
+
+    // Report the results of all workers while they run.
+    ProcessStats *total = (ProcessStats *) calloc(1, sizeof(ProcessStats));
+    if (NULL == total)
+    {
+        perror("Memory allocation for the results is failed.");
+        exit(EXIT_FAILURE);
+    }
+    int report_interval = args->report_interval > 0 ? args->report_interval : 1;
+    uint64_t start_ns = get_monotonic_ns();
+
+    // The requests completed in each second by all workers are kept for comparing runs.
+    BenchResults *results = NULL;
+    if (strlen(args->json_file) > 0)
+    {
+        results = (BenchResults *) malloc(sizeof(BenchResults));
+        if (NULL == results)
+        {
+            perror("Memory allocation for the results is failed.");
+            exit(EXIT_FAILURE);
+        }
+        results_init(results, args, start_ns);
+    }
+    uint64_t reported_ns = start_ns;
+    int running = procs;
+    while (running > 0)
+    {
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0)
+        {
+            running--;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            {
+                fprintf(stderr, "Worker process [%d] exited abnormally.\n", (int)pid);
+            }
+            continue;
+        }
+        if (pid < 0)
+        {
+            perror("Failed to wait for the worker processes.");
+            break;
+        }
+
+        usleep(100000);
+        uint64_t now_ns = get_monotonic_ns();
+        if (results != NULL && now_ns - results->sampled_ns >= RESULT_SAMPLE_NS)
+        {
+            process_stats_aggregate(shared, procs, total);
+            results_sample(results, total->speed, now_ns);
+        }
+        if (now_ns - reported_ns >= (uint64_t)report_interval * 1000000000ull)
+        {
+            process_stats_aggregate(shared, procs, total);
+            printf("[%.0fs] Processes running: [%d], speed=[%" PRIu64 "], failed=[%" PRIu64 "], p99=[%.3fms].\n",
+                   (now_ns - start_ns) / 1e9, running, total->speed, total->failed,
+                   histogram_percentile(&total->latency, 99) / 1e6);
+            reported_ns = now_ns;
+        }
+    }
+
+    // The rates are over the time the workers benched, their warm-up is left out.
+    process_stats_aggregate(shared, procs, total);
+    uint64_t bench_ns = total->bench_ns;
+    uint64_t total_bytes = total->header_bytes + total->payload_bytes;
+    printf("Bench of %d processes is done. speed=[%" PRIu64 "], bytes=[%" PRIu64 "], failed[%" PRIu64 "].\n",
+           procs, total->speed, total_bytes, total->failed);
+    printf("Received: headers=[%" PRIu64 "], payload=[%" PRIu64 "], throughput=[%.3fMB/s].\n",
+           total->header_bytes, total->payload_bytes, bench_ns > 0 ? total_bytes * 1e3 / bench_ns : 0.0);
+    if (args->expect_status || args->expect_body_hash_set)
+    {
+        printf("Mismatched responses: [%" PRIu64 "].\n", total->mismatched);
+    }
+    histogram_print(&total->latency, "Request latency", stdout);
+
+    // Each worker is a single event loop, so the CPU of its loop is the CPU of its share of the requests.
+    ResourceUsage total_usage;
+    memset(&total_usage, 0, sizeof(total_usage));
+    for (int i = 0; i < procs; i++)
+    {
+        ProcessStats snapshot;
+        char name[64];
+        process_stats_read(&shared[i], &snapshot);
+        snprintf(name, sizeof(name), "Worker [%d] resources", i);
+        resource_usage_print(&snapshot.usage, name, snapshot.bench_ns / 1e9, snapshot.speed, stdout);
+        resource_usage_add(&total_usage, &snapshot.usage);
+    }
+    resource_usage_print(&total_usage, "Resources of all workers", bench_ns / 1e9, total->speed, stdout);
+
+    if (results != NULL)
+    {
+        results->duration_seconds = bench_ns / 1e9;
+        results->requests = total->speed;
+        results->failed = total->failed;
+        results->header_bytes = total->header_bytes;
+        results->payload_bytes = total->payload_bytes;
+        results->mismatched = total->mismatched;
+        results->latency = total->latency;
+        if (results_write(results, args->json_file) > 0)
+        {
+            printf("Results are written to [%s].\n", args->json_file);
+        }
+        free(results);
+    }
+    if (serving_metrics)
+    {
+        metrics_server_stop(&metrics);
+    }
+    free(total);
+    munmap(shared, args->procs * sizeof(ProcessStats));
+}
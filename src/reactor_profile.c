@@ -0,0 +1,144 @@
+#include "reactor_profile.h"
+#include <string.h>
+
+static const char *phase_names[REACTOR_PHASES] = {
+    "epoll_wait", "ssl", "parse", "send/recv", "other"
+};
+
+void reactor_profile_init(ReactorProfile *profile, uint64_t now_ns)
+{
+    memset(profile, 0, sizeof(ReactorProfile));
+    profile->phase = REACTOR_OTHER;
+    profile->switched_ns = now_ns;
+    profile->window_ns = REACTOR_LAG_WINDOW_NS;
+    profile->window_started_ns = now_ns;
+}
+
+reactor_phase reactor_profile_switch(ReactorProfile *profile, reactor_phase phase, uint64_t now_ns)
+{
+    reactor_phase left = profile->phase;
+    if (now_ns > profile->switched_ns)
+    {
+        profile->phase_ns[left] += now_ns - profile->switched_ns;
+        profile->switched_ns = now_ns;
+    }
+    profile->phase = phase;
+    return left;
+}
+
+/**
+ * Keep the mean lag of the window which has ended, halving the windows kept when they run out.
+ */
+static void close_window(ReactorProfile *profile, uint64_t now_ns)
+{
+    if (profile->window_lag_count > 0)
+    {
+        if (REACTOR_LAG_WINDOWS == profile->windows_count)
+        {
+            for (int i = 0; i < REACTOR_LAG_WINDOWS / 2; i++)
+            {
+                profile->window_lag_ns[i] = (profile->window_lag_ns[2 * i] + profile->window_lag_ns[2 * i + 1]) / 2;
+            }
+            profile->windows_count = REACTOR_LAG_WINDOWS / 2;
+            profile->window_ns *= 2;
+        }
+        profile->window_lag_ns[profile->windows_count++] = (double)profile->window_lag_sum / profile->window_lag_count;
+    }
+    profile->window_lag_sum = 0;
+    profile->window_lag_count = 0;
+    profile->window_started_ns = now_ns;
+}
+
+void reactor_profile_record_lag(ReactorProfile *profile, uint64_t lag_ns, uint64_t now_ns)
+{
+    if (now_ns - profile->window_started_ns >= profile->window_ns)
+    {
+        close_window(profile, now_ns);
+    }
+    histogram_record(&profile->lag, lag_ns);
+    profile->window_lag_sum += lag_ns;
+    profile->window_lag_count++;
+}
+
+double reactor_profile_busy(const ReactorProfile *profile)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < REACTOR_PHASES; i++)
+    {
+        total += profile->phase_ns[i];
+    }
+    if (0 == total)
+    {
+        return 0.0;
+    }
+    return (double)(total - profile->phase_ns[REACTOR_WAIT]) / total;
+}
+
+double reactor_profile_lag_rise_ns(const ReactorProfile *profile)
+{
+    int n = profile->windows_count;
+    if (n < 3)
+    {
+        return 0.0;
+    }
+
+    // Slope of the mean lag over the index of the windows, times the span of the windows.
+    double mean_x = (n - 1) / 2.0;
+    double mean_y = 0;
+    for (int i = 0; i < n; i++)
+    {
+        mean_y += profile->window_lag_ns[i];
+    }
+    mean_y /= n;
+    double covariance = 0;
+    double variance = 0;
+    for (int i = 0; i < n; i++)
+    {
+        covariance += (i - mean_x) * (profile->window_lag_ns[i] - mean_y);
+        variance += (i - mean_x) * (i - mean_x);
+    }
+    return covariance / variance * (n - 1);
+}
+
+bool reactor_profile_saturated(const ReactorProfile *profile)
+{
+    if (reactor_profile_busy(profile) > REACTOR_BUSY_LIMIT)
+    {
+        return true;
+    }
+    double rise = reactor_profile_lag_rise_ns(profile);
+    return rise > REACTOR_LAG_RISE_MIN_NS && rise > profile->window_lag_ns[0];
+}
+
+void reactor_profile_print(const ReactorProfile *profile, FILE *stream)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < REACTOR_PHASES; i++)
+    {
+        total += profile->phase_ns[i];
+    }
+    fprintf(stream, "Reactor time:");
+    for (int i = 0; i < REACTOR_PHASES; i++)
+    {
+        fprintf(stream, " %s=[%.1f%%],", phase_names[i], total > 0 ? profile->phase_ns[i] * 100.0 / total : 0.0);
+    }
+    fprintf(stream, " busy=[%.1f%%].\n", reactor_profile_busy(profile) * 100);
+    histogram_print(&profile->lag, "Loop lag", stream);
+    reactor_profile_print_warnings(profile, stream);
+}
+
+void reactor_profile_print_warnings(const ReactorProfile *profile, FILE *stream)
+{
+    double busy = reactor_profile_busy(profile);
+    double rise = reactor_profile_lag_rise_ns(profile);
+    if (busy > REACTOR_BUSY_LIMIT)
+    {
+        fprintf(stream, "WARNING: The reactor was [%.1f%%] busy, the results may be limited by webbench2 "
+                        "rather than by the server.\n", busy * 100);
+    }
+    if (rise > REACTOR_LAG_RISE_MIN_NS && rise > profile->window_lag_ns[0])
+    {
+        fprintf(stream, "WARNING: The loop lag rose by [%.3fms] during the bench, the results may be limited by "
+                        "webbench2 rather than by the server.\n", rise / 1e6);
+    }
+}
@@ -0,0 +1,295 @@
+#include "replay.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Pages of the log read are dropped by this size, a multiple of any page size.
+#define REPLAY_RELEASE_SIZE (16u << 20)
+
+int replay_log_open(ReplayLog *log, const char *path)
+{
+    struct stat st;
+
+    memset(log, 0, sizeof(*log));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        perror("Failed to open the replay log.");
+        return -1;
+    }
+    if (fstat(fd, &st) == -1 || 0 == st.st_size)
+    {
+        fprintf(stderr, "The replay log %s is empty or not a regular file.\n", path);
+        close(fd);
+        return -1;
+    }
+
+    // The mapping stays valid after the file is closed.
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data)
+    {
+        perror("Failed to map the replay log.");
+        return -1;
+    }
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    log->data = (const char *)data;
+    log->size = (size_t)st.st_size;
+    return 1;
+}
+
+void replay_log_close(ReplayLog *log)
+{
+    if (log->data != NULL)
+    {
+        munmap((void *)log->data, log->size);
+        log->data = NULL;
+    }
+}
+
+/**
+ * Parse "<seconds>[.<fraction>]" into nanoseconds.
+ */
+static int parse_timestamp(const char *text, size_t len, uint64_t *timestamp_ns)
+{
+    size_t i = 0;
+    uint64_t seconds = 0;
+    uint64_t fraction_ns = 0;
+    uint64_t scale = 100000000ull;
+
+    for (; i < len && text[i] >= '0' && text[i] <= '9'; i++)
+    {
+        seconds = seconds * 10 + (uint64_t)(text[i] - '0');
+    }
+    if (0 == i)
+    {
+        return -1;
+    }
+    if (i < len && '.' == text[i])
+    {
+        for (i++; i < len && text[i] >= '0' && text[i] <= '9'; i++, scale /= 10)
+        {
+            fraction_ns += (uint64_t)(text[i] - '0') * scale;
+        }
+    }
+    if (i != len)
+    {
+        return -1;
+    }
+    *timestamp_ns = seconds * 1000000000ull + fraction_ns;
+    return 1;
+}
+
+/**
+ * Drop the pages of the log which have been read, so they don't stay resident.
+ */
+static void release_read_pages(ReplayLog *log)
+{
+    while (log->offset - log->released >= REPLAY_RELEASE_SIZE)
+    {
+        madvise((void *)(log->data + log->released), REPLAY_RELEASE_SIZE, MADV_DONTNEED);
+        log->released += REPLAY_RELEASE_SIZE;
+    }
+}
+
+int replay_log_next(ReplayLog *log, ReplayEntry *entry)
+{
+    while (log->offset < log->size)
+    {
+        const char *line = log->data + log->offset;
+        const char *newline = memchr(line, '\n', log->size - log->offset);
+        size_t line_len = newline ? (size_t)(newline - line) : log->size - log->offset;
+
+        log->offset += line_len + (newline ? 1 : 0);
+        log->line_number++;
+        release_read_pages(log);
+
+        if (line_len > 0 && '\r' == line[line_len - 1])
+        {
+            line_len--;
+        }
+        if (0 == line_len || '#' == line[0])
+        {
+            continue;
+        }
+
+        // Timestamp, method and path are required, the headers are optional.
+        const char *end = line + line_len;
+        const char *method = memchr(line, '\t', line_len);
+        if (NULL == method)
+        {
+            return -1;
+        }
+        method++;
+        const char *path = memchr(method, '\t', (size_t)(end - method));
+        if (NULL == path || path == method)
+        {
+            return -1;
+        }
+        path++;
+        const char *headers = memchr(path, '\t', (size_t)(end - path));
+        const char *path_end = headers ? headers : end;
+        if (path == path_end || '/' != path[0])
+        {
+            return -1;
+        }
+
+        uint64_t timestamp_ns;
+        if (parse_timestamp(line, (size_t)(method - 1 - line), &timestamp_ns) < 0)
+        {
+            return -1;
+        }
+        if (!log->has_first_timestamp)
+        {
+            log->first_timestamp_ns = timestamp_ns;
+            log->has_first_timestamp = true;
+        }
+
+        // A line out of order is sent right after the one before it.
+        uint64_t offset_ns = timestamp_ns > log->first_timestamp_ns ? timestamp_ns - log->first_timestamp_ns : 0;
+        if (offset_ns < log->last_offset_ns)
+        {
+            offset_ns = log->last_offset_ns;
+        }
+        log->last_offset_ns = offset_ns;
+
+        entry->offset_ns = offset_ns;
+        entry->method = method;
+        entry->method_len = (size_t)(path - 1 - method);
+        entry->path = path;
+        entry->path_len = (size_t)(path_end - path);
+        entry->headers = headers ? headers + 1 : end;
+        entry->headers_len = headers ? (size_t)(end - headers - 1) : 0;
+        return 1;
+    }
+    return 0;
+}
+
+int replay_schedule_init(ReplaySchedule *schedule, const char *path, double speed, uint64_t now_ns)
+{
+    memset(schedule, 0, sizeof(*schedule));
+    if (replay_log_open(&schedule->log, path) < 0)
+    {
+        return -1;
+    }
+    schedule->speed = speed;
+    schedule->start_ns = now_ns;
+    return 1;
+}
+
+int replay_schedule_next_due(ReplaySchedule *schedule, uint64_t *due_ns)
+{
+    if (schedule->finished)
+    {
+        return 0;
+    }
+
+    // The entry read ahead is kept until it's due.
+    if (!schedule->has_next)
+    {
+        int result = replay_log_next(&schedule->log, &schedule->next);
+        if (result <= 0)
+        {
+            schedule->finished = (0 == result);
+            return result;
+        }
+        schedule->has_next = true;
+    }
+
+    *due_ns = schedule->start_ns + (uint64_t)((double)schedule->next.offset_ns / schedule->speed);
+    return 1;
+}
+
+int replay_schedule_take(ReplaySchedule *schedule, uint64_t now_ns, ReplayEntry *entry, uint64_t *late_ns)
+{
+    uint64_t due_ns;
+    int result = replay_schedule_next_due(schedule, &due_ns);
+    if (result <= 0)
+    {
+        return result;
+    }
+    if (now_ns < due_ns)
+    {
+        return 0;
+    }
+
+    *entry = schedule->next;
+    *late_ns = now_ns - due_ns;
+    schedule->has_next = false;
+    return 1;
+}
+
+/**
+ * Append text_len bytes of text to the buffer, keeping the room for the terminating '\0'.
+ */
+static int append(char *buffer, size_t size, size_t *len, const char *text, size_t text_len)
+{
+    if (*len + text_len >= size)
+    {
+        return -1;
+    }
+    memcpy(buffer + *len, text, text_len);
+    *len += text_len;
+    return 1;
+}
+
+int replay_render(const ReplayEntry *entry, const char *base_request, char *buffer, size_t size)
+{
+    size_t len = 0;
+
+    // The base is "<method> <prefix> HTTP/1.x\r\n<headers>\r\n", the prefix is the proxy URL or empty.
+    const char *line_end = strstr(base_request, "\r\n");
+    size_t base_len = strlen(base_request);
+    if (NULL == line_end || base_len < 4 || strcmp(base_request + base_len - 4, "\r\n\r\n") != 0)
+    {
+        return -1;
+    }
+    size_t line_len = (size_t)(line_end - base_request);
+    const char *prefix = memchr(base_request, ' ', line_len);
+    const char *version = memrchr(base_request, ' ', line_len);
+    if (NULL == prefix || prefix == version)
+    {
+        return -1;
+    }
+    prefix++;
+
+    if (append(buffer, size, &len, entry->method, entry->method_len) < 0 ||
+        append(buffer, size, &len, " ", 1) < 0 ||
+        append(buffer, size, &len, prefix, (size_t)(version - prefix)) < 0 ||
+        append(buffer, size, &len, entry->path, entry->path_len) < 0 ||
+        append(buffer, size, &len, version, (size_t)(line_end + 2 - version)) < 0 ||
+        append(buffer, size, &len, line_end + 2, (size_t)(base_request + base_len - 2 - (line_end + 2))) < 0)
+    {
+        return -1;
+    }
+
+    // Headers of the log follow the ones of the base.
+    const char *header = entry->headers;
+    const char *headers_end = entry->headers + entry->headers_len;
+    while (header < headers_end)
+    {
+        const char *header_end = memchr(header, '\t', (size_t)(headers_end - header));
+        if (NULL == header_end)
+        {
+            header_end = headers_end;
+        }
+        if (header_end > header &&
+            (append(buffer, size, &len, header, (size_t)(header_end - header)) < 0 ||
+             append(buffer, size, &len, "\r\n", 2) < 0))
+        {
+            return -1;
+        }
+        header = header_end + 1;
+    }
+
+    if (append(buffer, size, &len, "\r\n", 2) < 0)
+    {
+        return -1;
+    }
+    buffer[len] = '\0';
+    return (int)len;
+}
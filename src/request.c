@@ -2,6 +2,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "request.h"
+#include "hpack.h"
 
 int build_request(Arguments *args, HTTPRequest *request)
 {
@@ -24,11 +25,19 @@ int build_request(Arguments *args, HTTPRequest *request)
     }
 
     // HTTP method "OPTIONS" and "TRACE" have been supported since http 1.1
-    if ((METHOD_OPTIONS == args->method || METHOD_TRACE == args->method) && (args->http10 != HTTP_VERSION_1_1))
+    if ((METHOD_OPTIONS == args->method || METHOD_TRACE == args->method) && (args->http10 < HTTP_VERSION_1_1))
     {
         args->http10 = HTTP_VERSION_1_1;
     }
 
+    // HTTP/2 sends the request as HPACK encoded headers, which are built only once here and shared by all streams.
+    if (HTTP_VERSION_2 == args->http10)
+    {
+        snprintf(request->host, sizeof(request->host), "%s", args->target_host);
+        request->h2_header_block_len = hpack_encode_request(args, request->h2_header_block, sizeof(request->h2_header_block));
+        return request->h2_header_block_len > 0 ? 0 : -1;
+    }
+
     // Construct the first line of the HTTP request body: add http method.
     switch (args->method)
     {
@@ -49,7 +58,19 @@ int build_request(Arguments *args, HTTPRequest *request)
     }
 
     // Construct the first line of the HTTP request body: append the hostname.
-    if (0 == strlen(args->proxy_host))
+    if (strlen(args->path_template) > 0 || strlen(args->replay_file) > 0)
+    {
+        // The placeholders are kept in the body, and rendered for each request. A replayed path is put after the prefix.
+        if (strlen(args->proxy_host) > 0)
+        {
+            snprintf(port_str, sizeof(port_str), ":%d", args->target_port);
+            strncat(request->body, PROTOCOL_HTTPS == args->protocol ? "https://" : "http://", sizeof(request->body) - strlen(request->body) - 1);
+            strncat(request->body, args->target_host, sizeof(request->body) - strlen(request->body) - 1);
+            strncat(request->body, port_str, sizeof(request->body) - strlen(request->body) - 1);
+        }
+        strncat(request->body, args->path_template, sizeof(request->body) - strlen(request->body) - 1);
+    }
+    else if (0 == strlen(args->proxy_host))
     {
         // If no proxy specified, then the hostname in the first line is '/'.
         strncat(request->body, "/", sizeof(request->body) - strlen(request->body) - 1);
@@ -101,8 +122,12 @@ int build_request(Arguments *args, HTTPRequest *request)
         }
     }
 
-    // If the HTTP version is 1.1, set 'Connection: close' to header.
-    if (HTTP_VERSION_1_1 == args->http10)
+    // If the HTTP version is 1.1, set 'Connection: close' to header, unless the proxy tunnel is reused across requests.
+    if (HTTP_VERSION_1_1 == args->http10 && args->reuse_tunnel)
+    {
+        strncat(request->body, "Connection: keep-alive\r\n", sizeof(request->body) - strlen(request->body) - 1);
+    }
+    else if (HTTP_VERSION_1_1 == args->http10)
     {
         strncat(request->body, "Connection: close\r\n", sizeof(request->body) - strlen(request->body) - 1);
     }
@@ -113,5 +138,15 @@ int build_request(Arguments *args, HTTPRequest *request)
         strncat(request->body, "\r\n", sizeof(request->body) - strlen(request->body) - 1);
     }
 
+    if (strlen(args->path_template) > 0)
+    {
+        int placeholders = template_compile(&request->request_template, request->body);
+        if (placeholders < 0)
+        {
+            return -1;
+        }
+        request->templated = (placeholders > 0);
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "resolver.h"
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "timing.h"
+
+/**
+ * Queue the entry for the thread, called with the lock held.
+ */
+static void enqueue_entry(Resolver *resolver, int index)
+{
+    DnsEntry *entry = &resolver->entries[index];
+    if (entry->queued)
+    {
+        return;
+    }
+    entry->queued = true;
+    resolver->queue[(resolver->queue_head + resolver->queue_len) % MAX_DNS_ENTRIES] = index;
+    resolver->queue_len++;
+    pthread_cond_signal(&resolver->cond);
+}
+
+static void resolve_entry(Resolver *resolver, int index)
+{
+    char host[DNS_HOST_LEN];
+    char port_str[16];
+    struct addrinfo hints = {
+        .ai_family = AF_INET,       // IP v4
+        .ai_socktype = SOCK_STREAM, // TCP
+        .ai_flags = 0,
+        .ai_protocol = 0
+    };
+    struct addrinfo *result = NULL;
+    DnsAddresses addresses;
+
+    pthread_mutex_lock(&resolver->lock);
+    snprintf(host, sizeof(host), "%s", resolver->entries[index].host);
+    snprintf(port_str, sizeof(port_str), "%d", resolver->entries[index].port);
+    pthread_mutex_unlock(&resolver->lock);
+
+    int ret = getaddrinfo(host, port_str, &hints, &result);
+    addresses.count = 0;
+    if (0 == ret)
+    {
+        for (struct addrinfo *rp = result; rp != NULL && addresses.count < MAX_DNS_ADDRS; rp = rp->ai_next)
+        {
+            memcpy(&addresses.addrs[addresses.count], rp->ai_addr, rp->ai_addrlen);
+            addresses.addr_lens[addresses.count] = rp->ai_addrlen;
+            addresses.count++;
+        }
+        freeaddrinfo(result);
+    }
+
+    pthread_mutex_lock(&resolver->lock);
+    DnsEntry *entry = &resolver->entries[index];
+    uint64_t now_ns = get_monotonic_ns();
+    entry->queued = false;
+    entry->error = ret;
+    if (0 == ret && addresses.count > 0)
+    {
+        entry->addresses = addresses;
+        entry->state = DNS_READY;
+        entry->expires_ns = now_ns + resolver->ttl_ns;
+    }
+    else if (DNS_READY == entry->state)
+    {
+        // A failed refresh keeps the known addresses, and is retried soon.
+        entry->expires_ns = now_ns + DNS_NEGATIVE_TTL_NS;
+    }
+    else
+    {
+        entry->state = DNS_FAILED;
+        entry->expires_ns = now_ns + DNS_NEGATIVE_TTL_NS;
+    }
+    pthread_mutex_unlock(&resolver->lock);
+
+    uint64_t one = 1;
+    if (write(resolver->event_fd, &one, sizeof(one)) < 0)
+    {
+        perror("Failed to signal the resolved name");
+    }
+}
+
+static void *run_resolver(void *arg)
+{
+    Resolver *resolver = (Resolver *) arg;
+
+    pthread_mutex_lock(&resolver->lock);
+    while (!resolver->stopping)
+    {
+        if (0 == resolver->queue_len)
+        {
+            pthread_cond_wait(&resolver->cond, &resolver->lock);
+            continue;
+        }
+        int index = resolver->queue[resolver->queue_head];
+        resolver->queue_head = (resolver->queue_head + 1) % MAX_DNS_ENTRIES;
+        resolver->queue_len--;
+
+        pthread_mutex_unlock(&resolver->lock);
+        resolve_entry(resolver, index);
+        pthread_mutex_lock(&resolver->lock);
+    }
+    pthread_mutex_unlock(&resolver->lock);
+    return NULL;
+}
+
+int resolver_init(Resolver *resolver, int ttl_seconds)
+{
+    memset(resolver, 0, sizeof(*resolver));
+    resolver->ttl_ns = (uint64_t)ttl_seconds * 1000000000ull;
+    resolver->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (resolver->event_fd < 0)
+    {
+        perror("Failed to create the eventfd of the resolver");
+        return -1;
+    }
+
+    pthread_mutex_init(&resolver->lock, NULL);
+    pthread_cond_init(&resolver->cond, NULL);
+    int ret = pthread_create(&resolver->thread, NULL, run_resolver, resolver);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Failed to start the resolver thread: %s\n", strerror(ret));
+        close(resolver->event_fd);
+        resolver->event_fd = -1;
+        return -1;
+    }
+    resolver->started = true;
+    return 1;
+}
+
+void resolver_free(Resolver *resolver)
+{
+    if (resolver->started)
+    {
+        pthread_mutex_lock(&resolver->lock);
+        resolver->stopping = true;
+        pthread_cond_signal(&resolver->cond);
+        pthread_mutex_unlock(&resolver->lock);
+        pthread_join(resolver->thread, NULL);
+        resolver->started = false;
+    }
+    if (resolver->event_fd >= 0)
+    {
+        close(resolver->event_fd);
+        resolver->event_fd = -1;
+    }
+    pthread_mutex_destroy(&resolver->lock);
+    pthread_cond_destroy(&resolver->cond);
+}
+
+int resolver_lookup(Resolver *resolver, const char *host, int port, uint64_t now_ns, DnsAddresses *addresses, int *error)
+{
+    int result = 0;
+
+    if (strlen(host) >= DNS_HOST_LEN)
+    {
+        *error = EAI_NONAME;
+        return -1;
+    }
+
+    pthread_mutex_lock(&resolver->lock);
+    int index = -1;
+    for (int i = 0; i < resolver->entries_count; i++)
+    {
+        if (resolver->entries[i].port == port && 0 == strcmp(resolver->entries[i].host, host))
+        {
+            index = i;
+            break;
+        }
+    }
+
+    if (index < 0)
+    {
+        if (resolver->entries_count >= MAX_DNS_ENTRIES)
+        {
+            pthread_mutex_unlock(&resolver->lock);
+            fprintf(stderr, "Too many hosts to resolve, at most %d.\n", MAX_DNS_ENTRIES);
+            *error = EAI_MEMORY;
+            return -1;
+        }
+        index = resolver->entries_count++;
+        DnsEntry *entry = &resolver->entries[index];
+        memset(entry, 0, sizeof(*entry));
+        snprintf(entry->host, sizeof(entry->host), "%s", host);
+        entry->port = port;
+        entry->state = DNS_RESOLVING;
+        enqueue_entry(resolver, index);
+        pthread_mutex_unlock(&resolver->lock);
+        return 0;
+    }
+
+    DnsEntry *entry = &resolver->entries[index];
+    switch (entry->state)
+    {
+    case DNS_READY:
+        // An expired entry is still used until the refresh completes.
+        *addresses = entry->addresses;
+        result = 1;
+        break;
+    case DNS_FAILED:
+        *error = entry->error;
+        result = -1;
+        break;
+    default:
+        break;
+    }
+    if (DNS_RESOLVING != entry->state && now_ns >= entry->expires_ns)
+    {
+        enqueue_entry(resolver, index);
+        if (DNS_FAILED == entry->state)
+        {
+            // The failure is retried as a first lookup.
+            entry->state = DNS_RESOLVING;
+            result = 0;
+        }
+    }
+    pthread_mutex_unlock(&resolver->lock);
+    return result;
+}
+
+void resolver_drain(Resolver *resolver)
+{
+    uint64_t count;
+    if (read(resolver->event_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    {
+        perror("Failed to read the eventfd of the resolver");
+    }
+}
+
+bool resolver_busy(Resolver *resolver)
+{
+    bool busy = false;
+    pthread_mutex_lock(&resolver->lock);
+    for (int i = 0; i < resolver->entries_count; i++)
+    {
+        if (DNS_RESOLVING == resolver->entries[i].state)
+        {
+            busy = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&resolver->lock);
+    return busy;
+}
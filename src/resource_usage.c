@@ -0,0 +1,181 @@
+#include "resource_usage.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static uint64_t timeval_ns(struct timeval value)
+{
+    return (uint64_t)value.tv_sec * 1000000000ull + (uint64_t)value.tv_usec * 1000ull;
+}
+
+/**
+ * Get the high water mark of the resident set of the process.
+ *
+ * RETURNS:
+ *      The peak RSS in KB, 0 if /proc is not mounted.
+ */
+static uint64_t read_peak_rss_kb(void)
+{
+    FILE *status = fopen("/proc/self/status", "r");
+    if (NULL == status)
+    {
+        return 0;
+    }
+    char line[256];
+    uint64_t peak_kb = 0;
+    while (fgets(line, sizeof(line), status) != NULL)
+    {
+        if (1 == sscanf(line, "VmHWM: %" SCNu64 " kB", &peak_kb))
+        {
+            break;
+        }
+    }
+    fclose(status);
+    return peak_kb;
+}
+
+static uint64_t read_counter(int fd)
+{
+    uint64_t value = 0;
+    if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value))
+    {
+        return 0;
+    }
+    return value;
+}
+
+int resource_usage_read(ResourceUsage *usage, const PerfCounters *counters)
+{
+    struct rusage rusage;
+    memset(usage, 0, sizeof(ResourceUsage));
+    if (getrusage(RUSAGE_THREAD, &rusage) < 0)
+    {
+        perror("getrusage");
+        return -1;
+    }
+    usage->user_ns = timeval_ns(rusage.ru_utime);
+    usage->sys_ns = timeval_ns(rusage.ru_stime);
+    usage->voluntary_switches = rusage.ru_nvcsw;
+    usage->involuntary_switches = rusage.ru_nivcsw;
+    usage->minor_faults = rusage.ru_minflt;
+    usage->major_faults = rusage.ru_majflt;
+
+    // Without /proc the peak RSS of getrusage() is the same figure.
+    usage->peak_rss_kb = read_peak_rss_kb();
+    if (0 == usage->peak_rss_kb)
+    {
+        usage->peak_rss_kb = rusage.ru_maxrss;
+    }
+
+    if (counters != NULL)
+    {
+        usage->cycles = read_counter(counters->cycles_fd);
+        usage->instructions = read_counter(counters->instructions_fd);
+    }
+    return 1;
+}
+
+void resource_usage_since(ResourceUsage *usage, const ResourceUsage *start)
+{
+    usage->user_ns -= start->user_ns;
+    usage->sys_ns -= start->sys_ns;
+    usage->voluntary_switches -= start->voluntary_switches;
+    usage->involuntary_switches -= start->involuntary_switches;
+    usage->minor_faults -= start->minor_faults;
+    usage->major_faults -= start->major_faults;
+    usage->cycles -= start->cycles;
+    usage->instructions -= start->instructions;
+}
+
+void resource_usage_add(ResourceUsage *total, const ResourceUsage *usage)
+{
+    total->user_ns += usage->user_ns;
+    total->sys_ns += usage->sys_ns;
+    total->voluntary_switches += usage->voluntary_switches;
+    total->involuntary_switches += usage->involuntary_switches;
+    total->minor_faults += usage->minor_faults;
+    total->major_faults += usage->major_faults;
+    total->cycles += usage->cycles;
+    total->instructions += usage->instructions;
+    if (usage->peak_rss_kb > total->peak_rss_kb)
+    {
+        total->peak_rss_kb = usage->peak_rss_kb;
+    }
+}
+
+void resource_usage_print(const ResourceUsage *usage, const char *name, double elapsed_seconds, uint64_t requests,
+                          FILE *stream)
+{
+    uint64_t cpu_ns = usage->user_ns + usage->sys_ns;
+    fprintf(stream, "%s: user=[%.3fs], sys=[%.3fs], cpu=[%.1f%%], voluntary switches=[%" PRIu64 "], "
+                    "involuntary switches=[%" PRIu64 "], minor faults=[%" PRIu64 "], major faults=[%" PRIu64 "], "
+                    "peak RSS=[%" PRIu64 "KB], cpu per request=[%.3fus].\n",
+            name, usage->user_ns / 1e9, usage->sys_ns / 1e9,
+            elapsed_seconds > 0 ? cpu_ns / 1e7 / elapsed_seconds : 0.0,
+            usage->voluntary_switches, usage->involuntary_switches, usage->minor_faults, usage->major_faults,
+            usage->peak_rss_kb, requests > 0 ? cpu_ns / 1e3 / requests : 0.0);
+    if (usage->cycles > 0)
+    {
+        fprintf(stream, "%s: cycles=[%" PRIu64 "], instructions=[%" PRIu64 "], IPC=[%.2f], cycles per request=[%.0f], "
+                        "instructions per request=[%.0f].\n",
+                name, usage->cycles, usage->instructions, (double)usage->instructions / usage->cycles,
+                requests > 0 ? (double)usage->cycles / requests : 0.0,
+                requests > 0 ? (double)usage->instructions / requests : 0.0);
+    }
+}
+
+/**
+ * Open a hardware counter of the calling thread on any CPU.
+ * The kernel is only counted if perf_event_paranoid allows it, the user space otherwise.
+ *
+ * RETURNS:
+ *      The file descriptor of the counter, -1 if it can't be opened.
+ */
+static int open_counter(uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.exclude_hv = 1;
+
+    int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0 && (EACCES == errno || EPERM == errno))
+    {
+        attr.exclude_kernel = 1;
+        fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+int perf_counters_open(PerfCounters *counters)
+{
+    counters->cycles_fd = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+    counters->instructions_fd = counters->cycles_fd < 0 ? -1 : open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+    if (counters->instructions_fd < 0)
+    {
+        perf_counters_close(counters);
+        return -1;
+    }
+    return 1;
+}
+
+void perf_counters_close(PerfCounters *counters)
+{
+    if (counters->cycles_fd >= 0)
+    {
+        close(counters->cycles_fd);
+    }
+    if (counters->instructions_fd >= 0)
+    {
+        close(counters->instructions_fd);
+    }
+    counters->cycles_fd = -1;
+    counters->instructions_fd = -1;
+}
@@ -0,0 +1,249 @@
+#include "response.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define HEADER_VALUE_LEN 64
+
+void response_parser_init(HTTPResponseParser *parser, bool head_request, bool hash_body)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->state = RESPONSE_HEADERS;
+    parser->head_request = head_request;
+    parser->hash_body = hash_body;
+    body_hash_init(&parser->body_hash);
+}
+
+void response_parser_reset(HTTPResponseParser *parser)
+{
+    response_parser_init(parser, parser->head_request, parser->hash_body);
+}
+
+/**
+ * Check if the header line starts with the given name followed by ':', and copy its trimmed value.
+ */
+static bool get_header_value(const char *line, size_t line_len, const char *name, char *value, size_t value_size)
+{
+    size_t name_len = strlen(name);
+    if (line_len <= name_len || line[name_len] != ':' || strncasecmp(line, name, name_len) != 0)
+    {
+        return false;
+    }
+
+    const char *start = line + name_len + 1;
+    const char *end = line + line_len;
+    while (start < end && (*start == ' ' || *start == '\t'))
+    {
+        start++;
+    }
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t'))
+    {
+        end--;
+    }
+
+    size_t len = (size_t)(end - start);
+    if (len >= value_size)
+    {
+        len = value_size - 1;
+    }
+    memcpy(value, start, len);
+    value[len] = '\0';
+    return true;
+}
+
+int response_parse_headers(HTTPResponseParser *parser, const char *buf, size_t len)
+{
+    char value[HEADER_VALUE_LEN];
+    bool chunked = false;
+    bool has_length = false;
+    uint64_t content_length = 0;
+
+    const char *headers_end = memmem(buf, len, "\r\n\r\n", 4);
+    if (NULL == headers_end)
+    {
+        return 0;
+    }
+
+    // Status line: "HTTP/1.x NNN reason".
+    if (len < 12 || strncmp(buf, "HTTP/1.", 7) != 0 || buf[8] != ' ')
+    {
+        return -1;
+    }
+    parser->keep_alive = (buf[7] == '1');
+    parser->status_code = (int)strtol(buf + 9, NULL, 10);
+    if (parser->status_code < 100 || parser->status_code > 999)
+    {
+        return -1;
+    }
+
+    // Walk the header lines, the one ending at headers_end is the last.
+    const char *line = strstr(buf, "\r\n") + 2;
+    while (line < headers_end + 2)
+    {
+        const char *line_end = memmem(line, (size_t)(headers_end + 2 - line), "\r\n", 2);
+        size_t line_len = (size_t)(line_end - line);
+
+        if (get_header_value(line, line_len, "Content-Length", value, sizeof(value)))
+        {
+            char *endptr = NULL;
+            content_length = strtoull(value, &endptr, 10);
+            if (endptr == value)
+            {
+                return -1;
+            }
+            has_length = true;
+        }
+        else if (get_header_value(line, line_len, "Transfer-Encoding", value, sizeof(value)))
+        {
+            chunked = (strcasestr(value, "chunked") != NULL);
+        }
+        else if (get_header_value(line, line_len, "Connection", value, sizeof(value)))
+        {
+            if (strcasestr(value, "close"))
+            {
+                parser->keep_alive = false;
+            }
+            else if (strcasestr(value, "keep-alive"))
+            {
+                parser->keep_alive = true;
+            }
+        }
+        line = line_end + 2;
+    }
+
+    parser->header_bytes = (size_t)(headers_end - buf) + 4;
+
+    // Decide how the body is delimited (RFC 7230 3.3.3).
+    if (parser->head_request || parser->status_code < 200 || 204 == parser->status_code || 304 == parser->status_code)
+    {
+        parser->state = RESPONSE_COMPLETE;
+    }
+    else if (chunked)
+    {
+        parser->state = RESPONSE_CHUNK_SIZE;
+    }
+    else if (has_length)
+    {
+        parser->remaining = content_length;
+        parser->state = (0 == content_length) ? RESPONSE_COMPLETE : RESPONSE_BODY_LENGTH;
+    }
+    else
+    {
+        parser->state = RESPONSE_BODY_UNTIL_CLOSE;
+        parser->keep_alive = false;
+    }
+
+    return (int)parser->header_bytes;
+}
+
+ssize_t response_consume_body(HTTPResponseParser *parser, const char *data, size_t len)
+{
+    size_t offset = 0;
+
+    while (offset < len && parser->state != RESPONSE_COMPLETE)
+    {
+        size_t n;
+        char c;
+
+        switch (parser->state)
+        {
+        case RESPONSE_BODY_LENGTH:
+        case RESPONSE_CHUNK_DATA:
+            n = len - offset;
+            if (n > parser->remaining)
+            {
+                n = (size_t)parser->remaining;
+            }
+            if (parser->hash_body)
+            {
+                body_hash_update(&parser->body_hash, data + offset, n);
+            }
+            offset += n;
+            parser->remaining -= n;
+            parser->body_bytes += n;
+            if (0 == parser->remaining)
+            {
+                parser->state = (RESPONSE_BODY_LENGTH == parser->state) ? RESPONSE_COMPLETE : RESPONSE_CHUNK_DATA_END;
+            }
+            break;
+        case RESPONSE_BODY_UNTIL_CLOSE:
+            if (parser->hash_body)
+            {
+                body_hash_update(&parser->body_hash, data + offset, len - offset);
+            }
+            parser->body_bytes += len - offset;
+            offset = len;
+            break;
+        case RESPONSE_CHUNK_SIZE:
+            c = data[offset++];
+            if (c != '\n')
+            {
+                if (parser->chunk_line_len >= sizeof(parser->chunk_line) - 1)
+                {
+                    return -1;
+                }
+                parser->chunk_line[parser->chunk_line_len++] = c;
+                break;
+            }
+
+            // The size is in hex, chunk extensions after ';' are ignored.
+            parser->chunk_line[parser->chunk_line_len] = '\0';
+            char *endptr = NULL;
+            parser->remaining = strtoull(parser->chunk_line, &endptr, 16);
+            if (endptr == parser->chunk_line)
+            {
+                return -1;
+            }
+            parser->chunk_line_len = 0;
+            if (0 == parser->remaining)
+            {
+                parser->trailer_line_len = 0;
+                parser->state = RESPONSE_TRAILERS;
+            }
+            else
+            {
+                parser->state = RESPONSE_CHUNK_DATA;
+            }
+            break;
+        case RESPONSE_CHUNK_DATA_END:
+            if (data[offset++] == '\n')
+            {
+                parser->state = RESPONSE_CHUNK_SIZE;
+            }
+            break;
+        case RESPONSE_TRAILERS:
+            // The trailers end with an empty line.
+            c = data[offset++];
+            if (c == '\n')
+            {
+                if (0 == parser->trailer_line_len)
+                {
+                    parser->state = RESPONSE_COMPLETE;
+                }
+                parser->trailer_line_len = 0;
+            }
+            else if (c != '\r')
+            {
+                parser->trailer_line_len++;
+            }
+            break;
+        default:
+            return -1;
+        }
+    }
+
+    return (ssize_t)offset;
+}
+
+void response_connection_closed(HTTPResponseParser *parser)
+{
+    if (RESPONSE_BODY_UNTIL_CLOSE == parser->state)
+    {
+        parser->state = RESPONSE_COMPLETE;
+    }
+}
+
+bool response_is_complete(const HTTPResponseParser *parser)
+{
+    return RESPONSE_COMPLETE == parser->state;
+}
@@ -0,0 +1,466 @@
+#include "results.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESULTS_KEY_LEN 64
+
+void results_init(BenchResults *results, const Arguments *args, uint64_t start_ns)
+{
+    memset(results, 0, sizeof(*results));
+    snprintf(results->url, sizeof(results->url), "%s", args->url);
+    results->clients = args->clients;
+    results->procs = args->procs > 1 ? args->procs : 1;
+    results->sample_seconds = RESULT_SAMPLE_NS / 1e9;
+    results->sampled_ns = start_ns;
+}
+
+void results_sample(BenchResults *results, uint64_t completed, uint64_t now_ns)
+{
+    if (now_ns < results->sampled_ns + RESULT_SAMPLE_NS)
+    {
+        return;
+    }
+
+    // Counters going back were started over after the warm-up, so are the samples.
+    if (completed < results->sampled_requests)
+    {
+        results->samples_count = 0;
+        results->sampled_requests = 0;
+    }
+
+    uint64_t periods = (now_ns - results->sampled_ns) / RESULT_SAMPLE_NS;
+    uint64_t requests = completed - results->sampled_requests;
+    for (uint64_t i = 0; i < periods && results->samples_count < MAX_RESULT_SAMPLES; i++)
+    {
+        results->samples[results->samples_count++] = requests / periods + (i + 1 == periods ? requests % periods : 0);
+    }
+    results->sampled_requests = completed;
+    results->sampled_ns += periods * RESULT_SAMPLE_NS;
+}
+
+/**
+ * Write the string quoted, with the characters JSON needs escaped.
+ */
+static void write_json_string(FILE *file, const char *value)
+{
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char *) value; *p != '\0'; p++)
+    {
+        if ('"' == *p || '\\' == *p)
+        {
+            fprintf(file, "\\%c", *p);
+        }
+        else if (*p < 0x20)
+        {
+            fprintf(file, "\\u%04x", *p);
+        }
+        else
+        {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+int results_write(const BenchResults *results, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (NULL == file)
+    {
+        fprintf(stderr, "Failed to open the results file [%s]: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    const Histogram *latency = &results->latency;
+    fprintf(file, "{\n  \"version\": %d,\n  \"url\": ", RESULTS_VERSION);
+    write_json_string(file, results->url);
+    fprintf(file, ",\n  \"clients\": %d,\n  \"procs\": %d,\n  \"duration_seconds\": %.6f,\n",
+            results->clients, results->procs, results->duration_seconds);
+    fprintf(file, "  \"requests\": %llu,\n  \"failed\": %llu,\n  \"header_bytes\": %llu,\n  \"payload_bytes\": %llu,\n  \"mismatched\": %llu,\n",
+            (unsigned long long)results->requests, (unsigned long long)results->failed,
+            (unsigned long long)results->header_bytes, (unsigned long long)results->payload_bytes,
+            (unsigned long long)results->mismatched);
+
+    // The summary is only for reading, the comparison works on the samples and the histogram.
+    fprintf(file, "  \"throughput\": %.3f,\n", results->duration_seconds > 0 ? results->requests / results->duration_seconds : 0.0);
+    fprintf(file, "  \"latency_p50_ms\": %.3f,\n  \"latency_p90_ms\": %.3f,\n  \"latency_p99_ms\": %.3f,\n  \"latency_p999_ms\": %.3f,\n",
+            histogram_percentile(latency, 50) / 1e6, histogram_percentile(latency, 90) / 1e6,
+            histogram_percentile(latency, 99) / 1e6, histogram_percentile(latency, 99.9) / 1e6);
+
+    fprintf(file, "  \"latency_count\": %llu,\n  \"latency_min_ns\": %llu,\n  \"latency_max_ns\": %llu,\n  \"latency_sum_ns\": %llu,\n",
+            (unsigned long long)latency->total_count, (unsigned long long)latency->min,
+            (unsigned long long)latency->max, (unsigned long long)latency->sum);
+
+    // Only the buckets with values, as pairs of the index and the count.
+    fprintf(file, "  \"latency_buckets\": [");
+    bool first = true;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        if (latency->counts[i] > 0)
+        {
+            fprintf(file, "%s%d, %llu", first ? "" : ", ", i, (unsigned long long)latency->counts[i]);
+            first = false;
+        }
+    }
+    fprintf(file, "],\n  \"sample_seconds\": %.3f,\n  \"samples\": [", results->sample_seconds);
+    for (int i = 0; i < results->samples_count; i++)
+    {
+        fprintf(file, "%s%llu", i > 0 ? ", " : "", (unsigned long long)results->samples[i]);
+    }
+    fprintf(file, "]\n}\n");
+
+    if (ferror(file) || fclose(file) != 0)
+    {
+        fprintf(stderr, "Failed to write the results file [%s].\n", path);
+        return -1;
+    }
+    return 1;
+}
+
+typedef struct
+{
+    const char *p;
+    const char *end;
+} JsonCursor;
+
+typedef struct
+{
+    BenchResults *results;
+    int bucket_index;       // The index of the latency bucket whose count comes next.
+} ResultsParser;
+
+static void skip_space(JsonCursor *cursor)
+{
+    while (cursor->p < cursor->end && isspace((unsigned char) *cursor->p))
+    {
+        cursor->p++;
+    }
+}
+
+/**
+ * Consume the character if it's the next one after the spaces.
+ */
+static bool accept_char(JsonCursor *cursor, char c)
+{
+    skip_space(cursor);
+    if (cursor->p < cursor->end && *cursor->p == c)
+    {
+        cursor->p++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Parse a string into value, only the escapes results_write() uses are decoded, others are kept as they are.
+ */
+static int parse_string(JsonCursor *cursor, char *value, size_t size)
+{
+    size_t len = 0;
+    if (!accept_char(cursor, '"'))
+    {
+        return -1;
+    }
+    while (cursor->p < cursor->end && *cursor->p != '"')
+    {
+        char c = *cursor->p++;
+        if ('\\' == c && cursor->p < cursor->end)
+        {
+            c = *cursor->p++;
+            if ('u' == c && cursor->end - cursor->p >= 4)
+            {
+                char hex[5] = {cursor->p[0], cursor->p[1], cursor->p[2], cursor->p[3], '\0'};
+                c = (char) strtol(hex, NULL, 16);
+                cursor->p += 4;
+            }
+        }
+        if (len + 1 >= size)
+        {
+            return -1;
+        }
+        value[len++] = c;
+    }
+    value[len] = '\0';
+    return accept_char(cursor, '"') ? 1 : -1;
+}
+
+/**
+ * Parse a number, as an integer too when it's one, since counts may be beyond the precision of a double.
+ */
+static int parse_number(JsonCursor *cursor, double *value, uint64_t *integer)
+{
+    char text[64];
+    size_t len = 0;
+
+    skip_space(cursor);
+    while (cursor->p < cursor->end && *cursor->p != '\0' && (isdigit((unsigned char) *cursor->p) || strchr("+-.eE", *cursor->p)))
+    {
+        if (len + 1 >= sizeof(text))
+        {
+            return -1;
+        }
+        text[len++] = *cursor->p++;
+    }
+    text[len] = '\0';
+
+    char *endptr = NULL;
+    *value = strtod(text, &endptr);
+    if (0 == len || *endptr != '\0')
+    {
+        return -1;
+    }
+    *integer = strspn(text, "0123456789") == len ? strtoull(text, NULL, 10) : (uint64_t) (*value > 0 ? *value : 0);
+    return 1;
+}
+
+/**
+ * Parse an array of numbers, handing each one to the callback with its position.
+ */
+static int parse_array(JsonCursor *cursor, int (*on_item)(ResultsParser *, int, uint64_t), ResultsParser *parser)
+{
+    double value;
+    uint64_t integer;
+
+    if (!accept_char(cursor, '['))
+    {
+        return -1;
+    }
+    if (accept_char(cursor, ']'))
+    {
+        return 1;
+    }
+    for (int i = 0; ; i++)
+    {
+        if (parse_number(cursor, &value, &integer) < 0 || (on_item != NULL && on_item(parser, i, integer) < 0))
+        {
+            return -1;
+        }
+        if (accept_char(cursor, ']'))
+        {
+            return 1;
+        }
+        if (!accept_char(cursor, ','))
+        {
+            return -1;
+        }
+    }
+}
+
+/**
+ * The buckets are pairs of the index and the count.
+ */
+static int on_latency_bucket(ResultsParser *parser, int position, uint64_t value)
+{
+    if (0 == position % 2)
+    {
+        if (value >= HISTOGRAM_BUCKETS)
+        {
+            return -1;
+        }
+        parser->bucket_index = (int)value;
+        return 1;
+    }
+    parser->results->latency.counts[parser->bucket_index] = value;
+    return 1;
+}
+
+static int on_sample(ResultsParser *parser, int position, uint64_t value)
+{
+    if (position >= MAX_RESULT_SAMPLES)
+    {
+        return -1;
+    }
+    parser->results->samples[position] = value;
+    parser->results->samples_count = position + 1;
+    return 1;
+}
+
+/**
+ * Skip the value of a key which isn't read, only the kinds results_write() writes are expected.
+ */
+static int skip_value(JsonCursor *cursor)
+{
+    char text[MAX_URL_LEN];
+    double value;
+    uint64_t integer;
+
+    skip_space(cursor);
+    if (cursor->p >= cursor->end)
+    {
+        return -1;
+    }
+    if ('"' == *cursor->p)
+    {
+        return parse_string(cursor, text, sizeof(text));
+    }
+    if ('[' == *cursor->p)
+    {
+        return parse_array(cursor, NULL, NULL);
+    }
+    return parse_number(cursor, &value, &integer);
+}
+
+static int parse_results(JsonCursor *cursor, BenchResults *results)
+{
+    char key[RESULTS_KEY_LEN];
+    double value;
+    uint64_t integer;
+    int version = 0;
+    ResultsParser parser = {results, 0};
+    const struct
+    {
+        const char *key;
+        uint64_t *field;
+    } counters[] = {
+        {"requests", &results->requests},
+        {"failed", &results->failed},
+        {"header_bytes", &results->header_bytes},
+        {"payload_bytes", &results->payload_bytes},
+        {"mismatched", &results->mismatched},
+        {"latency_count", &results->latency.total_count},
+        {"latency_min_ns", &results->latency.min},
+        {"latency_max_ns", &results->latency.max},
+        {"latency_sum_ns", &results->latency.sum},
+    };
+
+    if (!accept_char(cursor, '{'))
+    {
+        return -1;
+    }
+    if (accept_char(cursor, '}'))
+    {
+        return -1;
+    }
+    while (true)
+    {
+        if (parse_string(cursor, key, sizeof(key)) < 0 || !accept_char(cursor, ':'))
+        {
+            return -1;
+        }
+
+        int ret;
+        if (0 == strcmp(key, "url"))
+        {
+            ret = parse_string(cursor, results->url, sizeof(results->url));
+        }
+        else if (0 == strcmp(key, "latency_buckets"))
+        {
+            ret = parse_array(cursor, on_latency_bucket, &parser);
+        }
+        else if (0 == strcmp(key, "samples"))
+        {
+            ret = parse_array(cursor, on_sample, &parser);
+        }
+        else
+        {
+            skip_space(cursor);
+            bool is_number = cursor->p < cursor->end && (isdigit((unsigned char) *cursor->p) || '-' == *cursor->p);
+            ret = is_number ? parse_number(cursor, &value, &integer) : skip_value(cursor);
+            if (ret > 0 && is_number)
+            {
+                for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+                {
+                    if (0 == strcmp(key, counters[i].key))
+                    {
+                        *counters[i].field = integer;
+                    }
+                }
+                if (0 == strcmp(key, "version"))
+                {
+                    version = (int)integer;
+                }
+                else if (0 == strcmp(key, "clients"))
+                {
+                    results->clients = (int)integer;
+                }
+                else if (0 == strcmp(key, "procs"))
+                {
+                    results->procs = (int)integer;
+                }
+                else if (0 == strcmp(key, "duration_seconds"))
+                {
+                    results->duration_seconds = value;
+                }
+                else if (0 == strcmp(key, "sample_seconds"))
+                {
+                    results->sample_seconds = value;
+                }
+            }
+        }
+        if (ret < 0)
+        {
+            fprintf(stderr, "Malformed value of [%s].\n", key);
+            return -1;
+        }
+
+        if (accept_char(cursor, '}'))
+        {
+            break;
+        }
+        if (!accept_char(cursor, ','))
+        {
+            return -1;
+        }
+    }
+
+    if (version != RESULTS_VERSION)
+    {
+        fprintf(stderr, "Unsupported results version [%d].\n", version);
+        return -1;
+    }
+    return 1;
+}
+
+int results_read(BenchResults *results, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (NULL == file)
+    {
+        fprintf(stderr, "Failed to open the results file [%s]: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    size_t capacity = 65536;
+    size_t len = 0;
+    char *text = (char *) malloc(capacity);
+    while (text != NULL)
+    {
+        len += fread(text + len, 1, capacity - len, file);
+        if (len < capacity)
+        {
+            break;
+        }
+        char *grown = (char *) realloc(text, capacity * 2);
+        if (NULL == grown)
+        {
+            free(text);
+            text = NULL;
+            break;
+        }
+        text = grown;
+        capacity *= 2;
+    }
+    bool read_error = ferror(file);
+    fclose(file);
+    if (NULL == text || read_error)
+    {
+        fprintf(stderr, "Failed to read the results file [%s].\n", path);
+        free(text);
+        return -1;
+    }
+
+    memset(results, 0, sizeof(*results));
+    JsonCursor cursor = {text, text + len};
+    int ret = parse_results(&cursor, results);
+    free(text);
+    if (ret < 0)
+    {
+        fprintf(stderr, "The results file [%s] is malformed.\n", path);
+        return -1;
+    }
+    return 1;
+}
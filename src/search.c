@@ -0,0 +1,77 @@
+#include "search.h"
+
+void search_init(ThroughputSearch *search, int max_connections, uint64_t slo_p99_ns)
+{
+    search->slo_p99_ns = slo_p99_ns;
+    search->passed_connections = 0;
+    search->failed_connections = max_connections + 1;
+    search->current = max_connections;
+    search->probes_count = 0;
+}
+
+int search_record(ThroughputSearch *search, uint64_t completed, double seconds, uint64_t p99_ns)
+{
+    bool passed = completed > 0 && p99_ns <= search->slo_p99_ns;
+
+    if (search->probes_count < MAX_SEARCH_PROBES)
+    {
+        SearchProbe *probe = &search->probes[search->probes_count++];
+        probe->connections = search->current;
+        probe->throughput = seconds > 0 ? (double)completed / seconds : 0;
+        probe->p99_ns = p99_ns;
+        probe->passed = passed;
+    }
+
+    if (passed)
+    {
+        search->passed_connections = search->current;
+    }
+    else
+    {
+        search->failed_connections = search->current;
+    }
+
+    if (search->failed_connections - search->passed_connections <= 1 || search->probes_count >= MAX_SEARCH_PROBES)
+    {
+        return 0;
+    }
+    search->current = search->passed_connections + (search->failed_connections - search->passed_connections) / 2;
+    return search->current;
+}
+
+void search_print(const ThroughputSearch *search, FILE *stream)
+{
+    const SearchProbe *best = NULL;
+    bool printed[MAX_SEARCH_PROBES] = {false};
+
+    fprintf(stream, "Throughput curve:\n");
+    for (int n = 0; n < search->probes_count; n++)
+    {
+        // Selection sort by connections, there are only a few probes.
+        int next = -1;
+        for (int i = 0; i < search->probes_count; i++)
+        {
+            if (!printed[i] && (next < 0 || search->probes[i].connections < search->probes[next].connections))
+            {
+                next = i;
+            }
+        }
+        printed[next] = true;
+
+        const SearchProbe *probe = &search->probes[next];
+        fprintf(stream, "    connections=[%d], throughput=[%.1f/s], p99=[%.3fms], %s.\n",
+                probe->connections, probe->throughput, probe->p99_ns / 1e6, probe->passed ? "passed" : "failed");
+        if (probe->passed && (NULL == best || probe->throughput > best->throughput))
+        {
+            best = probe;
+        }
+    }
+
+    if (NULL == best)
+    {
+        fprintf(stream, "No concurrency kept p99 within %.3fms.\n", search->slo_p99_ns / 1e6);
+        return;
+    }
+    fprintf(stream, "Max sustainable throughput: [%.1f/s] with [%d] connections, p99 within %.3fms.\n",
+            best->throughput, best->connections, search->slo_p99_ns / 1e6);
+}
@@ -0,0 +1,73 @@
+#include "sockopt.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef TCP_FASTOPEN_CONNECT
+#define TCP_FASTOPEN_CONNECT 30
+#endif
+
+static int set_int_option(int sockfd, int level, int name, int value, const char *option_name)
+{
+    if (setsockopt(sockfd, level, name, &value, sizeof(value)) == -1)
+    {
+        fprintf(stderr, "Failed to set %s on socket: %s\n", option_name, strerror(errno));
+        return -1;
+    }
+    return 1;
+}
+
+int apply_socket_options(int sockfd, const Arguments *args)
+{
+    if (NULL == args)
+    {
+        return -1;
+    }
+
+    if (args->tcp_nodelay && set_int_option(sockfd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY") < 0)
+    {
+        return -1;
+    }
+
+    // The kernel doubles the given value for bookkeeping, and the window scale is chosen at SYN time.
+    if (args->send_buffer_size > 0 && set_int_option(sockfd, SOL_SOCKET, SO_SNDBUF, args->send_buffer_size, "SO_SNDBUF") < 0)
+    {
+        return -1;
+    }
+    if (args->recv_buffer_size > 0 && set_int_option(sockfd, SOL_SOCKET, SO_RCVBUF, args->recv_buffer_size, "SO_RCVBUF") < 0)
+    {
+        return -1;
+    }
+
+    /**
+     * With TCP_FASTOPEN_CONNECT, connect() returns at once and the SYN leaves with the first write,
+     * carrying the request when a cookie of the server is cached. Without a cookie, that write fails
+     * with EINPROGRESS and the connection goes on as a normal handshake.
+     */
+    if (args->tcp_fastopen && set_int_option(sockfd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, 1, "TCP_FASTOPEN_CONNECT") < 0)
+    {
+        return -1;
+    }
+
+    // Closing with a zero linger sends RST, so the client side keeps no TIME_WAIT and no port is held.
+    if (args->linger_zero)
+    {
+        struct linger linger = {.l_onoff = 1, .l_linger = 0};
+        if (setsockopt(sockfd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger)) == -1)
+        {
+            fprintf(stderr, "Failed to set SO_LINGER on socket: %s\n", strerror(errno));
+            return -1;
+        }
+    }
+
+    // The kernel may leave quick ACK mode by itself later, it's only a hint for the first exchanges.
+    if (args->tcp_quickack && set_int_option(sockfd, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK") < 0)
+    {
+        return -1;
+    }
+
+    return 1;
+}
@@ -0,0 +1,219 @@
+#include "targets.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arguments.h"
+#include "body_hash.h"
+
+static int parse_target(Target *target, const char *text, size_t len, int default_port)
+{
+    char buf[TARGET_HOST_LEN + 32];
+    if (0 == len || len >= sizeof(buf))
+    {
+        return -1;
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+
+    char *endptr;
+    target->weight = 1;
+    char *weight = strchr(buf, '@');
+    if (weight != NULL)
+    {
+        *weight++ = '\0';
+        errno = 0;
+        long w = strtol(weight, &endptr, 10);
+        if (errno != 0 || endptr == weight || *endptr != '\0' || w <= 0 || w > MAX_TARGET_WEIGHT)
+        {
+            return -1;
+        }
+        target->weight = (int)w;
+    }
+
+    target->port = default_port;
+    char *port = strrchr(buf, ':');
+    if (port != NULL)
+    {
+        *port++ = '\0';
+        errno = 0;
+        long p = strtol(port, &endptr, 10);
+        if (errno != 0 || endptr == port || *endptr != '\0' || p <= 0 || p > 65535)
+        {
+            return -1;
+        }
+        target->port = (int)p;
+    }
+
+    if (0 == strlen(buf) || strlen(buf) >= sizeof(target->host))
+    {
+        return -1;
+    }
+    snprintf(target->host, sizeof(target->host), "%s", buf);
+    return 1;
+}
+
+static int compare_points(const void *a, const void *b)
+{
+    uint64_t x = ((const TargetPoint *) a)->hash;
+    uint64_t y = ((const TargetPoint *) b)->hash;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Place each target on the ring as many times as its weight asks, by the hash of its name.
+ */
+static int build_ring(TargetPool *pool)
+{
+    int size = 0;
+    for (int i = 0; i < pool->count; i++)
+    {
+        size += pool->targets[i].weight * TARGET_RING_POINTS;
+    }
+
+    pool->ring = (TargetPoint *) malloc(sizeof(TargetPoint) * size);
+    if (NULL == pool->ring)
+    {
+        perror("Memory allocation for the hash ring is failed.");
+        return -1;
+    }
+
+    int n = 0;
+    for (int i = 0; i < pool->count; i++)
+    {
+        for (int point = 0; point < pool->targets[i].weight * TARGET_RING_POINTS; point++)
+        {
+            char name[TARGET_HOST_LEN + 32];
+            int len = snprintf(name, sizeof(name), "%s:%d#%d", pool->targets[i].host, pool->targets[i].port, point);
+            pool->ring[n].hash = body_hash(name, (size_t)len);
+            pool->ring[n].target = i;
+            n++;
+        }
+    }
+    qsort(pool->ring, n, sizeof(TargetPoint), compare_points);
+    pool->ring_size = n;
+    return 1;
+}
+
+int target_pool_init(TargetPool *pool, const char *list, int default_port, int balance)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->balance = balance;
+
+    const char *start = list;
+    while (*start != '\0')
+    {
+        const char *end = strchr(start, ',');
+        size_t len = (NULL == end) ? strlen(start) : (size_t)(end - start);
+        if (pool->count >= MAX_TARGETS || parse_target(&pool->targets[pool->count], start, len, default_port) < 0)
+        {
+            fprintf(stderr, "Invalid target %.*s, it should be host[:port][@weight], at most %d of them.\n",
+                    (int)len, start, MAX_TARGETS);
+            return -1;
+        }
+        pool->count++;
+        start += (NULL == end) ? len : len + 1;
+    }
+
+    if (0 == pool->count)
+    {
+        fprintf(stderr, "No target is given.\n");
+        return -1;
+    }
+    if (BALANCE_HASH == balance && build_ring(pool) < 0)
+    {
+        return -1;
+    }
+    return pool->count;
+}
+
+void target_pool_free(TargetPool *pool)
+{
+    free(pool->ring);
+    pool->ring = NULL;
+    pool->ring_size = 0;
+}
+
+int target_pool_pick(TargetPool *pool, const char *key, size_t key_len)
+{
+    int best = 0;
+
+    switch (pool->balance)
+    {
+    case BALANCE_WEIGHTED:
+    {
+        // Smooth weighted round-robin: the heaviest target goes first, without bursts to it.
+        int64_t total = 0;
+        for (int i = 0; i < pool->count; i++)
+        {
+            pool->targets[i].current_weight += pool->targets[i].weight;
+            total += pool->targets[i].weight;
+            if (pool->targets[i].current_weight > pool->targets[best].current_weight)
+            {
+                best = i;
+            }
+        }
+        pool->targets[best].current_weight -= total;
+        return best;
+    }
+    case BALANCE_HASH:
+    {
+        // The first point at or after the hash of the key, wrapping around.
+        uint64_t hash = body_hash(key, key_len);
+        int low = 0;
+        int high = pool->ring_size;
+        while (low < high)
+        {
+            int mid = low + (high - low) / 2;
+            if (pool->ring[mid].hash < hash)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        return pool->ring[low == pool->ring_size ? 0 : low].target;
+    }
+    default:
+        return (int)(pool->next++ % (uint64_t)pool->count);
+    }
+}
+
+void target_pool_reset_stats(TargetPool *pool)
+{
+    for (int i = 0; i < pool->count; i++)
+    {
+        pool->targets[i].completed = 0;
+        pool->targets[i].failed = 0;
+        histogram_reset(&pool->targets[i].latency);
+    }
+}
+
+void target_pool_print(const TargetPool *pool, double seconds, FILE *stream)
+{
+    int slowest = -1;
+    for (int i = 0; i < pool->count; i++)
+    {
+        const Target *target = &pool->targets[i];
+        char name[TARGET_HOST_LEN + 64];
+        fprintf(stream, "Target %s:%d: weight=[%d], completed=[%llu], failed=[%llu], throughput=[%.1f/s].\n",
+                target->host, target->port, target->weight,
+                (unsigned long long)target->completed, (unsigned long long)target->failed,
+                seconds > 0 ? target->completed / seconds : 0.0);
+        if (target->latency.total_count > 0)
+        {
+            snprintf(name, sizeof(name), "  Latency of %s:%d", target->host, target->port);
+            histogram_print(&target->latency, name, stream);
+            if (slowest < 0 || histogram_percentile(&target->latency, 99) > histogram_percentile(&pool->targets[slowest].latency, 99))
+            {
+                slowest = i;
+            }
+        }
+    }
+    if (pool->count > 1 && slowest >= 0)
+    {
+        fprintf(stream, "The slowest target is %s:%d, p99=[%.3fms].\n", pool->targets[slowest].host, pool->targets[slowest].port,
+                histogram_percentile(&pool->targets[slowest].latency, 99) / 1e6);
+    }
+}
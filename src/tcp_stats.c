@@ -0,0 +1,79 @@
+#include "tcp_stats.h"
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+// The byte counters of tcp_info are missing in the glibc header, use the kernel one instead.
+#include <linux/tcp.h>
+
+int tcp_stats_sample(int sockfd, TcpStats *stats)
+{
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+
+    memset(&info, 0, sizeof(info));
+    if (getsockopt(sockfd, IPPROTO_TCP, TCP_INFO, &info, &len) == -1)
+    {
+        return -1;
+    }
+
+    // A connection which never got established has nothing to tell.
+    if (0 == info.tcpi_rtt)
+    {
+        return -1;
+    }
+
+    stats->connections++;
+    stats->rtt_us_sum += info.tcpi_rtt;
+    if (info.tcpi_rtt > stats->rtt_us_max)
+    {
+        stats->rtt_us_max = info.tcpi_rtt;
+    }
+    stats->retransmits += info.tcpi_total_retrans;
+    stats->cwnd_sum += info.tcpi_snd_cwnd;
+
+    // Kernels before 4.2 return a shorter tcp_info without the byte and segment counters.
+    if (len >= offsetof(struct tcp_info, tcpi_segs_out) + sizeof(info.tcpi_segs_out))
+    {
+        stats->wire_bytes_sent += info.tcpi_bytes_acked;
+        stats->wire_bytes_received += info.tcpi_bytes_received;
+        stats->segments_sent += info.tcpi_segs_out;
+    }
+    return 1;
+}
+
+void tcp_stats_merge(TcpStats *dst, const TcpStats *src)
+{
+    dst->connections += src->connections;
+    dst->rtt_us_sum += src->rtt_us_sum;
+    if (src->rtt_us_max > dst->rtt_us_max)
+    {
+        dst->rtt_us_max = src->rtt_us_max;
+    }
+    dst->retransmits += src->retransmits;
+    dst->cwnd_sum += src->cwnd_sum;
+    dst->segments_sent += src->segments_sent;
+    dst->wire_bytes_sent += src->wire_bytes_sent;
+    dst->wire_bytes_received += src->wire_bytes_received;
+}
+
+void tcp_stats_print(const TcpStats *stats, FILE *stream)
+{
+    if (0 == stats->connections)
+    {
+        return;
+    }
+    fprintf(stream, "TCP: connections=[%llu], mean rtt=[%.3fms], max rtt=[%.3fms], retransmits=[%llu], mean cwnd=[%.1f].\n",
+            (unsigned long long)stats->connections,
+            (double)stats->rtt_us_sum / stats->connections / 1e3,
+            stats->rtt_us_max / 1e3,
+            (unsigned long long)stats->retransmits,
+            (double)stats->cwnd_sum / stats->connections);
+
+    // Loss above 1% holds the congestion window down, the results then measure the network, not the server.
+    if (stats->segments_sent > 0 && stats->retransmits * 100 > stats->segments_sent)
+    {
+        fprintf(stream, "Warning: %.2f%% of the segments were retransmitted, the network is likely the limit.\n",
+                100.0 * stats->retransmits / stats->segments_sent);
+    }
+}
@@ -0,0 +1,294 @@
+#include "template.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static int add_segment(RequestTemplate *request_template, template_segment_type type)
+{
+    if (request_template->segments_count >= MAX_TEMPLATE_SEGMENTS)
+    {
+        fprintf(stderr, "Too many segments in request template, at most %d.\n", MAX_TEMPLATE_SEGMENTS);
+        return -1;
+    }
+    TemplateSegment *segment = &request_template->segments[request_template->segments_count];
+    memset(segment, 0, sizeof(*segment));
+    segment->type = type;
+    return request_template->segments_count++;
+}
+
+static int add_literal(RequestTemplate *request_template, int offset, int len)
+{
+    if (len <= 0)
+    {
+        return 0;
+    }
+    int index = add_segment(request_template, SEGMENT_LITERAL);
+    if (index < 0)
+    {
+        return -1;
+    }
+    request_template->segments[index].offset = offset;
+    request_template->segments[index].len = len;
+    return 0;
+}
+
+/**
+ * Parse "MIN-MAX" of a random placeholder.
+ */
+static int compile_random(TemplateSegment *segment, const char *spec, int len)
+{
+    char range[64];
+    char *endptr = NULL;
+    if (len <= 0 || len >= (int)sizeof(range))
+    {
+        return -1;
+    }
+    memcpy(range, spec, len);
+    range[len] = '\0';
+
+    errno = 0;
+    unsigned long long min = strtoull(range, &endptr, 10);
+    if (errno != 0 || endptr == range || '-' != *endptr)
+    {
+        return -1;
+    }
+    const char *max_str = endptr + 1;
+    unsigned long long max = strtoull(max_str, &endptr, 10);
+    if (errno != 0 || endptr == max_str || '\0' != *endptr || max < min)
+    {
+        return -1;
+    }
+
+    segment->min = min;
+    // The full range of 64 bits wraps around to 0.
+    segment->range = (uint64_t)(max - min) + 1;
+    return 0;
+}
+
+/**
+ * Split "a|b|c" of a pick placeholder into choices, which refer to the template text.
+ */
+static int compile_pick(RequestTemplate *request_template, TemplateSegment *segment, int offset, int len)
+{
+    segment->first_choice = request_template->choices_count;
+    int start = offset;
+    for (int i = offset; i <= offset + len; i++)
+    {
+        if (i < offset + len && '|' != request_template->text[i])
+        {
+            continue;
+        }
+        if (request_template->choices_count >= MAX_TEMPLATE_CHOICES)
+        {
+            fprintf(stderr, "Too many tokens in request template, at most %d.\n", MAX_TEMPLATE_CHOICES);
+            return -1;
+        }
+        request_template->choices[request_template->choices_count].offset = start;
+        request_template->choices[request_template->choices_count].len = i - start;
+        request_template->choices_count++;
+        segment->choices_count++;
+        start = i + 1;
+    }
+    return 0;
+}
+
+int template_compile(RequestTemplate *request_template, const char *text)
+{
+    size_t text_len = strlen(text);
+    if (text_len >= sizeof(request_template->text))
+    {
+        fprintf(stderr, "Request template is too large.\n");
+        return -1;
+    }
+
+    memset(request_template, 0, sizeof(*request_template));
+    memcpy(request_template->text, text, text_len + 1);
+
+    const char *base = request_template->text;
+    int placeholders = 0;
+    int literal_start = 0;
+    const char *open = strstr(base, "{{");
+    while (NULL != open)
+    {
+        const char *close = strstr(open + 2, "}}");
+        if (NULL == close)
+        {
+            fprintf(stderr, "Unterminated placeholder in request template: %s\n", open);
+            return -1;
+        }
+        if (add_literal(request_template, literal_start, (int)(open - base) - literal_start) < 0)
+        {
+            return -1;
+        }
+
+        const char *name = open + 2;
+        int name_len = (int)(close - name);
+        int index;
+        if (3 == name_len && 0 == strncmp(name, "seq", 3))
+        {
+            index = add_segment(request_template, SEGMENT_SEQUENCE);
+        }
+        else if (4 == name_len && 0 == strncmp(name, "conn", 4))
+        {
+            index = add_segment(request_template, SEGMENT_CONNECTION);
+        }
+        else if (name_len > 5 && 0 == strncmp(name, "rand:", 5))
+        {
+            index = add_segment(request_template, SEGMENT_RANDOM);
+            if (index >= 0 && compile_random(&request_template->segments[index], name + 5, name_len - 5) < 0)
+            {
+                fprintf(stderr, "Illegal range in placeholder {{%.*s}}, expecting rand:MIN-MAX.\n", name_len, name);
+                return -1;
+            }
+        }
+        else if (name_len > 5 && 0 == strncmp(name, "pick:", 5))
+        {
+            index = add_segment(request_template, SEGMENT_PICK);
+            if (index >= 0 && compile_pick(request_template, &request_template->segments[index], (int)(name + 5 - base), name_len - 5) < 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown placeholder {{%.*s}} in request template.\n", name_len, name);
+            return -1;
+        }
+        if (index < 0)
+        {
+            return -1;
+        }
+
+        placeholders++;
+        literal_start = (int)(close + 2 - base);
+        open = strstr(close + 2, "{{");
+    }
+
+    if (add_literal(request_template, literal_start, (int)text_len - literal_start) < 0)
+    {
+        return -1;
+    }
+    return placeholders;
+}
+
+/**
+ * SplitMix64, used to spread the connection id into a seed with enough set bits.
+ */
+static uint64_t mix_seed(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/**
+ * Xorshift64*, fast enough for every request and good enough for key distributions.
+ */
+static uint64_t next_random(TemplateContext *context)
+{
+    uint64_t x = context->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    context->random_state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+void template_context_init(TemplateContext *context, uint64_t *sequence, int connection_id)
+{
+    context->sequence = sequence;
+    context->connection_id = connection_id;
+    context->random_state = mix_seed((uint64_t)connection_id);
+    if (0 == context->random_state)
+    {
+        context->random_state = 1;
+    }
+}
+
+/**
+ * Write the decimal digits of value, instead of calling snprintf for every request.
+ */
+static int write_number(uint64_t value, char *buffer, size_t size)
+{
+    char digits[20];
+    int count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    if ((size_t)count > size)
+    {
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        buffer[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+int template_render(const RequestTemplate *request_template, TemplateContext *context, char *buffer, size_t size)
+{
+    size_t pos = 0;
+    if (0 == size)
+    {
+        return -1;
+    }
+    // Keep one byte for the terminating '\0'.
+    size--;
+
+    for (int i = 0; i < request_template->segments_count; i++)
+    {
+        const TemplateSegment *segment = &request_template->segments[i];
+        const TemplateChoice *choice;
+        uint64_t value;
+        int written;
+
+        switch (segment->type)
+        {
+        case SEGMENT_LITERAL:
+            if (pos + segment->len > size)
+            {
+                return -1;
+            }
+            memcpy(buffer + pos, request_template->text + segment->offset, segment->len);
+            pos += segment->len;
+            continue;
+        case SEGMENT_PICK:
+            choice = &request_template->choices[segment->first_choice + next_random(context) % segment->choices_count];
+            if (pos + choice->len > size)
+            {
+                return -1;
+            }
+            memcpy(buffer + pos, request_template->text + choice->offset, choice->len);
+            pos += choice->len;
+            continue;
+        case SEGMENT_SEQUENCE:
+            value = (*context->sequence)++;
+            break;
+        case SEGMENT_RANDOM:
+            value = next_random(context);
+            value = segment->min + (segment->range ? value % segment->range : value);
+            break;
+        case SEGMENT_CONNECTION:
+            value = (uint64_t)context->connection_id;
+            break;
+        default:
+            return -1;
+        }
+
+        written = write_number(value, buffer + pos, size - pos);
+        if (written < 0)
+        {
+            return -1;
+        }
+        pos += written;
+    }
+
+    buffer[pos] = '\0';
+    return (int)pos;
+}
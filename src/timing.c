@@ -0,0 +1,125 @@
+#include "timing.h"
+#include <stdbool.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+// The TSC is counted this long against the monotonic clock, about a ppm of error for a 20ns clock read.
+#define TSC_CALIBRATION_NS 20000000ull
+
+static timing_source selected_source = TIMING_SOURCE_MONOTONIC;
+
+// The time of the monotonic clock at tsc_base, and the length of a tick.
+static uint64_t tsc_base;
+static uint64_t tsc_base_ns;
+static double tsc_ns_per_tick;
+
+// Each event loop keeps the time of its own wakeups.
+static __thread uint64_t loop_ns;
+
+uint64_t get_monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+#ifdef HAVE_TSC
+/**
+ * Tell if the TSC ticks at a constant rate in every power state, so ticks convert to time.
+ */
+static bool is_tsc_invariant(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007)
+    {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+/**
+ * Read the monotonic clock and the TSC at about the same time, the TSC is read around the clock.
+ */
+static void read_clock_pair(uint64_t *ns, uint64_t *tsc)
+{
+    uint64_t before = __rdtsc();
+    *ns = get_monotonic_ns();
+    uint64_t after = __rdtsc();
+    *tsc = before + (after - before) / 2;
+}
+
+/**
+ * Count the ticks of the TSC over TSC_CALIBRATION_NS of the monotonic clock.
+ *
+ * RETURNS:
+ *      Positive number: The TSC is calibrated.
+ *      Negative number: The TSC did not advance.
+ */
+static int calibrate_tsc(void)
+{
+    uint64_t start_ns, start_tsc;
+    uint64_t end_ns, end_tsc;
+    read_clock_pair(&start_ns, &start_tsc);
+    struct timespec pause = {0, TSC_CALIBRATION_NS};
+    nanosleep(&pause, NULL);
+    read_clock_pair(&end_ns, &end_tsc);
+    if (end_tsc <= start_tsc || end_ns <= start_ns)
+    {
+        return -1;
+    }
+    tsc_base = start_tsc;
+    tsc_base_ns = start_ns;
+    tsc_ns_per_tick = (double)(end_ns - start_ns) / (double)(end_tsc - start_tsc);
+    return 1;
+}
+#endif
+
+int timing_select_source(timing_source source)
+{
+    if (TIMING_SOURCE_MONOTONIC == source)
+    {
+        selected_source = TIMING_SOURCE_MONOTONIC;
+        return 1;
+    }
+#ifdef HAVE_TSC
+    if (is_tsc_invariant() && calibrate_tsc() > 0)
+    {
+        selected_source = TIMING_SOURCE_TSC;
+        return 1;
+    }
+#endif
+    selected_source = TIMING_SOURCE_MONOTONIC;
+    return -1;
+}
+
+timing_source timing_selected_source(void)
+{
+    return selected_source;
+}
+
+uint64_t timing_read_ns(void)
+{
+#ifdef HAVE_TSC
+    if (TIMING_SOURCE_TSC == selected_source)
+    {
+        return tsc_base_ns + (uint64_t)((double)(__rdtsc() - tsc_base) * tsc_ns_per_tick);
+    }
+#endif
+    return get_monotonic_ns();
+}
+
+uint64_t timing_tick(void)
+{
+    loop_ns = timing_read_ns();
+    return loop_ns;
+}
+
+uint64_t timing_loop_ns(void)
+{
+    return loop_ns;
+}
@@ -0,0 +1,128 @@
+#include "tls_config.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <openssl/err.h>
+
+int tls_sweep_count(const char *list)
+{
+    int count = 1;
+    for (const char *p = list; *p != '\0'; p++)
+    {
+        if (',' == *p)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+int tls_sweep_item(const char *list, int index, char *item, size_t size)
+{
+    const char *start = list;
+    for (int i = 0; i < index; i++)
+    {
+        start = strchr(start, ',');
+        if (NULL == start)
+        {
+            return -1;
+        }
+        start++;
+    }
+
+    const char *end = strchr(start, ',');
+    size_t len = (NULL == end) ? strlen(start) : (size_t)(end - start);
+    if (index < 0 || len >= size)
+    {
+        return -1;
+    }
+    memcpy(item, start, len);
+    item[len] = '\0';
+    return (int)len;
+}
+
+/**
+ * Split the cipher list between the TLS 1.3 suites and the TLS 1.2 ciphers, which OpenSSL sets apart.
+ */
+static int apply_ciphers(SSL_CTX *ctx, const char *ciphers)
+{
+    char suites[512] = {0};
+    char legacy[512] = {0};
+    size_t suites_len = 0;
+    size_t legacy_len = 0;
+
+    const char *name = ciphers;
+    while (*name != '\0')
+    {
+        const char *end = strchr(name, ':');
+        size_t len = (NULL == end) ? strlen(name) : (size_t)(end - name);
+        bool is_suite = (0 == strncmp(name, "TLS_", 4));
+        char *dst = is_suite ? suites : legacy;
+        size_t *dst_len = is_suite ? &suites_len : &legacy_len;
+
+        if (*dst_len + len + 2 > sizeof(suites))
+        {
+            fprintf(stderr, "The cipher list %s is too long.\n", ciphers);
+            return -1;
+        }
+        if (*dst_len > 0)
+        {
+            dst[(*dst_len)++] = ':';
+        }
+        memcpy(dst + *dst_len, name, len);
+        *dst_len += len;
+        dst[*dst_len] = '\0';
+
+        name += (NULL == end) ? len : len + 1;
+    }
+
+    if ((suites_len > 0 && 1 != SSL_CTX_set_ciphersuites(ctx, suites)) ||
+        (legacy_len > 0 && 1 != SSL_CTX_set_cipher_list(ctx, legacy)))
+    {
+        fprintf(stderr, "Unsupported ciphers %s.\n", ciphers);
+        ERR_print_errors_fp(stderr);
+        return -1;
+    }
+    return 1;
+}
+
+int tls_config_apply(SSL_CTX *ctx, int version, const char *ciphers, const char *groups)
+{
+    if (NULL == ctx)
+    {
+        return -1;
+    }
+
+    if (version != 0 && (1 != SSL_CTX_set_min_proto_version(ctx, version) || 1 != SSL_CTX_set_max_proto_version(ctx, version)))
+    {
+        fprintf(stderr, "Unsupported TLS version %s.\n", tls_version_name(version));
+        ERR_print_errors_fp(stderr);
+        return -1;
+    }
+
+    if (ciphers != NULL && strlen(ciphers) > 0 && apply_ciphers(ctx, ciphers) < 0)
+    {
+        return -1;
+    }
+
+    if (groups != NULL && strlen(groups) > 0 && 1 != SSL_CTX_set1_groups_list(ctx, groups))
+    {
+        fprintf(stderr, "Unsupported key exchange groups %s.\n", groups);
+        ERR_print_errors_fp(stderr);
+        return -1;
+    }
+    return 1;
+}
+
+const char *tls_version_name(int version)
+{
+    switch (version)
+    {
+    case TLS1_2_VERSION:
+        return "TLSv1.2";
+    case TLS1_3_VERSION:
+        return "TLSv1.3";
+    default:
+        return "default";
+    }
+}
@@ -0,0 +1,41 @@
+#include "token_bucket.h"
+
+void token_bucket_init(TokenBucket *bucket, uint64_t rate, uint64_t now_ns)
+{
+    bucket->rate = rate;
+    bucket->burst = rate / 10 > 0 ? rate / 10 : 1;
+    bucket->tokens = bucket->burst;
+    bucket->refilled_ns = now_ns;
+}
+
+uint64_t token_bucket_available(TokenBucket *bucket, uint64_t now_ns)
+{
+    if (0 == bucket->rate)
+    {
+        return UINT64_MAX;
+    }
+    if (now_ns <= bucket->refilled_ns)
+    {
+        return bucket->tokens;
+    }
+
+    // Only whole tokens are added, the time of the fraction left is kept for the next refill.
+    uint64_t elapsed_ns = now_ns - bucket->refilled_ns;
+    uint64_t added = (uint64_t)((unsigned __int128)elapsed_ns * bucket->rate / 1000000000u);
+    if (bucket->tokens + added >= bucket->burst)
+    {
+        bucket->tokens = bucket->burst;
+        bucket->refilled_ns = now_ns;
+    }
+    else if (added > 0)
+    {
+        bucket->tokens += added;
+        bucket->refilled_ns += (uint64_t)((unsigned __int128)added * 1000000000u / bucket->rate);
+    }
+    return bucket->tokens;
+}
+
+void token_bucket_consume(TokenBucket *bucket, uint64_t bytes)
+{
+    bucket->tokens = bytes < bucket->tokens ? bucket->tokens - bytes : 0;
+}
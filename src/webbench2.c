@@ -6,6 +6,10 @@
 #include <stdlib.h>
 #include <bench_poll.h>
 #include "bench_epoll.h"
+#include "procs.h"
+#include "compare.h"
+#include "timing.h"
+#include <string.h>
 
 int main(int argc, char *argv[])
 {
@@ -15,6 +19,12 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    // Subcommands come before the options of the bench.
+    if (0 == strcmp(argv[1], "compare"))
+    {
+        return compare_command(argc - 1, argv + 1);
+    }
+
     Arguments args = create_default_arguments();
     set_arguments_values(argc, argv, &args);
 
@@ -22,12 +32,29 @@ int main(int argc, char *argv[])
            args.bench_time, args.clients, args.proxy_host, args.proxy_port, args.url);
 
     HTTPRequest http_request = {0};
-    build_request(&args, &http_request);
+    if (build_request(&args, &http_request) < 0)
+    {
+        fprintf(stderr, "Failed to build the bench request.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The workers inherit the calibration when they are forked.
+    if (args.tsc_clock && timing_select_source(TIMING_SOURCE_TSC) < 0)
+    {
+        fprintf(stderr, "The TSC is not invariant, the events are timed by the monotonic clock.\n");
+    }
 
     // bench(&args, &http_request);
     // bench_with_no_racing(&args, &http_request);
 
     // bench_select(&args, &http_request);
     // bench_poll(&args, &http_request);
-    bench_epoll(&args, &http_request);
+    if (args.procs > 1)
+    {
+        bench_processes(&args, &http_request);
+    }
+    else
+    {
+        bench_epoll(&args, &http_request);
+    }
 }
\ No newline at end of file
@@ -157,6 +157,35 @@ START_TEST(test_url_contains_target_host_and_port)
     ck_assert_int_eq(args.target_port, 1234567);
 }
 
+START_TEST(test_socket_options)
+{
+    char *argv[] = {"webbench2", "--nodelay", "--sndbuf", "65536", "--rcvbuf", "131072", "--linger0", "http://www.baidu.com/"};
+    int argc = 8;
+    Arguments args = create_default_arguments();
+    set_arguments_values(argc, argv, &args);
+
+    ck_assert_int_eq(args.tcp_nodelay, 1);
+    ck_assert_int_eq(args.send_buffer_size, 65536);
+    ck_assert_int_eq(args.recv_buffer_size, 131072);
+    ck_assert_int_eq(args.linger_zero, 1);
+    ck_assert_int_eq(args.tcp_fastopen, 0);
+    ck_assert_int_eq(args.tcp_quickack, 0);
+}
+
+START_TEST(test_cpu_list)
+{
+    char *argv[] = {"webbench2", "--cpus", "0-2,8,10-11", "http://www.baidu.com/"};
+    int argc = 4;
+    Arguments args = create_default_arguments();
+    set_arguments_values(argc, argv, &args);
+
+    ck_assert_int_eq(args.cpus_count, 6);
+    ck_assert_int_eq(args.cpus[0], 0);
+    ck_assert_int_eq(args.cpus[2], 2);
+    ck_assert_int_eq(args.cpus[3], 8);
+    ck_assert_int_eq(args.cpus[5], 11);
+}
+
 Suite *arguments_suite(void)
 {
     Suite *s;
@@ -170,6 +199,8 @@ Suite *arguments_suite(void)
     tcase_add_test(tc_core, test_legal_http_method);
     //tcase_add_test(tc_core, test_illegal_http_method);
     tcase_add_test(tc_core, test_url_contains_target_host_and_port);
+    tcase_add_test(tc_core, test_socket_options);
+    tcase_add_test(tc_core, test_cpu_list);
     suite_add_tcase(s, tc_core);
     return s;
 }
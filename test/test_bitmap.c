@@ -29,6 +29,78 @@ START_TEST(test_set_and_get_bitmap)
 
 }
 
+START_TEST(test_bitmap_words)
+{
+    Bitmap bitmap;
+
+    // Far beyond the 65535 positions of the char bitmap.
+    ck_assert_int_gt(bitmap_init(&bitmap, 100000), 0);
+    ck_assert_uint_eq(bitmap.words_count, 1563);
+
+    bitmap_set(&bitmap, 0);
+    bitmap_set(&bitmap, 63);
+    bitmap_set(&bitmap, 64);
+    bitmap_set(&bitmap, 99999);
+    ck_assert(bitmap_test(&bitmap, 63));
+    ck_assert(bitmap_test(&bitmap, 64));
+    ck_assert(!bitmap_test(&bitmap, 65));
+    ck_assert_uint_eq(bitmap_count(&bitmap), 4);
+
+    bitmap_clear(&bitmap, 63);
+    ck_assert(!bitmap_test(&bitmap, 63));
+    ck_assert_uint_eq(bitmap_count(&bitmap), 3);
+    bitmap_free(&bitmap);
+}
+
+START_TEST(test_bitmap_find_next_set)
+{
+    Bitmap bitmap;
+    size_t expected[] = {3, 64, 200, 4999};
+    int found = 0;
+
+    ck_assert_int_gt(bitmap_init(&bitmap, 5000), 0);
+    ck_assert_uint_eq(bitmap_find_next_set(&bitmap, 0), 5000);
+    for (int i = 0; i < 4; i++)
+    {
+        bitmap_set(&bitmap, expected[i]);
+    }
+
+    for (size_t i = bitmap_find_next_set(&bitmap, 0); i < bitmap.bits; i = bitmap_find_next_set(&bitmap, i + 1))
+    {
+        ck_assert_int_lt(found, 4);
+        ck_assert_uint_eq(i, expected[found]);
+        found++;
+    }
+    ck_assert_int_eq(found, 4);
+    ck_assert_uint_eq(bitmap_find_next_set(&bitmap, 65), 200);
+    ck_assert_uint_eq(bitmap_find_next_set(&bitmap, 5000), 5000);
+    bitmap_free(&bitmap);
+}
+
+START_TEST(test_bitmap_ranges)
+{
+    Bitmap bitmap;
+
+    ck_assert_int_gt(bitmap_init(&bitmap, 300), 0);
+    bitmap_set_range(&bitmap, 10, 200);
+    ck_assert_uint_eq(bitmap_count(&bitmap), 200);
+    ck_assert(!bitmap_test(&bitmap, 9));
+    ck_assert(bitmap_test(&bitmap, 10));
+    ck_assert(bitmap_test(&bitmap, 209));
+    ck_assert(!bitmap_test(&bitmap, 210));
+
+    bitmap_clear_range(&bitmap, 60, 70);
+    ck_assert_uint_eq(bitmap_count(&bitmap), 130);
+    ck_assert_uint_eq(bitmap_find_next_set(&bitmap, 60), 130);
+
+    // Cut at the end of the bitmap.
+    bitmap_set_range(&bitmap, 290, 1000);
+    ck_assert_uint_eq(bitmap_count(&bitmap), 140);
+
+    bitmap_clear_all(&bitmap);
+    ck_assert_uint_eq(bitmap_count(&bitmap), 0);
+    bitmap_free(&bitmap);
+}
 
 Suite *arguments_suite(void)
 {
@@ -37,6 +109,9 @@ Suite *arguments_suite(void)
     s = suite_create("bitmap");
     tc_core = tcase_create("Core");
     tcase_add_test(tc_core, test_set_and_get_bitmap);
+    tcase_add_test(tc_core, test_bitmap_words);
+    tcase_add_test(tc_core, test_bitmap_find_next_set);
+    tcase_add_test(tc_core, test_bitmap_ranges);
 
     suite_add_tcase(s, tc_core);
     return s;
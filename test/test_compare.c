@@ -0,0 +1,107 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compare.h"
+
+static BenchResults baseline;
+static BenchResults candidate;
+
+/**
+ * A run of 30 samples around rate requests per second, with latencies spread around latency_ns.
+ */
+static void fill_run(BenchResults *results, uint64_t rate, uint64_t latency_ns)
+{
+    memset(results, 0, sizeof(*results));
+    results->sample_seconds = 1;
+    results->samples_count = 30;
+    for (int i = 0; i < results->samples_count; i++)
+    {
+        results->samples[i] = rate + (i % 5) * rate / 100;
+        for (uint64_t j = 0; j < results->samples[i]; j++)
+        {
+            histogram_record(&results->latency, latency_ns + (j % 100) * latency_ns / 100);
+        }
+    }
+}
+
+START_TEST(test_compare_same_runs)
+{
+    CompareDelta delta;
+    fill_run(&baseline, 1000, 10000000);
+    fill_run(&candidate, 1000, 10000000);
+
+    ck_assert_int_gt(compare_throughput(&baseline, &candidate, BOOTSTRAP_SEED, &delta), 0);
+    ck_assert(delta.delta == 0);
+    ck_assert(delta.ci_low <= 0 && delta.ci_high >= 0);
+    ck_assert_int_eq(compare_judge(&delta, true, DEFAULT_COMPARE_THRESHOLD), VERDICT_NO_CHANGE);
+
+    ck_assert_int_gt(compare_percentile(&baseline, &candidate, 99, BOOTSTRAP_SEED, &delta), 0);
+    ck_assert(delta.delta == 0);
+    ck_assert_int_eq(compare_judge(&delta, false, DEFAULT_COMPARE_THRESHOLD), VERDICT_NO_CHANGE);
+}
+
+START_TEST(test_compare_regression)
+{
+    CompareDelta delta;
+    fill_run(&baseline, 1000, 10000000);
+    fill_run(&candidate, 800, 15000000);
+
+    ck_assert_int_gt(compare_throughput(&baseline, &candidate, BOOTSTRAP_SEED, &delta), 0);
+    ck_assert(delta.delta < -19 && delta.delta > -21);
+    ck_assert(delta.ci_high < 0);
+    ck_assert_int_eq(compare_judge(&delta, true, DEFAULT_COMPARE_THRESHOLD), VERDICT_REGRESSION);
+
+    ck_assert_int_gt(compare_percentile(&baseline, &candidate, 99, BOOTSTRAP_SEED, &delta), 0);
+    ck_assert(delta.ci_low > 0);
+    ck_assert_int_eq(compare_judge(&delta, false, DEFAULT_COMPARE_THRESHOLD), VERDICT_REGRESSION);
+
+    // The other way around it's an improvement.
+    ck_assert_int_gt(compare_percentile(&candidate, &baseline, 99, BOOTSTRAP_SEED, &delta), 0);
+    ck_assert_int_eq(compare_judge(&delta, false, DEFAULT_COMPARE_THRESHOLD), VERDICT_IMPROVED);
+}
+
+START_TEST(test_compare_judge)
+{
+    CompareDelta delta = {100, 97, -3, -4, -2};
+    ck_assert_int_eq(compare_judge(&delta, true, 5), VERDICT_WITHIN_THRESHOLD);
+    ck_assert_int_eq(compare_judge(&delta, true, 2), VERDICT_REGRESSION);
+    ck_assert_int_eq(compare_judge(&delta, false, 2), VERDICT_IMPROVED);
+}
+
+START_TEST(test_compare_too_few_samples)
+{
+    CompareDelta delta;
+    fill_run(&baseline, 1000, 10000000);
+    memset(&candidate, 0, sizeof(candidate));
+    candidate.samples_count = 1;
+    ck_assert_int_lt(compare_throughput(&baseline, &candidate, BOOTSTRAP_SEED, &delta), 0);
+    ck_assert_int_lt(compare_percentile(&baseline, &candidate, 99, BOOTSTRAP_SEED, &delta), 0);
+}
+
+Suite *compare_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("compare");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_compare_same_runs);
+    tcase_add_test(tc_core, test_compare_regression);
+    tcase_add_test(tc_core, test_compare_judge);
+    tcase_add_test(tc_core, test_compare_too_few_samples);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = compare_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "histogram.h"
+
+START_TEST(test_empty_histogram)
+{
+    Histogram histogram;
+    histogram_reset(&histogram);
+
+    ck_assert_uint_eq(histogram.total_count, 0);
+    ck_assert_uint_eq(histogram_percentile(&histogram, 99), 0);
+}
+
+START_TEST(test_small_values_are_exact)
+{
+    Histogram histogram;
+    histogram_reset(&histogram);
+
+    for (uint64_t value = 1; value <= 10; value++)
+    {
+        histogram_record(&histogram, value);
+    }
+
+    ck_assert_uint_eq(histogram.total_count, 10);
+    ck_assert_uint_eq(histogram.min, 1);
+    ck_assert_uint_eq(histogram.max, 10);
+    ck_assert_uint_eq(histogram_percentile(&histogram, 50), 5);
+    ck_assert_uint_eq(histogram_percentile(&histogram, 100), 10);
+}
+
+START_TEST(test_percentile_precision)
+{
+    Histogram histogram;
+    histogram_reset(&histogram);
+
+    // 1ms to 100ms in nanoseconds.
+    for (uint64_t i = 1; i <= 100; i++)
+    {
+        histogram_record(&histogram, i * 1000000);
+    }
+
+    uint64_t p99 = histogram_percentile(&histogram, 99);
+    ck_assert_uint_ge(p99, 99000000 - 99000000 / 32);
+    ck_assert_uint_le(p99, 99000000 + 99000000 / 32);
+    ck_assert_uint_eq(histogram_percentile(&histogram, 100), 100000000);
+}
+
+START_TEST(test_merge_histogram)
+{
+    Histogram a, b;
+    histogram_reset(&a);
+    histogram_reset(&b);
+
+    histogram_record(&a, 100);
+    histogram_record(&b, 5);
+    histogram_record(&b, 200000);
+    histogram_merge(&a, &b);
+
+    ck_assert_uint_eq(a.total_count, 3);
+    ck_assert_uint_eq(a.min, 5);
+    ck_assert_uint_eq(a.max, 200000);
+    ck_assert_uint_eq(a.sum, 200105);
+}
+
+START_TEST(test_count_at_most)
+{
+    Histogram histogram;
+    histogram_reset(&histogram);
+    ck_assert_uint_eq(histogram_count_at_most(&histogram, 1000), 0);
+
+    for (uint64_t i = 1; i <= 100; i++)
+    {
+        histogram_record(&histogram, i * 1000000);
+    }
+    ck_assert_uint_eq(histogram_count_at_most(&histogram, 999999), 0);
+    ck_assert_uint_eq(histogram_count_at_most(&histogram, 100000000), 100);
+
+    // Values sharing the bucket of the limit are counted.
+    uint64_t count = histogram_count_at_most(&histogram, 50000000);
+    ck_assert_uint_ge(count, 50);
+    ck_assert_uint_le(count, 50 + 50 / 32 + 1);
+}
+
+Suite *histogram_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("histogram");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_empty_histogram);
+    tcase_add_test(tc_core, test_small_values_are_exact);
+    tcase_add_test(tc_core, test_percentile_precision);
+    tcase_add_test(tc_core, test_merge_histogram);
+    tcase_add_test(tc_core, test_count_at_most);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = histogram_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
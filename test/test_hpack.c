@@ -0,0 +1,119 @@
+#include <check.h>
+#include "arguments.h"
+#include "hpack.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+START_TEST(test_encode_integer_within_prefix)
+{
+    // RFC 7541 C.1.1: Encoding 10 using a 5-bit prefix.
+    unsigned char buf[8] = {0};
+    int len = hpack_encode_integer(buf, sizeof(buf), 0x00, 5, 10);
+
+    ck_assert_int_eq(len, 1);
+    ck_assert_int_eq(buf[0], 0x0a);
+}
+END_TEST
+
+START_TEST(test_encode_integer_exceeds_prefix)
+{
+    // RFC 7541 C.1.2: Encoding 1337 using a 5-bit prefix.
+    unsigned char buf[8] = {0};
+    int len = hpack_encode_integer(buf, sizeof(buf), 0x00, 5, 1337);
+
+    ck_assert_int_eq(len, 3);
+    ck_assert_int_eq(buf[0], 0x1f);
+    ck_assert_int_eq(buf[1], 0x9a);
+    ck_assert_int_eq(buf[2], 0x0a);
+}
+END_TEST
+
+START_TEST(test_encode_integer_buffer_too_small)
+{
+    unsigned char buf[2] = {0};
+    ck_assert_int_eq(hpack_encode_integer(buf, sizeof(buf), 0x00, 5, 1337), -1);
+}
+END_TEST
+
+START_TEST(test_encode_string)
+{
+    unsigned char buf[16] = {0};
+    int len = hpack_encode_string(buf, sizeof(buf), "no-cache", 8);
+
+    ck_assert_int_eq(len, 9);
+    ck_assert_int_eq(buf[0], 8);
+    ck_assert_int_eq(memcmp(buf + 1, "no-cache", 8), 0);
+}
+END_TEST
+
+START_TEST(test_encode_get_request)
+{
+    char *argv[] = {"webbench2", "--http2", "https://www.example.com/"};
+    int argc = 3;
+    unsigned char expected[] = {
+        0x82,                                               // :method: GET
+        0x87,                                               // :scheme: https
+        0x84,                                               // :path: /
+        0x01, 15, 'w', 'w', 'w', '.', 'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm',
+        0x0f, 0x2b, 10, 'W', 'e', 'b', 'B', 'e', 'n', 'c', 'h', ' ', '2'};
+    unsigned char buf[256] = {0};
+
+    Arguments args = create_default_arguments();
+    set_arguments_values(argc, argv, &args);
+
+    int len = hpack_encode_request(&args, buf, sizeof(buf));
+    ck_assert_int_eq(len, sizeof(expected));
+    ck_assert_int_eq(memcmp(buf, expected, sizeof(expected)), 0);
+}
+END_TEST
+
+START_TEST(test_encode_head_request_with_path)
+{
+    char *argv[] = {"webbench2", "--http2", "--head", "-r", "http://localhost:8080/index.html"};
+    int argc = 5;
+    unsigned char expected[] = {
+        0x02, 4, 'H', 'E', 'A', 'D',                        // :method: HEAD
+        0x86,                                               // :scheme: http
+        0x04, 12, '/', 'i', 'n', 'd', 'e', 'x', '.', 'h', 't', 'm', 'l', '/',
+        0x01, 14, 'l', 'o', 'c', 'a', 'l', 'h', 'o', 's', 't', ':', '8', '0', '8', '0',
+        0x0f, 0x2b, 10, 'W', 'e', 'b', 'B', 'e', 'n', 'c', 'h', ' ', '2',
+        0x0f, 0x09, 8, 'n', 'o', '-', 'c', 'a', 'c', 'h', 'e'};
+    unsigned char buf[256] = {0};
+
+    Arguments args = create_default_arguments();
+    set_arguments_values(argc, argv, &args);
+
+    int len = hpack_encode_request(&args, buf, sizeof(buf));
+    ck_assert_int_eq(len, sizeof(expected));
+    ck_assert_int_eq(memcmp(buf, expected, sizeof(expected)), 0);
+}
+END_TEST
+
+Suite *hpack_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("HPACK");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_encode_integer_within_prefix);
+    tcase_add_test(tc_core, test_encode_integer_exceeds_prefix);
+    tcase_add_test(tc_core, test_encode_integer_buffer_too_small);
+    tcase_add_test(tc_core, test_encode_string);
+    tcase_add_test(tc_core, test_encode_get_request);
+    tcase_add_test(tc_core, test_encode_head_request_with_path);
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = hpack_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
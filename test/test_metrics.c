@@ -0,0 +1,112 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "metrics.h"
+
+static ProcessStats stats;
+static char buffer[METRICS_BUFFER_SIZE];
+
+static void record_requests(ProcessStats *published)
+{
+    memset(published, 0, sizeof(*published));
+    published->speed = 3;
+    published->failed = 1;
+    published->header_bytes = 300;
+    published->payload_bytes = 4000;
+    histogram_record(&published->latency, 2000000);
+    histogram_record(&published->latency, 20000000);
+    histogram_record(&published->latency, 200000000);
+}
+
+START_TEST(test_metrics_render)
+{
+    record_requests(&stats);
+    int len = metrics_render(&stats, 2, 1.5, buffer, sizeof(buffer));
+    ck_assert_int_gt(len, 0);
+    ck_assert_int_eq(len, (int)strlen(buffer));
+
+    ck_assert_ptr_nonnull(strstr(buffer, "# TYPE webbench2_requests_total counter\nwebbench2_requests_total 3\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_requests_failed_total 1\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_received_bytes_total{part=\"payload\"} 4000\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_workers 2\n"));
+
+    // The buckets are cumulative.
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_bucket{le=\"0.001\"} 0\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_bucket{le=\"0.0025\"} 1\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_bucket{le=\"0.025\"} 2\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_bucket{le=\"0.25\"} 3\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_bucket{le=\"+Inf\"} 3\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_sum 0.222000000\n"));
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_request_duration_seconds_count 3\n"));
+
+    // A buffer too small is reported instead of truncating the metrics.
+    ck_assert_int_lt(metrics_render(&stats, 2, 1.5, buffer, 100), 0);
+}
+
+START_TEST(test_metrics_server_unix)
+{
+    MetricsServer server;
+    char path[64];
+    char address[80];
+    snprintf(path, sizeof(path), "/tmp/test_metrics_%d.sock", (int)getpid());
+    snprintf(address, sizeof(address), "unix:%s", path);
+
+    record_requests(&stats);
+    ck_assert_int_gt(metrics_server_start(&server, address, &stats, 1), 0);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    ck_assert_int_eq(connect(fd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+
+    const char *request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ck_assert_int_eq(send(fd, request, strlen(request), 0), (ssize_t)strlen(request));
+    size_t received = 0;
+    ssize_t bytes_read;
+    while ((bytes_read = recv(fd, buffer + received, sizeof(buffer) - 1 - received, 0)) > 0)
+    {
+        received += (size_t)bytes_read;
+    }
+    buffer[received] = '\0';
+    close(fd);
+
+    ck_assert_int_eq(strncmp(buffer, "HTTP/1.0 200 OK\r\n", 17), 0);
+    ck_assert_ptr_nonnull(strstr(buffer, "\nwebbench2_requests_total 3\n"));
+
+    metrics_server_stop(&server);
+    ck_assert_int_ne(access(path, F_OK), 0);
+
+    ck_assert_int_lt(metrics_server_start(&server, "localhost:99999", &stats, 1), 0);
+}
+
+Suite *metrics_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("metrics");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_metrics_render);
+    tcase_add_test(tc_core, test_metrics_server_unix);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = metrics_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
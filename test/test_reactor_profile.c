@@ -0,0 +1,145 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reactor_profile.h"
+
+START_TEST(test_reactor_profile_switch)
+{
+    ReactorProfile *profile = (ReactorProfile *) malloc(sizeof(ReactorProfile));
+    reactor_profile_init(profile, 1000);
+    ck_assert_int_eq(profile->phase, REACTOR_OTHER);
+
+    // The time is charged to the phase left.
+    ck_assert_int_eq(reactor_profile_switch(profile, REACTOR_WAIT, 1100), REACTOR_OTHER);
+    ck_assert_int_eq(reactor_profile_switch(profile, REACTOR_SSL, 1900), REACTOR_WAIT);
+    ck_assert_int_eq(reactor_profile_switch(profile, REACTOR_OTHER, 2000), REACTOR_SSL);
+    ck_assert_uint_eq(profile->phase_ns[REACTOR_OTHER], 100);
+    ck_assert_uint_eq(profile->phase_ns[REACTOR_WAIT], 800);
+    ck_assert_uint_eq(profile->phase_ns[REACTOR_SSL], 100);
+
+    // A clock behind the last switch charges nothing.
+    reactor_profile_switch(profile, REACTOR_IO, 1500);
+    reactor_profile_switch(profile, REACTOR_OTHER, 2100);
+    ck_assert_uint_eq(profile->phase_ns[REACTOR_OTHER], 100);
+    ck_assert_uint_eq(profile->phase_ns[REACTOR_IO], 100);
+    free(profile);
+}
+
+START_TEST(test_reactor_profile_busy)
+{
+    ReactorProfile *profile = (ReactorProfile *) malloc(sizeof(ReactorProfile));
+    reactor_profile_init(profile, 0);
+    ck_assert(reactor_profile_busy(profile) == 0.0);
+
+    reactor_profile_switch(profile, REACTOR_WAIT, 100);
+    reactor_profile_switch(profile, REACTOR_PARSE, 1000);
+    reactor_profile_switch(profile, REACTOR_OTHER, 1500);
+    ck_assert(reactor_profile_busy(profile) > 0.39 && reactor_profile_busy(profile) < 0.41);
+    ck_assert(!reactor_profile_saturated(profile));
+
+    reactor_profile_switch(profile, REACTOR_SSL, 1500);
+    reactor_profile_switch(profile, REACTOR_OTHER, 100000);
+    ck_assert(reactor_profile_busy(profile) > REACTOR_BUSY_LIMIT);
+    ck_assert(reactor_profile_saturated(profile));
+    free(profile);
+}
+
+START_TEST(test_reactor_profile_lag_rise)
+{
+    ReactorProfile *profile = (ReactorProfile *) malloc(sizeof(ReactorProfile));
+    reactor_profile_init(profile, 0);
+
+    // A steady lag doesn't rise.
+    for (uint64_t second = 0; second < 10; second++)
+    {
+        reactor_profile_record_lag(profile, 50000, second * REACTOR_LAG_WINDOW_NS);
+        reactor_profile_record_lag(profile, 150000, second * REACTOR_LAG_WINDOW_NS + 1);
+    }
+    ck_assert_int_eq(profile->windows_count, 9);
+    ck_assert(profile->window_lag_ns[0] == 100000);
+    ck_assert(reactor_profile_lag_rise_ns(profile) < 1);
+    ck_assert(!reactor_profile_saturated(profile));
+    ck_assert_uint_eq(profile->lag.total_count, 20);
+
+    // A lag rising by a millisecond a second.
+    reactor_profile_init(profile, 0);
+    for (uint64_t second = 0; second <= 10; second++)
+    {
+        reactor_profile_record_lag(profile, 100000 + second * 1000000, second * REACTOR_LAG_WINDOW_NS);
+    }
+    double rise = reactor_profile_lag_rise_ns(profile);
+    ck_assert(rise > 9000000 - 1 && rise < 9000000 + 1);
+    ck_assert(reactor_profile_saturated(profile));
+    free(profile);
+}
+
+START_TEST(test_reactor_profile_windows_merged)
+{
+    ReactorProfile *profile = (ReactorProfile *) malloc(sizeof(ReactorProfile));
+    reactor_profile_init(profile, 0);
+    for (uint64_t second = 0; second <= REACTOR_LAG_WINDOWS; second++)
+    {
+        reactor_profile_record_lag(profile, second, second * REACTOR_LAG_WINDOW_NS);
+    }
+    ck_assert_int_eq(profile->windows_count, REACTOR_LAG_WINDOWS);
+
+    // Running out of windows merges them pairwise into windows twice as long.
+    reactor_profile_record_lag(profile, 0, (REACTOR_LAG_WINDOWS + 1) * REACTOR_LAG_WINDOW_NS);
+    ck_assert_int_eq(profile->windows_count, REACTOR_LAG_WINDOWS / 2 + 1);
+    ck_assert_uint_eq(profile->window_ns, 2 * REACTOR_LAG_WINDOW_NS);
+    ck_assert(profile->window_lag_ns[0] == 0.5);
+    ck_assert(profile->window_lag_ns[REACTOR_LAG_WINDOWS / 2] == REACTOR_LAG_WINDOWS);
+    free(profile);
+}
+
+START_TEST(test_reactor_profile_print_warnings)
+{
+    ReactorProfile *profile = (ReactorProfile *) malloc(sizeof(ReactorProfile));
+    char output[512] = {0};
+    reactor_profile_init(profile, 0);
+    reactor_profile_switch(profile, REACTOR_WAIT, 0);
+    reactor_profile_switch(profile, REACTOR_OTHER, 1000);
+    FILE *stream = fmemopen(output, sizeof(output), "w");
+    reactor_profile_print_warnings(profile, stream);
+    fclose(stream);
+    ck_assert_str_eq(output, "");
+
+    // Only the busy time is kept without the split by phase, and it's enough to warn.
+    reactor_profile_switch(profile, REACTOR_OTHER, 100000);
+    stream = fmemopen(output, sizeof(output), "w");
+    reactor_profile_print_warnings(profile, stream);
+    fclose(stream);
+    ck_assert_ptr_nonnull(strstr(output, "WARNING: The reactor was [99.0%] busy"));
+    free(profile);
+}
+
+Suite *reactor_profile_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("reactor_profile");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_reactor_profile_switch);
+    tcase_add_test(tc_core, test_reactor_profile_busy);
+    tcase_add_test(tc_core, test_reactor_profile_lag_rise);
+    tcase_add_test(tc_core, test_reactor_profile_windows_merged);
+    tcase_add_test(tc_core, test_reactor_profile_print_warnings);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = reactor_profile_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "replay.h"
+
+/**
+ * Write the text into a temporary file, the caller removes it.
+ */
+static void write_log(char *path, const char *text)
+{
+    strcpy(path, "/tmp/test_replay_XXXXXX");
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    ck_assert_int_eq(write(fd, text, strlen(text)), (int)strlen(text));
+    close(fd);
+}
+
+START_TEST(test_replay_log_entries)
+{
+    char path[32];
+    ReplayLog log;
+    ReplayEntry entry;
+
+    write_log(path, "# time\tmethod\tpath\n"
+                    "1700000000.5\tGET\t/a\n"
+                    "\n"
+                    "1700000001.25\tHEAD\t/b?x=1\tX-Id: 7\tAccept: */*\r\n"
+                    "1700000001\tGET\t/c");
+    ck_assert_int_gt(replay_log_open(&log, path), 0);
+
+    ck_assert_int_eq(replay_log_next(&log, &entry), 1);
+    ck_assert_uint_eq(entry.offset_ns, 0);
+    ck_assert_int_eq(entry.method_len, 3);
+    ck_assert_int_eq(strncmp(entry.method, "GET", 3), 0);
+    ck_assert_int_eq(entry.path_len, 2);
+    ck_assert_int_eq(entry.headers_len, 0);
+
+    ck_assert_int_eq(replay_log_next(&log, &entry), 1);
+    ck_assert_uint_eq(entry.offset_ns, 750000000ull);
+    ck_assert_int_eq(strncmp(entry.path, "/b?x=1", entry.path_len), 0);
+    ck_assert_int_eq(entry.headers_len, strlen("X-Id: 7\tAccept: */*"));
+
+    // Out of order, sent right after the line before it.
+    ck_assert_int_eq(replay_log_next(&log, &entry), 1);
+    ck_assert_uint_eq(entry.offset_ns, 750000000ull);
+
+    ck_assert_int_eq(replay_log_next(&log, &entry), 0);
+    replay_log_close(&log);
+    unlink(path);
+}
+
+START_TEST(test_replay_log_malformed)
+{
+    char path[32];
+    ReplayLog log;
+    ReplayEntry entry;
+
+    write_log(path, "abc\tGET\t/a\n1\tGET\tnoslash\n2\tGET\n3\tGET\t/ok\n");
+    ck_assert_int_gt(replay_log_open(&log, path), 0);
+    ck_assert_int_lt(replay_log_next(&log, &entry), 0);
+    ck_assert_int_lt(replay_log_next(&log, &entry), 0);
+    ck_assert_int_lt(replay_log_next(&log, &entry), 0);
+    ck_assert_int_eq(replay_log_next(&log, &entry), 1);
+    ck_assert_uint_eq(log.line_number, 4);
+    replay_log_close(&log);
+    unlink(path);
+}
+
+START_TEST(test_replay_schedule_speed)
+{
+    char path[32];
+    ReplaySchedule schedule;
+    ReplayEntry entry;
+    uint64_t late_ns;
+
+    write_log(path, "10\tGET\t/a\nbad\n12\tGET\t/b\n");
+    ck_assert_int_gt(replay_schedule_init(&schedule, path, 2.0, 1000), 0);
+
+    ck_assert_int_eq(replay_schedule_take(&schedule, 1000, &entry, &late_ns), 1);
+    ck_assert_uint_eq(late_ns, 0);
+
+    // A malformed line doesn't end the schedule.
+    ck_assert_int_lt(replay_schedule_take(&schedule, 1000, &entry, &late_ns), 0);
+    ck_assert(!schedule.finished);
+
+    // Two seconds later in the log is one second later at twice the speed.
+    ck_assert_int_eq(replay_schedule_take(&schedule, 1000 + 999999999ull, &entry, &late_ns), 0);
+    ck_assert_int_eq(replay_schedule_take(&schedule, 1000 + 1000000100ull, &entry, &late_ns), 1);
+    ck_assert_uint_eq(late_ns, 100);
+    ck_assert_int_eq(strncmp(entry.path, "/b", entry.path_len), 0);
+
+    ck_assert_int_eq(replay_schedule_take(&schedule, 1000 + 5000000000ull, &entry, &late_ns), 0);
+    ck_assert(schedule.finished);
+    replay_log_close(&schedule.log);
+    unlink(path);
+}
+
+START_TEST(test_replay_schedule_next_due)
+{
+    char path[32];
+    ReplaySchedule schedule;
+    ReplayEntry entry;
+    uint64_t late_ns;
+    uint64_t due_ns = 0;
+
+    write_log(path, "10\tGET\t/a\nbad\n13\tGET\t/b\n");
+    ck_assert_int_gt(replay_schedule_init(&schedule, path, 1.0, 1000), 0);
+    ck_assert_int_eq(replay_schedule_next_due(&schedule, &due_ns), 1);
+    ck_assert_uint_eq(due_ns, 1000);
+
+    // Reading ahead keeps the entry for the take.
+    ck_assert_int_eq(replay_schedule_next_due(&schedule, &due_ns), 1);
+    ck_assert_int_eq(replay_schedule_take(&schedule, 1000, &entry, &late_ns), 1);
+
+    ck_assert_int_lt(replay_schedule_next_due(&schedule, &due_ns), 0);
+    ck_assert_int_eq(replay_schedule_next_due(&schedule, &due_ns), 1);
+    ck_assert_uint_eq(due_ns, 1000 + 3000000000ull);
+    ck_assert_int_eq(replay_schedule_take(&schedule, due_ns, &entry, &late_ns), 1);
+
+    ck_assert_int_eq(replay_schedule_next_due(&schedule, &due_ns), 0);
+    ck_assert(schedule.finished);
+    replay_log_close(&schedule.log);
+    unlink(path);
+}
+
+START_TEST(test_replay_render)
+{
+    char path[32];
+    ReplayLog log;
+    ReplayEntry entry;
+    char buffer[256];
+
+    write_log(path, "1\tHEAD\t/b?x=1\tX-Id: 7\n");
+    ck_assert_int_gt(replay_log_open(&log, path), 0);
+    ck_assert_int_eq(replay_log_next(&log, &entry), 1);
+
+    ck_assert_int_gt(replay_render(&entry, "GET  HTTP/1.1\r\nHost: a:80\r\n\r\n", buffer, sizeof(buffer)), 0);
+    ck_assert_str_eq(buffer, "HEAD /b?x=1 HTTP/1.1\r\nHost: a:80\r\nX-Id: 7\r\n\r\n");
+
+    // Through a proxy the request line has the URL of the target.
+    ck_assert_int_gt(replay_render(&entry, "GET http://a:80 HTTP/1.0\r\n\r\n", buffer, sizeof(buffer)), 0);
+    ck_assert_str_eq(buffer, "HEAD http://a:80/b?x=1 HTTP/1.0\r\nX-Id: 7\r\n\r\n");
+
+    ck_assert_int_lt(replay_render(&entry, "GET  HTTP/1.1\r\nHost: a:80\r\n\r\n", buffer, 16), 0);
+    replay_log_close(&log);
+    unlink(path);
+}
+
+Suite *replay_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("replay");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_replay_log_entries);
+    tcase_add_test(tc_core, test_replay_log_malformed);
+    tcase_add_test(tc_core, test_replay_schedule_speed);
+    tcase_add_test(tc_core, test_replay_schedule_next_due);
+    tcase_add_test(tc_core, test_replay_render);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = replay_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include <check.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "resolver.h"
+#include "timing.h"
+
+/**
+ * Look up the host until the resolver thread has resolved it.
+ */
+static int lookup_resolved(Resolver *resolver, const char *host, int port, uint64_t now_ns, DnsAddresses *addresses)
+{
+    int error = 0;
+    int result;
+    for (int i = 0; i < 50; i++)
+    {
+        result = resolver_lookup(resolver, host, port, now_ns, addresses, &error);
+        if (result != 0)
+        {
+            return result;
+        }
+        struct pollfd pfd = {.fd = resolver->event_fd, .events = POLLIN};
+        poll(&pfd, 1, 100);
+        resolver_drain(resolver);
+    }
+    return 0;
+}
+
+START_TEST(test_resolver_resolves_off_the_caller)
+{
+    Resolver resolver;
+    DnsAddresses addresses;
+    int error = 0;
+
+    ck_assert_int_gt(resolver_init(&resolver, 60), 0);
+
+    // The first lookup only queues the host, the thread may have resolved it already.
+    ck_assert_int_eq(resolver_lookup(&resolver, "127.0.0.1", 8080, get_monotonic_ns(), &addresses, &error), 0);
+    ck_assert_int_eq(resolver.entries_count, 1);
+
+    ck_assert_int_gt(lookup_resolved(&resolver, "127.0.0.1", 8080, get_monotonic_ns(), &addresses), 0);
+    ck_assert(!resolver_busy(&resolver));
+    ck_assert_int_ge(addresses.count, 1);
+    const struct sockaddr_in *addr = (const struct sockaddr_in *) &addresses.addrs[0];
+    ck_assert_int_eq(ntohs(addr->sin_port), 8080);
+    ck_assert_int_eq(ntohl(addr->sin_addr.s_addr), INADDR_LOOPBACK);
+    ck_assert_int_eq(resolver.entries_count, 1);
+
+    // Another port is another entry.
+    ck_assert_int_eq(resolver_lookup(&resolver, "127.0.0.1", 8081, get_monotonic_ns(), &addresses, &error), 0);
+    ck_assert_int_eq(resolver.entries_count, 2);
+    resolver_free(&resolver);
+}
+
+START_TEST(test_resolver_refreshes_expired)
+{
+    Resolver resolver;
+    DnsAddresses addresses;
+    int error = 0;
+
+    ck_assert_int_gt(resolver_init(&resolver, 1), 0);
+    ck_assert_int_gt(lookup_resolved(&resolver, "127.0.0.1", 80, get_monotonic_ns(), &addresses), 0);
+    uint64_t expires_ns = resolver.entries[0].expires_ns;
+
+    // The expired entry is still used while it's refreshed.
+    addresses.count = 0;
+    ck_assert_int_gt(resolver_lookup(&resolver, "127.0.0.1", 80, expires_ns, &addresses, &error), 0);
+    ck_assert_int_ge(addresses.count, 1);
+    ck_assert(!resolver_busy(&resolver));
+
+    struct pollfd pfd = {.fd = resolver.event_fd, .events = POLLIN};
+    ck_assert_int_eq(poll(&pfd, 1, 5000), 1);
+    resolver_drain(&resolver);
+    ck_assert_uint_gt(resolver.entries[0].expires_ns, expires_ns);
+    resolver_free(&resolver);
+}
+
+Suite *resolver_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("resolver");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_resolver_resolves_off_the_caller);
+    tcase_add_test(tc_core, test_resolver_refreshes_expired);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = resolver_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
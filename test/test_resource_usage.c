@@ -0,0 +1,117 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "resource_usage.h"
+
+START_TEST(test_resource_usage_read)
+{
+    ResourceUsage start;
+    ResourceUsage usage;
+    ck_assert_int_gt(resource_usage_read(&start, NULL), 0);
+    ck_assert_uint_gt(start.peak_rss_kb, 0);
+
+    // Spinning for a while is charged to the calling thread.
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < 200000000ull; i++)
+    {
+        sum += i;
+    }
+    ck_assert_int_gt(resource_usage_read(&usage, NULL), 0);
+    resource_usage_since(&usage, &start);
+    ck_assert_uint_gt(usage.user_ns + usage.sys_ns, 0);
+    ck_assert_uint_ge(usage.peak_rss_kb, start.peak_rss_kb);
+    ck_assert_uint_eq(usage.cycles, 0);
+}
+
+START_TEST(test_resource_usage_since_and_add)
+{
+    ResourceUsage start = {100, 200, 3, 4, 5, 6, 1000, 700, 800};
+    ResourceUsage usage = {150, 260, 10, 4, 9, 6, 1200, 1700, 2800};
+    resource_usage_since(&usage, &start);
+    ck_assert_uint_eq(usage.user_ns, 50);
+    ck_assert_uint_eq(usage.sys_ns, 60);
+    ck_assert_uint_eq(usage.voluntary_switches, 7);
+    ck_assert_uint_eq(usage.involuntary_switches, 0);
+    ck_assert_uint_eq(usage.minor_faults, 4);
+    ck_assert_uint_eq(usage.major_faults, 0);
+    ck_assert_uint_eq(usage.peak_rss_kb, 1200);
+    ck_assert_uint_eq(usage.cycles, 1000);
+    ck_assert_uint_eq(usage.instructions, 2000);
+
+    // The totals add up, but the peak RSS is the largest one.
+    ResourceUsage total;
+    memset(&total, 0, sizeof(total));
+    resource_usage_add(&total, &usage);
+    resource_usage_add(&total, &start);
+    ck_assert_uint_eq(total.user_ns, 150);
+    ck_assert_uint_eq(total.voluntary_switches, 10);
+    ck_assert_uint_eq(total.cycles, 1700);
+    ck_assert_uint_eq(total.peak_rss_kb, 1200);
+}
+
+START_TEST(test_resource_usage_print)
+{
+    ResourceUsage usage = {1500000000ull, 500000000ull, 10, 2, 300, 0, 4096, 0, 0};
+    char output[1024] = {0};
+    FILE *stream = fmemopen(output, sizeof(output), "w");
+    resource_usage_print(&usage, "Worker", 4.0, 1000, stream);
+    fclose(stream);
+    ck_assert_ptr_nonnull(strstr(output, "user=[1.500s], sys=[0.500s], cpu=[50.0%]"));
+    ck_assert_ptr_nonnull(strstr(output, "cpu per request=[2000.000us]"));
+    ck_assert_ptr_null(strstr(output, "cycles"));
+
+    usage.cycles = 3000000;
+    usage.instructions = 6000000;
+    memset(output, 0, sizeof(output));
+    stream = fmemopen(output, sizeof(output), "w");
+    resource_usage_print(&usage, "Worker", 4.0, 1000, stream);
+    fclose(stream);
+    ck_assert_ptr_nonnull(strstr(output, "IPC=[2.00], cycles per request=[3000], instructions per request=[6000]"));
+}
+
+START_TEST(test_perf_counters)
+{
+    // Counters are often not permitted, e.g. in containers, then nothing is left open.
+    PerfCounters counters;
+    if (perf_counters_open(&counters) < 0)
+    {
+        ck_assert_int_eq(counters.cycles_fd, -1);
+        ck_assert_int_eq(counters.instructions_fd, -1);
+        return;
+    }
+    ResourceUsage usage;
+    resource_usage_read(&usage, &counters);
+    ck_assert_uint_gt(usage.instructions, 0);
+    perf_counters_close(&counters);
+    ck_assert_int_eq(counters.cycles_fd, -1);
+}
+
+Suite *resource_usage_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("resource_usage");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_resource_usage_read);
+    tcase_add_test(tc_core, test_resource_usage_since_and_add);
+    tcase_add_test(tc_core, test_resource_usage_print);
+    tcase_add_test(tc_core, test_perf_counters);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = resource_usage_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "response.h"
+
+START_TEST(test_content_length_response)
+{
+    HTTPResponseParser parser;
+    response_parser_init(&parser, false, false);
+
+    const char *response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+    int header_len = response_parse_headers(&parser, response, strlen(response));
+    ck_assert_int_eq(header_len, (int)strlen(response) - 5);
+    ck_assert_int_eq(parser.status_code, 200);
+    ck_assert(parser.keep_alive);
+    ck_assert(!response_is_complete(&parser));
+
+    ck_assert_int_eq(response_consume_body(&parser, response + header_len, 5), 5);
+    ck_assert(response_is_complete(&parser));
+}
+
+START_TEST(test_incomplete_headers)
+{
+    HTTPResponseParser parser;
+    response_parser_init(&parser, false, false);
+
+    const char *response = "HTTP/1.1 200 OK\r\nContent-Len";
+    ck_assert_int_eq(response_parse_headers(&parser, response, strlen(response)), 0);
+
+    const char *malformed = "SMTP 220 ready\r\n\r\n";
+    ck_assert_int_eq(response_parse_headers(&parser, malformed, strlen(malformed)), -1);
+}
+
+START_TEST(test_chunked_response)
+{
+    HTTPResponseParser parser;
+    response_parser_init(&parser, false, false);
+
+    const char *headers = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+    const char *body = "4\r\nWiki\r\n5;ext=1\r\npedia\r\n0\r\nX-Trailer: 1\r\n\r\n";
+    ck_assert_int_gt(response_parse_headers(&parser, headers, strlen(headers)), 0);
+
+    // Feed the body byte by byte, as if every read returned one byte.
+    for (size_t i = 0; i < strlen(body); i++)
+    {
+        ck_assert(!response_is_complete(&parser));
+        ck_assert_int_eq(response_consume_body(&parser, body + i, 1), 1);
+    }
+    ck_assert(response_is_complete(&parser));
+    ck_assert_uint_eq(parser.body_bytes, 9);
+}
+
+START_TEST(test_response_until_close)
+{
+    HTTPResponseParser parser;
+    response_parser_init(&parser, false, false);
+
+    const char *response = "HTTP/1.0 200 OK\r\n\r\nbody";
+    int header_len = response_parse_headers(&parser, response, strlen(response));
+    ck_assert_int_gt(header_len, 0);
+    ck_assert(!parser.keep_alive);
+
+    response_consume_body(&parser, response + header_len, 4);
+    ck_assert(!response_is_complete(&parser));
+    response_connection_closed(&parser);
+    ck_assert(response_is_complete(&parser));
+}
+
+START_TEST(test_head_response)
+{
+    HTTPResponseParser parser;
+    response_parser_init(&parser, true, false);
+
+    const char *response = "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\nConnection: close\r\n\r\n";
+    ck_assert_int_gt(response_parse_headers(&parser, response, strlen(response)), 0);
+    ck_assert(response_is_complete(&parser));
+    ck_assert(!parser.keep_alive);
+}
+
+START_TEST(test_body_hash_ignores_framing)
+{
+    HTTPResponseParser length_parser, chunked_parser;
+    response_parser_init(&length_parser, false, true);
+    response_parser_init(&chunked_parser, false, true);
+
+    const char *length_response = "HTTP/1.1 200 OK\r\nContent-Length: 21\r\n\r\nThe quick brown fox!!";
+    int header_len = response_parse_headers(&length_parser, length_response, strlen(length_response));
+    response_consume_body(&length_parser, length_response + header_len, 21);
+
+    const char *headers = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+    const char *body = "3\r\nThe\r\n10\r\n quick brown fox\r\n2\r\n!!\r\n0\r\n\r\n";
+    response_parse_headers(&chunked_parser, headers, strlen(headers));
+    response_consume_body(&chunked_parser, body, strlen(body));
+
+    ck_assert(response_is_complete(&length_parser));
+    ck_assert(response_is_complete(&chunked_parser));
+    uint64_t expected = body_hash("The quick brown fox!!", 21);
+    ck_assert_uint_eq(body_hash_final(&length_parser.body_hash), expected);
+    ck_assert_uint_eq(body_hash_final(&chunked_parser.body_hash), expected);
+    ck_assert_uint_ne(body_hash("The quick brown fox!?", 21), expected);
+}
+
+Suite *response_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("response");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_content_length_response);
+    tcase_add_test(tc_core, test_incomplete_headers);
+    tcase_add_test(tc_core, test_chunked_response);
+    tcase_add_test(tc_core, test_response_until_close);
+    tcase_add_test(tc_core, test_head_response);
+    tcase_add_test(tc_core, test_body_hash_ignores_framing);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = response_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "results.h"
+
+static BenchResults written;
+static BenchResults read_back;
+
+START_TEST(test_results_sample)
+{
+    Arguments args = create_default_arguments();
+    results_init(&written, &args, 0);
+
+    // Nothing before the first period has elapsed.
+    results_sample(&written, 10, 500000000);
+    ck_assert_int_eq(written.samples_count, 0);
+
+    results_sample(&written, 100, 1000000000);
+    ck_assert_int_eq(written.samples_count, 1);
+    ck_assert_uint_eq(written.samples[0], 100);
+
+    // Periods the loop missed share the requests completed meanwhile.
+    results_sample(&written, 201, 3500000000ull);
+    ck_assert_int_eq(written.samples_count, 3);
+    ck_assert_uint_eq(written.samples[1], 50);
+    ck_assert_uint_eq(written.samples[2], 51);
+    ck_assert_uint_eq(written.sampled_ns, 3000000000ull);
+}
+
+START_TEST(test_results_round_trip)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_results_%d.json", (int)getpid());
+
+    Arguments args = create_default_arguments();
+    snprintf(args.url, sizeof(args.url), "http://example.com/\"quoted\"\\path/");
+    args.clients = 8;
+    results_init(&written, &args, 0);
+    written.duration_seconds = 2.5;
+    written.requests = 18446744073709551000ull;
+    written.failed = 3;
+    written.payload_bytes = 4096;
+    histogram_record(&written.latency, 1500);
+    histogram_record(&written.latency, 2000000);
+    histogram_record(&written.latency, 2000000);
+    written.samples[0] = 7;
+    written.samples[1] = 9;
+    written.samples_count = 2;
+
+    ck_assert_int_gt(results_write(&written, path), 0);
+    ck_assert_int_gt(results_read(&read_back, path), 0);
+    unlink(path);
+
+    ck_assert_str_eq(read_back.url, written.url);
+    ck_assert_int_eq(read_back.clients, 8);
+    ck_assert_int_eq(read_back.procs, 1);
+    ck_assert_uint_eq(read_back.requests, written.requests);
+    ck_assert_uint_eq(read_back.failed, 3);
+    ck_assert_uint_eq(read_back.payload_bytes, 4096);
+    ck_assert_int_eq(memcmp(&read_back.latency, &written.latency, sizeof(Histogram)), 0);
+    ck_assert_int_eq(read_back.samples_count, 2);
+    ck_assert_uint_eq(read_back.samples[1], 9);
+}
+
+START_TEST(test_results_malformed)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_results_bad_%d.json", (int)getpid());
+
+    FILE *file = fopen(path, "w");
+    fprintf(file, "{\"version\": 1, \"samples\": [1, 2,");
+    fclose(file);
+    ck_assert_int_lt(results_read(&read_back, path), 0);
+
+    file = fopen(path, "w");
+    fprintf(file, "{\"version\": 99}");
+    fclose(file);
+    ck_assert_int_lt(results_read(&read_back, path), 0);
+    unlink(path);
+
+    ck_assert_int_lt(results_read(&read_back, "/nonexistent/results.json"), 0);
+}
+
+Suite *results_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("results");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_results_sample);
+    tcase_add_test(tc_core, test_results_round_trip);
+    tcase_add_test(tc_core, test_results_malformed);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = results_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
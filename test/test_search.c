@@ -0,0 +1,83 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "search.h"
+
+/**
+ * Run the search against a server whose p99 is 1ms per connection.
+ */
+static int run_search(ThroughputSearch *search, int max_connections, uint64_t slo_p99_ns)
+{
+    int connections = max_connections;
+    int probes = 0;
+
+    search_init(search, max_connections, slo_p99_ns);
+    while (connections > 0)
+    {
+        ck_assert_int_eq(search->current, connections);
+        connections = search_record(search, 100 * (uint64_t)connections, 1.0, 1000000ull * connections);
+        probes++;
+    }
+    return probes;
+}
+
+START_TEST(test_search_converges)
+{
+    ThroughputSearch search;
+
+    int probes = run_search(&search, 100, 37000000ull);
+    ck_assert_int_eq(search.passed_connections, 37);
+    ck_assert_int_eq(search.failed_connections, 38);
+    ck_assert_int_le(probes, 8);
+}
+
+START_TEST(test_search_bounds)
+{
+    ThroughputSearch search;
+
+    // All connections pass, the first probe is enough.
+    ck_assert_int_eq(run_search(&search, 10, 50000000ull), 1);
+    ck_assert_int_eq(search.passed_connections, 10);
+
+    // Even one connection fails.
+    run_search(&search, 10, 500000ull);
+    ck_assert_int_eq(search.passed_connections, 0);
+    ck_assert_int_eq(search.failed_connections, 1);
+}
+
+START_TEST(test_search_no_completed_requests)
+{
+    ThroughputSearch search;
+
+    // A probe without any completed request fails, whatever its p99.
+    search_init(&search, 4, 1000000ull);
+    ck_assert_int_eq(search_record(&search, 0, 1.0, 0), 2);
+    ck_assert(!search.probes[0].passed);
+}
+
+Suite *search_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("search");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_search_converges);
+    tcase_add_test(tc_core, test_search_bounds);
+    tcase_add_test(tc_core, test_search_no_completed_requests);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = search_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "targets.h"
+#include "arguments.h"
+
+static TargetPool pool;
+
+START_TEST(test_targets_parse)
+{
+    ck_assert_int_eq(target_pool_init(&pool, "10.0.0.1:8080@3,backend,10.0.0.3:9000", 80, BALANCE_ROUND_ROBIN), 3);
+    ck_assert_str_eq(pool.targets[0].host, "10.0.0.1");
+    ck_assert_int_eq(pool.targets[0].port, 8080);
+    ck_assert_int_eq(pool.targets[0].weight, 3);
+    ck_assert_str_eq(pool.targets[1].host, "backend");
+    ck_assert_int_eq(pool.targets[1].port, 80);
+    ck_assert_int_eq(pool.targets[1].weight, 1);
+    target_pool_free(&pool);
+
+    ck_assert_int_lt(target_pool_init(&pool, "a:0", 80, BALANCE_ROUND_ROBIN), 0);
+    ck_assert_int_lt(target_pool_init(&pool, "a@0", 80, BALANCE_ROUND_ROBIN), 0);
+    ck_assert_int_lt(target_pool_init(&pool, "a,,b", 80, BALANCE_ROUND_ROBIN), 0);
+    ck_assert_int_lt(target_pool_init(&pool, "", 80, BALANCE_ROUND_ROBIN), 0);
+}
+
+START_TEST(test_targets_round_robin)
+{
+    ck_assert_int_eq(target_pool_init(&pool, "a,b,c", 80, BALANCE_ROUND_ROBIN), 3);
+    for (int i = 0; i < 9; i++)
+    {
+        ck_assert_int_eq(target_pool_pick(&pool, NULL, 0), i % 3);
+    }
+    target_pool_free(&pool);
+}
+
+START_TEST(test_targets_weighted)
+{
+    int picks[3] = {0};
+
+    ck_assert_int_eq(target_pool_init(&pool, "a@5,b@1,c@1", 80, BALANCE_WEIGHTED), 3);
+    // Smooth weighted round-robin doesn't send the heaviest target twice in a row more than needed.
+    ck_assert_int_eq(target_pool_pick(&pool, NULL, 0), 0);
+    ck_assert_int_eq(target_pool_pick(&pool, NULL, 0), 0);
+    ck_assert_int_eq(target_pool_pick(&pool, NULL, 0), 1);
+    ck_assert_int_eq(target_pool_pick(&pool, NULL, 0), 0);
+    for (int i = 4; i < 70; i++)
+    {
+        picks[target_pool_pick(&pool, NULL, 0)]++;
+    }
+    ck_assert_int_eq(picks[0] + 3, 50);
+    ck_assert_int_eq(picks[1] + 1, 10);
+    ck_assert_int_eq(picks[2], 10);
+    target_pool_free(&pool);
+}
+
+START_TEST(test_targets_consistent_hash)
+{
+    char key[32];
+    int first[200];
+    int picks[3] = {0};
+
+    ck_assert_int_eq(target_pool_init(&pool, "a,b,c", 80, BALANCE_HASH), 3);
+    for (int i = 0; i < 200; i++)
+    {
+        int len = snprintf(key, sizeof(key), "/item/%d", i);
+        first[i] = target_pool_pick(&pool, key, len);
+        ck_assert_int_eq(target_pool_pick(&pool, key, len), first[i]);
+        picks[first[i]]++;
+    }
+    // Every target gets a fair share of the keys.
+    for (int i = 0; i < 3; i++)
+    {
+        ck_assert_int_gt(picks[i], 30);
+    }
+    target_pool_free(&pool);
+
+    // Without c, only the keys of c move.
+    ck_assert_int_eq(target_pool_init(&pool, "a,b", 80, BALANCE_HASH), 2);
+    for (int i = 0; i < 200; i++)
+    {
+        int len = snprintf(key, sizeof(key), "/item/%d", i);
+        if (first[i] != 2)
+        {
+            ck_assert_int_eq(target_pool_pick(&pool, key, len), first[i]);
+        }
+    }
+    target_pool_free(&pool);
+}
+
+Suite *targets_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("targets");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_targets_parse);
+    tcase_add_test(tc_core, test_targets_round_robin);
+    tcase_add_test(tc_core, test_targets_weighted);
+    tcase_add_test(tc_core, test_targets_consistent_hash);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = targets_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "template.h"
+
+START_TEST(test_template_without_placeholder)
+{
+    RequestTemplate request_template;
+    TemplateContext context;
+    uint64_t sequence = 0;
+    char buffer[64];
+
+    ck_assert_int_eq(template_compile(&request_template, "GET / HTTP/1.1\r\n\r\n"), 0);
+    template_context_init(&context, &sequence, 0);
+    ck_assert_int_eq(template_render(&request_template, &context, buffer, sizeof(buffer)), 18);
+    ck_assert_str_eq(buffer, "GET / HTTP/1.1\r\n\r\n");
+}
+
+START_TEST(test_template_sequence_and_connection)
+{
+    RequestTemplate request_template;
+    TemplateContext first, second;
+    uint64_t sequence = 0;
+    char buffer[64];
+
+    ck_assert_int_eq(template_compile(&request_template, "/item/{{seq}}?c={{conn}}"), 2);
+    template_context_init(&first, &sequence, 3);
+    template_context_init(&second, &sequence, 12);
+
+    template_render(&request_template, &first, buffer, sizeof(buffer));
+    ck_assert_str_eq(buffer, "/item/0?c=3");
+    template_render(&request_template, &second, buffer, sizeof(buffer));
+    ck_assert_str_eq(buffer, "/item/1?c=12");
+    template_render(&request_template, &first, buffer, sizeof(buffer));
+    ck_assert_str_eq(buffer, "/item/2?c=3");
+}
+
+START_TEST(test_template_random_in_range)
+{
+    RequestTemplate request_template;
+    TemplateContext context;
+    uint64_t sequence = 0;
+    char buffer[64];
+
+    ck_assert_int_eq(template_compile(&request_template, "{{rand:10-12}}"), 1);
+    template_context_init(&context, &sequence, 0);
+    for (int i = 0; i < 100; i++)
+    {
+        template_render(&request_template, &context, buffer, sizeof(buffer));
+        long value = strtol(buffer, NULL, 10);
+        ck_assert_int_ge(value, 10);
+        ck_assert_int_le(value, 12);
+    }
+}
+
+START_TEST(test_template_pick)
+{
+    RequestTemplate request_template;
+    TemplateContext context;
+    uint64_t sequence = 0;
+    char buffer[64];
+    int seen[3] = {0};
+
+    ck_assert_int_eq(template_compile(&request_template, "k={{pick:a|bb|ccc}};"), 1);
+    template_context_init(&context, &sequence, 1);
+    for (int i = 0; i < 100; i++)
+    {
+        int len = template_render(&request_template, &context, buffer, sizeof(buffer));
+        ck_assert(0 == strcmp(buffer, "k=a;") || 0 == strcmp(buffer, "k=bb;") || 0 == strcmp(buffer, "k=ccc;"));
+        seen[len - 4]++;
+    }
+    ck_assert_int_gt(seen[0], 0);
+    ck_assert_int_gt(seen[1], 0);
+    ck_assert_int_gt(seen[2], 0);
+}
+
+START_TEST(test_template_errors)
+{
+    RequestTemplate request_template;
+    TemplateContext context;
+    uint64_t sequence = 123456;
+    char buffer[8];
+
+    ck_assert_int_lt(template_compile(&request_template, "/{{seq"), 0);
+    ck_assert_int_lt(template_compile(&request_template, "/{{unknown}}"), 0);
+    ck_assert_int_lt(template_compile(&request_template, "/{{rand:9-1}}"), 0);
+
+    // The rendered text doesn't fit the buffer.
+    ck_assert_int_eq(template_compile(&request_template, "/item/{{seq}}"), 1);
+    template_context_init(&context, &sequence, 0);
+    ck_assert_int_lt(template_render(&request_template, &context, buffer, sizeof(buffer)), 0);
+}
+
+Suite *template_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("template");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_template_without_placeholder);
+    tcase_add_test(tc_core, test_template_sequence_and_connection);
+    tcase_add_test(tc_core, test_template_random_in_range);
+    tcase_add_test(tc_core, test_template_pick);
+    tcase_add_test(tc_core, test_template_errors);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = template_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timing.h"
+
+START_TEST(test_timing_loop_clock)
+{
+    timing_select_source(TIMING_SOURCE_MONOTONIC);
+    uint64_t ticked = timing_tick();
+    ck_assert_uint_eq(timing_loop_ns(), ticked);
+
+    // The loop clock stays at the last tick however long the events take.
+    struct timespec pause = {0, 2000000};
+    nanosleep(&pause, NULL);
+    ck_assert_uint_eq(timing_loop_ns(), ticked);
+    ck_assert_uint_ge(timing_read_ns() - ticked, 2000000);
+
+    ck_assert_uint_ge(timing_tick(), ticked + 2000000);
+    ck_assert_uint_gt(timing_loop_ns(), ticked);
+}
+
+START_TEST(test_timing_tsc)
+{
+    // Without an invariant TSC the monotonic clock stays selected.
+    if (timing_select_source(TIMING_SOURCE_TSC) < 0)
+    {
+        ck_assert_int_eq(timing_selected_source(), TIMING_SOURCE_MONOTONIC);
+        return;
+    }
+    ck_assert_int_eq(timing_selected_source(), TIMING_SOURCE_TSC);
+
+    // The calibrated TSC keeps up with the monotonic clock.
+    uint64_t tsc_start = timing_read_ns();
+    uint64_t monotonic_start = get_monotonic_ns();
+    struct timespec pause = {0, 50000000};
+    nanosleep(&pause, NULL);
+    uint64_t tsc_elapsed = timing_read_ns() - tsc_start;
+    uint64_t monotonic_elapsed = get_monotonic_ns() - monotonic_start;
+    int64_t drift = (int64_t)tsc_elapsed - (int64_t)monotonic_elapsed;
+    ck_assert_int_lt(llabs(drift), 100000);
+
+    // Both sources are on the same timeline.
+    int64_t offset = (int64_t)timing_read_ns() - (int64_t)get_monotonic_ns();
+    ck_assert_int_lt(llabs(offset), 1000000);
+
+    timing_select_source(TIMING_SOURCE_MONOTONIC);
+    ck_assert_int_eq(timing_selected_source(), TIMING_SOURCE_MONOTONIC);
+}
+
+Suite *timing_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("timing");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_timing_loop_clock);
+    tcase_add_test(tc_core, test_timing_tsc);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = timing_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "tls_config.h"
+
+START_TEST(test_tls_sweep_items)
+{
+    char item[32];
+
+    ck_assert_int_eq(tls_sweep_count("X25519,P-256:P-384"), 2);
+    ck_assert_int_eq(tls_sweep_item("X25519,P-256:P-384", 0, item, sizeof(item)), 6);
+    ck_assert_str_eq(item, "X25519");
+    ck_assert_int_eq(tls_sweep_item("X25519,P-256:P-384", 1, item, sizeof(item)), 11);
+    ck_assert_str_eq(item, "P-256:P-384");
+    ck_assert_int_lt(tls_sweep_item("X25519,P-256:P-384", 2, item, sizeof(item)), 0);
+    ck_assert_int_lt(tls_sweep_item("X25519,P-256:P-384", 1, item, 4), 0);
+}
+
+START_TEST(test_tls_sweep_empty)
+{
+    char item[32] = "x";
+
+    // An empty list is a single configuration keeping the defaults.
+    ck_assert_int_eq(tls_sweep_count(""), 1);
+    ck_assert_int_eq(tls_sweep_item("", 0, item, sizeof(item)), 0);
+    ck_assert_str_eq(item, "");
+}
+
+START_TEST(test_tls_config_apply)
+{
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+    ck_assert_ptr_nonnull(ctx);
+
+    ck_assert_int_gt(tls_config_apply(ctx, TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256:ECDHE-RSA-AES128-GCM-SHA256", "X25519:P-256"), 0);
+    ck_assert_int_eq(SSL_CTX_get_max_proto_version(ctx), TLS1_3_VERSION);
+    ck_assert_int_gt(tls_config_apply(ctx, 0, "", ""), 0);
+    ck_assert_int_lt(tls_config_apply(ctx, 0, "NO-SUCH-CIPHER", ""), 0);
+    ck_assert_int_lt(tls_config_apply(ctx, 0, "", "NO-SUCH-GROUP"), 0);
+    SSL_CTX_free(ctx);
+}
+
+Suite *tls_config_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("tls_config");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_tls_sweep_items);
+    tcase_add_test(tc_core, test_tls_sweep_empty);
+    tcase_add_test(tc_core, test_tls_config_apply);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = tls_config_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}
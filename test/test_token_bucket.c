@@ -0,0 +1,93 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "token_bucket.h"
+
+START_TEST(test_token_bucket_unlimited)
+{
+    TokenBucket bucket;
+    token_bucket_init(&bucket, 0, 0);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 0), UINT64_MAX);
+    token_bucket_consume(&bucket, 1000);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 1), UINT64_MAX);
+}
+
+START_TEST(test_token_bucket_burst)
+{
+    TokenBucket bucket;
+    token_bucket_init(&bucket, 1000, 0);
+    ck_assert_uint_eq(bucket.burst, 100);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 0), 100);
+
+    // Idle time never fills the bucket beyond the burst.
+    ck_assert_uint_eq(token_bucket_available(&bucket, 10000000000ull), 100);
+
+    // A slow rate still allows a byte at a time.
+    token_bucket_init(&bucket, 5, 0);
+    ck_assert_uint_eq(bucket.burst, 1);
+}
+
+START_TEST(test_token_bucket_refill)
+{
+    TokenBucket bucket;
+    token_bucket_init(&bucket, 1000, 0);
+    token_bucket_consume(&bucket, 100);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 0), 0);
+
+    // 1000 bytes per second is a byte per millisecond.
+    ck_assert_uint_eq(token_bucket_available(&bucket, 10000000), 10);
+    token_bucket_consume(&bucket, 10);
+
+    // Fractions of a token are kept until they add up.
+    ck_assert_uint_eq(token_bucket_available(&bucket, 10500000), 0);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 11000000), 1);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 12000000), 2);
+
+    // Spending more than available, e.g. on a retried write, empties the bucket.
+    token_bucket_consume(&bucket, 50);
+    ck_assert_uint_eq(token_bucket_available(&bucket, 12000000), 0);
+}
+
+START_TEST(test_token_bucket_rate)
+{
+    TokenBucket bucket;
+    uint64_t spent = 0;
+    token_bucket_init(&bucket, 2000, 0);
+
+    // Spending everything every 10ms for 10 seconds, the burst and the rate.
+    for (uint64_t now_ns = 0; now_ns <= 10000000000ull; now_ns += 10000000)
+    {
+        uint64_t available = token_bucket_available(&bucket, now_ns);
+        token_bucket_consume(&bucket, available);
+        spent += available;
+    }
+    ck_assert_uint_eq(spent, 200 + 20000);
+}
+
+Suite *token_bucket_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+    s = suite_create("token_bucket");
+    tc_core = tcase_create("Core");
+    tcase_add_test(tc_core, test_token_bucket_unlimited);
+    tcase_add_test(tc_core, test_token_bucket_burst);
+    tcase_add_test(tc_core, test_token_bucket_refill);
+    tcase_add_test(tc_core, test_token_bucket_rate);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+    s = token_bucket_suite();
+    sr = srunner_create(s);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? 0 : 1;
+}